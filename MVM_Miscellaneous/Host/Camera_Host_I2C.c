@@ -0,0 +1,344 @@
+//////////////////////////////////////////////////////////////////////////////////////////////
+//
+// File				: Camera_Host_I2C.c
+// Author(s)		: Fabian Kung
+// Last modified	: 16 Oct 2026
+// Tool-suites		: GCC C-Compiler (Linux or MinGW)
+//////////////////////////////////////////////////////////////////////////////////////////////
+// Measure the time from power up to the first frame of the camera driver on the computer.  The
+// start-up states of Proce_TCM8230_Driver() and the write path of Proce_I2C1_Driver() are run once
+// every system tick in simulated time, with a fake TWI module and TCM8230 I2C slave.  The register 
+// writes come from Driver_TCM8230_Regs.c.  The fake slave auto-increments the register address, 
+// the camera is turned on when register 0x03 is written, and the first VSync follows one frame 
+// period later.  After the first frame a few registers are changed with nCameraWriteReg() to show 
+// that only the changed registers are sent.
+// With -l the old chain of states is run instead, one register per I2C transaction with a 5 msec
+// delay after each write.
+// Build: gcc -O2 -I. -I../../MVM_Sample_Firmware_R0.95_CNN Camera_Host_I2C.c ../../MVM_Sample_Firmware_R0.95_CNN/Driver_TCM8230_Regs.c -o camera_i2c
+// Usage: ./camera_i2c [-l] [-r fps] [-b I2C baud rate kHz]
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "Capture_Host_BMP.h"
+#include "Driver_TCM8230_Regs.h"
+
+#define		_SYSTEMTICK_US			166.67			// Same as __SYSTEMTICK_US in osmain.h.
+#define		_NUM_SYSTEMTICK_MSEC	6				// Same as __NUM_SYSTEMTICK_MSEC in osmain.h.
+#define		_IMAGE_VRESOLUTION		120
+#define		_CAMERA_I2C2_ADD		60				// Same as Driver_TCM8230.c.
+#define		_MAX_I2C_DATA_BYTE		16				// Same as __MAX_I2C_DATA_BYTE in Driver_I2C1_V100.h.
+
+// I2C master interface, same as Driver_I2C1_V100.h.
+struct
+{
+	unsigned int bSend: 1;
+	unsigned int bI2CBusy: 1;
+} gI2CStat;
+uint8_t		gbytI2CSlaveAdd;
+uint8_t		gbytI2CRegAdd;
+uint8_t		gbytI2CByteCount;
+uint8_t		gbytI2CTXbuf[_MAX_I2C_DATA_BYTE];
+
+// Fake TWI module and camera.
+double		gdTime = 0.0;						// Simulated time in usec.
+double		gdBitTime = 10.0;					// I2C bit period in usec, 100 kHz.
+double		gdShiftEnd = 0.0;					// Time when the last byte written to TWIHS_THR is sent.
+int			gnSlaveByte = 0;					// Byte no. in current transaction, 0 = register address.
+int			gnSlaveReg = 0;						// Register address pointer of the camera.
+uint8_t		gbytSlaveReg[256];					// Camera registers.
+double		gdCameraOn = -1.0;					// Time when the camera is turned on, -1 if off.
+unsigned int	gunTransactions = 0;
+unsigned int	gunDataBytes = 0;
+
+/// Write to the transmit holding register, TWIHS_THR.  A START condition and the slave address
+/// come before the first byte of a transaction.
+static void TWIWrite(uint8_t bytData)
+{
+	double dStart = (gdShiftEnd > gdTime) ? gdShiftEnd : gdTime;
+	
+	if (gnSlaveByte == 0)
+	{
+		dStart = dStart + 10*gdBitTime;			// START condition and slave address + ACK.
+		gunTransactions++;
+	}
+	gdShiftEnd = dStart + 9*gdBitTime;			// 8 data bits + ACK.
+	if (gnSlaveByte == 0)
+	{
+		gnSlaveReg = bytData;
+	}
+	else
+	{
+		gbytSlaveReg[gnSlaveReg & 0xFF] = bytData;
+		gunDataBytes++;
+		if ((gnSlaveReg == 0x03) && (gdCameraOn < 0.0))
+		{
+			gdCameraOn = gdShiftEnd;
+		}
+		gnSlaveReg++;							// Auto-increment.
+	}
+	gnSlaveByte++;
+}
+
+/// TXRDY, the holding register is free once the previous byte is moved to the shift register.
+static int nTWITXReady(void)
+{
+	return (gdShiftEnd - gdTime) <= 9*gdBitTime;
+}
+
+/// TXCOMP after the STOP condition.
+static int nTWITXComplete(void)
+{
+	return gdTime >= gdShiftEnd + gdBitTime;
+}
+
+/// Write path of Proce_I2C1_Driver(), states 1 and 45 to 49.
+static void I2CDriver(int *ptrState)
+{
+	static int nCount;
+	
+	switch (*ptrState)
+	{
+		case 1:
+			if (gI2CStat.bSend == 1)
+			{
+				gI2CStat.bI2CBusy = 1;
+				*ptrState = 45;
+			}
+		break;
+		
+		case 45:
+			nCount = 0;
+			gnSlaveByte = 0;
+			*ptrState = 46;
+		break;
+		
+		case 46:
+			TWIWrite(gbytI2CRegAdd);
+			*ptrState = 47;
+		break;
+		
+		case 47:
+			if (nTWITXReady() == 1)
+			{
+				if (gbytI2CByteCount > nCount)
+				{
+					TWIWrite(gbytI2CTXbuf[nCount]);
+					nCount++;
+				}
+				else
+				{
+					*ptrState = 48;					// STOP condition.
+				}
+			}
+		break;
+		
+		case 48:
+			if (nTWITXComplete() == 1)
+			{
+				*ptrState = 49;
+			}
+		break;
+		
+		case 49:
+			gI2CStat.bI2CBusy = 0;
+			gI2CStat.bSend = 0;
+			*ptrState = 1;
+		break;
+	}
+}
+
+/// Send one register, the old chain of states 5 to 7.
+static void I2CSendReg(uint8_t bytReg, uint8_t bytValue)
+{
+	gbytI2CByteCount = 1;
+	gbytI2CRegAdd = bytReg;
+	gbytI2CTXbuf[0] = bytValue;
+	gbytI2CSlaveAdd = _CAMERA_I2C2_ADD;
+	gI2CStat.bSend = 1;
+}
+
+int main(int argc, char **argv)
+{
+	int nOption;
+	int nLegacy = 0;
+	double dFrameRate = _HOST_FRAME_RATE;
+	double dFrame;								// Frame period in usec.
+	double dActive;								// Duration of the pixel lines in a frame in usec.
+	double dFrameStart;
+	double dWriteStart = 0.0;
+	double dWriteEnd = 0.0;
+	double dFirstFrame = -1.0;
+	double dReconfigStart = 0.0;
+	int nState = 0;
+	int nTimer = 0;
+	int nI2CState = 1;
+	int nCount = 0;
+	int nTemp;
+	int nFrames = 0;
+	int nReconfig = 0;
+	unsigned int unTransactions = 0;
+	unsigned int unDataBytes = 0;
+	
+	while ((nOption = getopt(argc, argv, "lr:b:")) != -1)
+	{
+		switch (nOption)
+		{
+			case 'l':	nLegacy = 1;	break;
+			case 'r':	dFrameRate = atof(optarg);	break;
+			case 'b':	gdBitTime = 1000.0/atof(optarg);	break;
+			default:
+				printf("Usage: %s [-l] [-r fps] [-b I2C baud rate kHz]\n", argv[0]);
+				return 1;
+		}
+	}
+	dFrame = 1000000.0/dFrameRate;
+	dActive = dFrame*_IMAGE_VRESOLUTION*_HOST_LINE_SUBSAMPLE/_HOST_SENSOR_LINES;
+	
+	while (nFrames < 3)
+	{
+		gdTime = gdTime + _SYSTEMTICK_US;
+		I2CDriver(&nI2CState);
+		if (nTimer > 0)
+		{
+			nTimer--;
+			continue;
+		}
+		dFrameStart = -1.0;						// Start of the current frame of the camera.
+		if (gdCameraOn >= 0.0)
+		{
+			nTemp = (int) ((gdTime - gdCameraOn)/dFrame);
+			if (nTemp > 0)
+			{
+				dFrameStart = gdCameraOn + nTemp*dFrame;
+			}
+		}
+		// Start-up states of Proce_TCM8230_Driver(), the timer is decremented once per tick.
+		switch (nState)
+		{
+			case 0:	nState = 1;	nTimer = 500*_NUM_SYSTEMTICK_MSEC;	break;
+			case 1:	nState = 2;	nTimer = 20*_NUM_SYSTEMTICK_MSEC;	break;
+			case 2:	nState = 3;	nTimer = 100*_NUM_SYSTEMTICK_MSEC;	break;
+			case 3:	nCount++;	nState = 4;	nTimer = 200*_NUM_SYSTEMTICK_MSEC;	break;
+			case 4:	nState = (nCount > 3) ? 5 : 0;	nTimer = 1*_NUM_SYSTEMTICK_MSEC;	break;
+			
+			case 5:
+				dWriteStart = gdTime;
+				if (nLegacy == 1)
+				{
+					if (gI2CStat.bI2CBusy == 0)
+					{
+						I2CSendReg(0x1E, 0x6C);
+						nState = 6;
+						nTimer = 5*_NUM_SYSTEMTICK_MSEC;
+					}
+				}
+				else
+				{
+					CameraLoadInitTable();
+					nState = 6;
+				}
+			break;
+			
+			case 6:
+				if (nLegacy == 1)
+				{
+					if (gI2CStat.bI2CBusy == 0)
+					{
+						I2CSendReg(0x02, 0x00);
+						nState = 7;
+						nTimer = 5*_NUM_SYSTEMTICK_MSEC;
+					}
+				}
+				else if ((gI2CStat.bI2CBusy == 0) && (gI2CStat.bSend == 0))
+				{
+					nTemp = nCameraNextBurst(&gbytI2CRegAdd, gbytI2CTXbuf);
+					if (nTemp > 0)
+					{
+						gbytI2CByteCount = nTemp;
+						gbytI2CSlaveAdd = _CAMERA_I2C2_ADD;
+						gI2CStat.bSend = 1;
+					}
+					else
+					{
+						nState = 8;
+					}
+				}
+			break;
+			
+			case 7:
+				if (gI2CStat.bI2CBusy == 0)
+				{
+					I2CSendReg(0x03, 0x0E);
+					nState = 8;
+					nTimer = 5*_NUM_SYSTEMTICK_MSEC;
+				}
+			break;
+			
+			case 8:									// Wait for idle condition.
+				if (dWriteEnd == 0.0)
+				{
+					dWriteEnd = gdTime;
+				}
+				if (nReconfig == 1)
+				{
+					printf("Reconfiguration: %u transaction(s), %u data byte(s), %.2f msec\n", 
+						gunTransactions - unTransactions, gunDataBytes - unDataBytes, (gdTime - dReconfigStart)/1000.0);
+					nReconfig = 2;
+				}
+				if ((dFrameStart >= 0.0) && (gdTime >= dFrameStart + dActive))
+				{
+					nState = 9;
+				}
+			break;
+			
+			case 9:									// Wait for start of new frame.
+				if ((dFrameStart >= 0.0) && (gdTime < dFrameStart + dActive))
+				{
+					nState = 10;
+				}
+			break;
+			
+			case 10:								// Lines of the frame.
+				if (gdTime >= dFrameStart + dActive)
+				{
+					nState = 11;
+				}
+			break;
+			
+			case 11:								// End of frame.
+				nFrames++;
+				if (dFirstFrame < 0.0)
+				{
+					dFirstFrame = gdTime;
+					unTransactions = gunTransactions;
+					unDataBytes = gunDataBytes;
+					printf("Register writes: %u transaction(s), %u data byte(s), %.2f msec\n", 
+						gunTransactions, gunDataBytes, (dWriteEnd - dWriteStart)/1000.0);
+					if (nLegacy == 0)				// Change the picture mode and frame rate only, 
+					{								// register 0x03 is unchanged.
+						nCameraWriteReg(0x1E, 0x68);
+						nCameraWriteReg(0x02, 0x80);
+						nCameraWriteReg(0x03, 0x0E);
+						printf("Queued %d register write(s) after the first frame\n", nCameraWritePending());
+					}
+				}
+				if (nCameraWritePending() > 0)
+				{
+					dReconfigStart = gdTime;
+					nReconfig = 1;
+					nState = 6;
+				}
+				else
+				{
+					nState = 8;
+				}
+			break;
+		}
+	}
+	printf("Camera on: %.2f msec after power up\n", gdCameraOn/1000.0);
+	printf("First frame: %.2f msec after power up, %.2f msec after the first register write\n", 
+		dFirstFrame/1000.0, (dFirstFrame - dWriteStart)/1000.0);
+	printf("Camera registers 0x02 = 0x%02X, 0x03 = 0x%02X, 0x1E = 0x%02X\n", 
+		gbytSlaveReg[0x02], gbytSlaveReg[0x03], gbytSlaveReg[0x1E]);
+	return 0;
+}
@@ -0,0 +1,232 @@
+//////////////////////////////////////////////////////////////////////////////////////////////
+//
+// File				: Capture_Host_BMP.c
+// Author(s)		: Fabian Kung
+// Last modified	: 16 Oct 2026
+// Tool-suites		: GCC C-Compiler (Linux or MinGW)
+//////////////////////////////////////////////////////////////////////////////////////////////
+// Implementation of Driver_Capture_HAL.h for the computer.  The frames are loaded from 24-bits
+// BMP files (e.g. MVM_Miscellaneous/Python/Img.bmp) and played back in a loop with the line timing
+// of the camera, see Capture_Host_BMP.h.  The pixels are stored in the line buffer in the same 
+// format as the parallel capture of the MVM, e.g. RGB565 with the upper and lower bytes swapped.
+// A line is received only if CaptureHALArmLine() is called before the line starts, otherwise the
+// line is lost and nCaptureHALOverrun() returns 1, the same as the OVRE flag of the parallel capture.
+// The D-Cache maintenance of Driver_Capture_SAMS70.c is repeated with the host version of 
+// Driver_Cache_HAL.h (__CACHE_HAL_HOST), so the no. of bytes maintained per frame can be compared.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "Capture_Host_BMP.h"
+#include "Driver_Cache_HAL.h"
+
+unsigned int	gunCacheCleanBytes = 0;
+unsigned int	gunCacheInvalidateBytes = 0;
+
+// --- PRIVATE VARIABLES ---
+static char		**gptrFileName;
+static uint16_t	**gptrFrameData;		// Raw pixels of each frame, [frame][y*width + x].
+static int		gnNoOfFrames;
+static int		gnWidth;
+static int		gnHeight;
+static double	gdFramePeriod;			// In seconds.
+static double	gdSensorLinePeriod;		// In seconds.
+static double	gdTimeStart;
+static uint16_t	*gptrLine;				// Line buffer armed by CaptureHALArmLine(), NULL if not armed.
+static long		glLineArmed;			// Line no. (since nCaptureHostOpen()) to be received.
+static long		glLineLast = -1;		// Last line received.
+static int		gnOverrun;
+
+static double dTimeNow(void)
+{
+	struct timespec strcTime;
+	
+	clock_gettime(CLOCK_MONOTONIC, &strcTime);
+	return strcTime.tv_sec + 1.0e-9*strcTime.tv_nsec;
+}
+
+double dCaptureHostTime(void)
+{
+	return dTimeNow() - gdTimeStart;
+}
+
+double dCaptureHostLinePeriod(void)
+{
+	return gdSensorLinePeriod*_HOST_LINE_SUBSAMPLE;
+}
+
+/// Start time of line nLine (line no. since nCaptureHostOpen()), in seconds.
+static double dLineStart(long lLine)
+{
+	return (lLine/gnHeight)*gdFramePeriod + (lLine%gnHeight)*dCaptureHostLinePeriod();
+}
+
+/// Position in the frame at time dTime, return the frame no. and the offset from the start of frame.
+static long lFrameAt(double dTime, double *ptrOffset)
+{
+	long lFrame = (long) floor(dTime/gdFramePeriod);
+	
+	*ptrOffset = dTime - lFrame*gdFramePeriod;
+	return lFrame;
+}
+
+/// Load a 24-bits uncompressed BMP file and resize it to nWidth x nHeight pixels (nearest 
+/// neighbour), the pixels are converted to raw pixel data of the parallel capture.
+static uint16_t *ptrLoadBMP(const char *ptrName, int nWidth, int nHeight)
+{
+	FILE *ptrFile;
+	unsigned char bytHeader[54];
+	unsigned char *ptrData;
+	uint16_t *ptrFrame;
+	int nBMPWidth, nBMPHeight, nRowSize, nOffset;
+	int nx, ny, nSrcx, nSrcy;
+	unsigned char *ptrPixel;
+	uint16_t un16RGB;
+	
+	ptrFile = fopen(ptrName, "rb");
+	if (ptrFile == NULL)
+	{
+		return NULL;
+	}
+	if ((fread(bytHeader, 1, 54, ptrFile) != 54) || (bytHeader[0] != 'B') || (bytHeader[1] != 'M') || (bytHeader[28] != 24))
+	{
+		fclose(ptrFile);
+		return NULL;
+	}
+	nOffset = bytHeader[10] | (bytHeader[11] << 8) | (bytHeader[12] << 16) | (bytHeader[13] << 24);
+	nBMPWidth = bytHeader[18] | (bytHeader[19] << 8) | (bytHeader[20] << 16) | (bytHeader[21] << 24);
+	nBMPHeight = bytHeader[22] | (bytHeader[23] << 8) | (bytHeader[24] << 16) | (bytHeader[25] << 24);
+	if ((nBMPWidth <= 0) || (nBMPHeight <= 0))		// Top-down BMP not supported.
+	{
+		fclose(ptrFile);
+		return NULL;
+	}
+	nRowSize = (3*nBMPWidth + 3) & ~3;				// Each row is padded to 4 bytes.
+	ptrData = malloc(nRowSize*nBMPHeight);
+	ptrFrame = malloc(sizeof(uint16_t)*nWidth*nHeight);
+	fseek(ptrFile, nOffset, SEEK_SET);
+	if ((ptrData == NULL) || (ptrFrame == NULL) || (fread(ptrData, 1, nRowSize*nBMPHeight, ptrFile) != (size_t) (nRowSize*nBMPHeight)))
+	{
+		free(ptrData);
+		free(ptrFrame);
+		fclose(ptrFile);
+		return NULL;
+	}
+	fclose(ptrFile);
+	
+	for (ny = 0; ny < nHeight; ny++)
+	{
+		nSrcy = (ny*nBMPHeight)/nHeight;
+		for (nx = 0; nx < nWidth; nx++)
+		{
+			nSrcx = (nx*nBMPWidth)/nWidth;
+			ptrPixel = ptrData + (nBMPHeight - 1 - nSrcy)*nRowSize + 3*nSrcx;	// BMP rows are stored bottom-up, in B, G, R order.
+			un16RGB = ((ptrPixel[2] >> 3) << 11) | ((ptrPixel[1] >> 2) << 5) | (ptrPixel[0] >> 3);
+			ptrFrame[ny*nWidth + nx] = (uint16_t) ((un16RGB << 8) | (un16RGB >> 8));	// Byte order of the parallel capture.
+		}
+	}
+	free(ptrData);
+	return ptrFrame;
+}
+
+/// Load the BMP files, nHeight is the no. of lines per frame and dFrameRate the frame rate in fps.
+/// The width is set by CaptureHALInit().  Call this before CaptureHALInit().
+int nCaptureHostOpen(char **ptrNames, int nNoOfFiles, int nHeight, double dFrameRate)
+{
+	gnNoOfFrames = nNoOfFiles;
+	gnHeight = nHeight;
+	gdFramePeriod = 1.0/dFrameRate;
+	gdSensorLinePeriod = gdFramePeriod/_HOST_SENSOR_LINES;
+	gptrFileName = ptrNames;					// Loaded in CaptureHALInit() once the width is known.
+	return ((nNoOfFiles > 0) && (nHeight*_HOST_LINE_SUBSAMPLE <= _HOST_SENSOR_LINES)) ? 0 : -1;
+}
+
+void CaptureHALInit(uint16_t *ptrLine, int nWidth)
+{
+	int nIndex;
+	
+	gnWidth = nWidth;
+	gptrFrameData = malloc(sizeof(uint16_t *)*gnNoOfFrames);
+	for (nIndex = 0; nIndex < gnNoOfFrames; nIndex++)
+	{
+		gptrFrameData[nIndex] = ptrLoadBMP(gptrFileName[nIndex], gnWidth, gnHeight);
+		if (gptrFrameData[nIndex] == NULL)
+		{
+			fprintf(stderr, "Capture_Host_BMP: Cannot load %s, a 24-bits BMP file is needed.\n", gptrFileName[nIndex]);
+			exit(1);
+		}
+	}
+	(void) ptrLine;								// The line buffer is given by CaptureHALArmLine().
+	gptrLine = NULL;
+	glLineLast = -1;
+	gnOverrun = 0;
+	gdTimeStart = dTimeNow();
+}
+
+/// Vertical blanking, after the last line of the frame.
+int nCaptureHALIdle(void)
+{
+	double dOffset;
+	
+	lFrameAt(dCaptureHostTime(), &dOffset);
+	return (dOffset >= gnHeight*dCaptureHostLinePeriod());
+}
+
+int nCaptureHALStartOfFrame(void)
+{
+	return (nCaptureHALIdle() == 0);
+}
+
+/// The line received is the first line which starts after this call.  The lines that start between
+/// the last line received and this call are lost.
+void CaptureHALArmLine(uint16_t *ptrLine)
+{
+	double dOffset;
+	long lFrame;
+	long lLine;
+	double dPeriod = dCaptureHostLinePeriod();
+	
+	lFrame = lFrameAt(dCaptureHostTime(), &dOffset);
+	lLine = (long) ceil(dOffset/dPeriod);
+	if (lLine >= gnHeight)						// Vertical blanking, the next line is the first line of next frame.
+	{
+		lFrame++;
+		lLine = 0;
+	}
+	glLineArmed = lFrame*gnHeight + lLine;
+	if ((glLineLast >= 0) && (glLineArmed > glLineLast + 1) && ((glLineArmed/gnHeight) == (glLineLast/gnHeight)))
+	{
+		gnOverrun = 1;							// Lines in the same frame are lost.
+	}
+	CacheCleanRange(ptrLine, gnWidth*sizeof(uint16_t));		// Same as Driver_Capture_SAMS70.c.
+	CacheInvalidateRange(ptrLine, gnWidth*sizeof(uint16_t));
+	gptrLine = ptrLine;
+}
+
+int nCaptureHALLineDone(void)
+{
+	uint16_t *ptrFrame;
+	
+	if (gptrLine == NULL)
+	{
+		return 1;
+	}
+	if (dCaptureHostTime() < dLineStart(glLineArmed) + gdSensorLinePeriod)
+	{
+		return 0;
+	}
+	ptrFrame = gptrFrameData[(glLineArmed/gnHeight) % gnNoOfFrames];
+	memcpy(gptrLine, &ptrFrame[(glLineArmed%gnHeight)*gnWidth], sizeof(uint16_t)*gnWidth);
+	glLineLast = glLineArmed;
+	gptrLine = NULL;
+	return 1;
+}
+
+int nCaptureHALOverrun(void)
+{
+	int nOverrun = gnOverrun;
+	
+	gnOverrun = 0;
+	return nOverrun;
+}
@@ -0,0 +1,30 @@
+//////////////////////////////////////////////////////////////////////////////////////////////
+//
+// File				: Capture_Host_BMP.h
+// Author(s)		: Fabian Kung
+// Last modified	: 16 Oct 2026
+// Tool-suites		: GCC C-Compiler (Linux or MinGW)
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _CAPTURE_HOST_BMP_H
+#define _CAPTURE_HOST_BMP_H
+
+#define		__CACHE_HAL_HOST				// Host version of Driver_Cache_HAL.h.
+#include "Driver_Capture_HAL.h"
+
+// Line timing of the TCM8230 camera, the frame is made up of _HOST_SENSOR_LINES sensor lines.  In 
+// QQVGA mode the camera outputs 1 line of pixels every _HOST_LINE_SUBSAMPLE sensor lines, the pixel
+// data of each line lasts for 1 sensor line period.
+#define		_HOST_SENSOR_LINES		507
+#define		_HOST_LINE_SUBSAMPLE	4
+#define		_HOST_FRAME_RATE		20.83		// Frames per second, PCK2 = 16.667 MHz.
+
+//
+// --- PUBLIC FUNCTION PROTOTYPE ---
+//
+int nCaptureHostOpen(char **, int, int, double);	// BMP file names, no. of files, frame height, frame rate.
+													// Return 0 if all files are loaded, else -1.
+double dCaptureHostTime(void);						// Time since nCaptureHostOpen() in seconds.
+double dCaptureHostLinePeriod(void);				// Period between the start of two lines in seconds.
+
+#endif
@@ -0,0 +1,188 @@
+//////////////////////////////////////////////////////////////////////////////////////////////
+//
+// File				: Capture_Host_Playback.c
+// Author(s)		: Fabian Kung
+// Last modified	: 16 Oct 2026
+// Tool-suites		: GCC C-Compiler (Linux or MinGW)
+//////////////////////////////////////////////////////////////////////////////////////////////
+// Measure the line processing margin of the camera driver on the computer.  The line capture loop
+// of Proce_TCM8230_Driver() (states 8 to 11) is run with Capture_Host_BMP.c, the loop is called once
+// every system tick as in the RTOS.  Each line is pre-processed (luminance, mode 0) and an extra 
+// busy-wait is added to emulate a longer line kernel, and another busy-wait after each call
+// emulates the other tasks.  The no. of line overruns and frames dropped are reported.  Run it on an
+// idle computer, a tick latency longer than the line period means the process is pre-empted by the 
+// operating system and the overruns are not caused by the line pre-processing.
+//
+// Add -D__CACHE_MAINT_WHOLE to count the D-Cache maintenance of the whole D-Cache in each call.
+// Build: gcc -O2 -I. -I../../MVM_Sample_Firmware_R0.95_CNN Capture_Host_Playback.c Capture_Host_BMP.c -lm -o playback
+// Usage: ./playback [-f frames] [-l line load usec] [-t other tasks usec] [-r fps] file1.bmp [file2.bmp ...]
+// Example: ./playback -f 50 -l 150 ../Python/Img.bmp
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "Capture_Host_BMP.h"
+#include "Driver_Cache_HAL.h"
+
+#define		_IMAGE_HRESOLUTION		160
+#define		_IMAGE_VRESOLUTION		120
+#define		_SYSTEMTICK_US			166.67			// Same as __SYSTEMTICK_US in osmain.h.
+#define		_CAMERA_LINE_BUFFERS	2				// Same as Driver_TCM8230.c.
+
+uint16_t gun16PixelLine[_CAMERA_LINE_BUFFERS][_IMAGE_HRESOLUTION];
+uint8_t	gun8Lum[_IMAGE_VRESOLUTION][_IMAGE_HRESOLUTION];
+
+static void BusyWait(double dSeconds)
+{
+	double dStop = dCaptureHostTime() + dSeconds;
+	
+	while (dCaptureHostTime() < dStop) {}
+}
+
+/// Luminance mode 0 of the camera driver, I = (2R + 5G + B)/8.
+static unsigned int unLumLine(const uint16_t *ptrPixel, uint8_t *ptrLum)
+{
+	int ncolindex;
+	unsigned int unTemp;
+	int nR6, nG6, nB6;
+	unsigned int unLumSum = 0;
+	
+	for (ncolindex = 0; ncolindex < _IMAGE_HRESOLUTION; ncolindex++)
+	{
+		unTemp = (uint16_t) ((ptrPixel[ncolindex] << 8) | (ptrPixel[ncolindex] >> 8));
+		nR6 = (unTemp >> 10) & 0x3E;
+		nG6 = (unTemp >> 5) & 0x3F;
+		nB6 = (unTemp & 0x01F) << 1;
+		ptrLum[ncolindex] = ((nR6 << 1) + (nG6 << 2) + nB6 + nG6) >> 2;
+		unLumSum = unLumSum + ptrLum[ncolindex];
+	}
+	return unLumSum;
+}
+
+int main(int argc, char **argv)
+{
+	int nOption;
+	int nFrames = 20;
+	double dLineLoad = 0.0;
+	double dOtherTasks = 0.0;
+	double dFrameRate = _HOST_FRAME_RATE;
+	int nState = 8;
+	int nLineCounter = 0;
+	int nLineBuffer = 0;
+	int nTemp;
+	int nFrameOverrun = 0;
+	int nFrameCount = 0;
+	unsigned int unLineOverrun = 0;
+	unsigned int unFrameDropped = 0;
+	unsigned int unLumSum = 0;
+	double dTick;
+	double dStart;
+	double dLine;
+	double dLineMax = 0.0;
+	double dTickLate;
+	double dTickLateMax = 0.0;
+	
+	while ((nOption = getopt(argc, argv, "f:l:t:r:")) != -1)
+	{
+		switch (nOption)
+		{
+			case 'f': nFrames = atoi(optarg); break;
+			case 'l': dLineLoad = atof(optarg)*1.0e-6; break;
+			case 't': dOtherTasks = atof(optarg)*1.0e-6; break;
+			case 'r': dFrameRate = atof(optarg); break;
+			default:
+				fprintf(stderr, "Usage: %s [-f frames] [-l line load usec] [-t other tasks usec] [-r fps] file1.bmp ...\n", argv[0]);
+				return 1;
+		}
+	}
+	if ((optind >= argc) || (nCaptureHostOpen(&argv[optind], argc - optind, _IMAGE_VRESOLUTION, dFrameRate) != 0))
+	{
+		fprintf(stderr, "Need at least one 24-bits BMP file.\n");
+		return 1;
+	}
+	CaptureHALInit(gun16PixelLine[0], _IMAGE_HRESOLUTION);
+	
+	dTick = 0.0;
+	while (nFrameCount < nFrames)
+	{
+		while (dCaptureHostTime() < dTick) {}		// Wait for the next system tick.
+		dTickLate = dCaptureHostTime() - dTick;		// Delay due to the operating system of the computer, if
+		if (dTickLate > dTickLateMax)				// this is longer than a line period the overruns are not
+		{											// caused by the line pre-processing.
+			dTickLateMax = dTickLate;
+		}
+		dTick = dTick + _SYSTEMTICK_US*1.0e-6;
+		switch (nState)
+		{
+			case 8: // Wait for vertical blanking.
+				nState = (nCaptureHALIdle() == 1) ? 9 : 8;
+			break;
+			
+			case 9: // Wait for start of new frame.
+				if (nCaptureHALStartOfFrame() == 1)
+				{
+					nLineBuffer = 0;
+					CaptureHALArmLine(gun16PixelLine[0]);
+					nCaptureHALOverrun();
+					nFrameOverrun = 0;
+					nLineCounter = 0;
+					nState = 10;
+				}
+			break;
+			
+			case 10: // Wait for a line, re-arm the DMA on the next line buffer then pre-process the line.
+				if (nCaptureHALLineDone() == 1)
+				{
+					nLineCounter++;
+					nTemp = nLineBuffer;
+					nLineBuffer++;
+					if (nLineBuffer == _CAMERA_LINE_BUFFERS)
+					{
+						nLineBuffer = 0;
+					}
+					CaptureHALArmLine(gun16PixelLine[nLineBuffer]);
+					if (nCaptureHALOverrun() == 1)
+					{
+						unLineOverrun++;
+						nFrameOverrun++;
+					}
+					dStart = dCaptureHostTime();
+					unLumSum = unLumSum + unLumLine(gun16PixelLine[nTemp], gun8Lum[nLineCounter - 1]);
+					BusyWait(dLineLoad);
+					dLine = dCaptureHostTime() - dStart;
+					if (dLine > dLineMax)
+					{
+						dLineMax = dLine;
+					}
+				}
+				if (nLineCounter == _IMAGE_VRESOLUTION)
+				{
+					nState = 11;
+				}
+			break;
+			
+			case 11: // End of frame.
+				if (nFrameOverrun > 0)
+				{
+					unFrameDropped++;
+				}
+				nFrameCount++;
+				nState = 8;
+			break;
+		}
+		BusyWait(dOtherTasks);
+	}
+	
+	printf("Line period              : %.1f usec\n", dCaptureHostLinePeriod()*1.0e6);
+	printf("System tick              : %.1f usec\n", _SYSTEMTICK_US);
+	printf("Max. line pre-processing : %.1f usec\n", dLineMax*1.0e6);
+	printf("Margin                   : %.1f usec (line period - max. line - tick - other tasks)\n",
+			(dCaptureHostLinePeriod() - dLineMax - _SYSTEMTICK_US*1.0e-6 - dOtherTasks)*1.0e6);
+	printf("Max. tick latency (host) : %.1f usec\n", dTickLateMax*1.0e6);
+	printf("Frames                   : %d\n", nFrameCount);
+	printf("Line overruns            : %u\n", unLineOverrun);
+	printf("Frames dropped           : %u\n", unFrameDropped);
+	printf("D-Cache cleaned          : %u bytes/frame\n", gunCacheCleanBytes/nFrameCount);
+	printf("D-Cache invalidated      : %u bytes/frame\n", gunCacheInvalidateBytes/nFrameCount);
+	printf("Average luminance        : %u\n", unLumSum/(nFrameCount*_IMAGE_VRESOLUTION*_IMAGE_HRESOLUTION));
+	return 0;
+}
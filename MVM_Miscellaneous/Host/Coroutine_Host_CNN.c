@@ -0,0 +1,265 @@
+//////////////////////////////////////////////////////////////////////////////////////////////
+//
+// File				: Coroutine_Host_CNN.c
+// Author(s)		: Fabian Kung
+// Last modified	: 16 Oct 2026
+// Tool-suites		: GCC C-Compiler (Linux)
+//////////////////////////////////////////////////////////////////////////////////////////////
+// Run the dense layers of the CNN of Proce_Image4() on the computer with the Scheduler loop of
+// main.c, in real time with a system tick of __SYSTEMTICK_US, and compare:
+// -m sm - Proce_Image4() states 4 and 5, a state machine which saves the progress of DNN1 in a
+//         static variable at the end of each system tick (default).
+// -m co - CoTask_CNNDense() as a co-task, see os_Coroutine.h, with the host (ucontext) context
+//         switch.
+// The dense layers are the functions of CNN_Dense.h, os_APIs.c and os_Coroutine.c are compiled
+// from the firmware folder, sam.h and sams70j20.h in this folder replace the device headers.  The other tasks of the firmware are modelled by a
+// task which uses -l processor cycles in each system tick.  The output of DNN2 is checked
+// against a reference computed without the Scheduler for each frame.  The processor of the
+// computer is much faster than the SAMS70 and swapcontext() makes a system call, so the no. of
+// system ticks and the cost of the context switch are not representative of the target.
+// Build: gcc -O2 -D__OS_COROUTINE_HOST -I. -I../../MVM_Sample_Firmware_R0.95_CNN Coroutine_Host_CNN.c
+//        ../../MVM_Sample_Firmware_R0.95_CNN/os_APIs.c ../../MVM_Sample_Firmware_R0.95_CNN/os_Coroutine.c
+//        -o coroutine_cnn
+// Usage: ./coroutine_cnn [-m sm|co] [-l load cycles] [-n frames]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "osmain.h"
+#include "os_Profile.h"
+#include "os_Coroutine.h"
+#include "CNN.h"
+
+#define		PIN_FLAG4_SET						// The pin of flag 4 is not used on the computer.
+#define		PIN_FLAG4_CLEAR
+
+#include "CNN_Dense.h"
+
+#define		_HOST_STACK_WORDS		4096		// Stack of the co-task, swapcontext() needs more than the target.
+#define		_HOST_INPUT_MAX			256			// Range of the flatten nodes, 0 to _HOST_INPUT_MAX-1.
+#define		_HOST_IMAGE4_TASK		1			// Index of Proce_HostImage4() in gstrcTaskContext[].
+#define		_HOST_DENSE_TASK		2			// Index of CoTask_CNNDense() in gstrcTaskContext[].
+
+int				*gptrnCNNFlat;
+int				*gptrnCNNOut;
+uint32_t		gunCNNDenseStack[_HOST_STACK_WORDS];
+
+int				gnHostLoad = 0;					// Processor cycles of the other tasks in each system tick.
+int				gnHostFrames = 20;
+int				gnHostCoroutine = 0;
+int				gnHostDone = 0;
+int				gnHostErrors = 0;
+unsigned int	gunHostSlices = 0;				// No. of system ticks the dense layers run in.
+unsigned int	gunHostTicks = 0;				// No. of system ticks from the start to the end of the dense layers.
+
+int				gnHostFlat[__FLATTENNODE];
+int				gnHostOut[__DNN2NODE];
+int				gnHostRef[__DNN2NODE];
+
+// Dense layers without the Scheduler.
+void HostReference(int *ptrnFlat, int *ptrnOut)
+{
+	int		nDNN1Out[__DNN1NODE];
+	int		nNode, ni;
+	int64_t	lnsTemp;
+
+	for (nNode = 0; nNode < __DNN1NODE; nNode++)
+	{
+		lnsTemp = 0;
+		for (ni = 0; ni < __FLATTENNODE; ni++)
+		{
+			lnsTemp = lnsTemp + ((int64_t) ptrnFlat[ni])*gnDNN1w[ni][nNode];
+		}
+		lnsTemp = lnsTemp + ((int64_t) gnDNN1bias[nNode])*1000000;
+		nDNN1Out[nNode] = lnsTemp/1000000;
+		if (nDNN1Out[nNode] < 0)
+		{
+			nDNN1Out[nNode] = 0;
+		}
+	}
+	for (nNode = 0; nNode < __DNN2NODE; nNode++)
+	{
+		lnsTemp = 0;
+		for (ni = 0; ni < __DNN1NODE; ni++)
+		{
+			lnsTemp = lnsTemp + ((int64_t) nDNN1Out[ni])*gnDNN2w[ni][nNode];
+		}
+		lnsTemp = lnsTemp + ((int64_t) gnDNN2bias[nNode])*1000000;
+		ptrnOut[nNode] = lnsTemp/1000000;
+	}
+}
+
+// Same as CoTask_CNNDense() in User_Task.c.
+void CoTask_CNNDense(void)
+{
+	while (1)
+	{
+		unOSCoWaitEvent(__EVENT_CNN_START, 0);	// Sleep until the flatten nodes are ready.
+		CNNDenseCoTask(gptrnCNNFlat, gptrnCNNOut);
+		OSSignalEvent(__EVENT_CNN_DONE);		// Wake up Proce_Image4().
+	}
+}
+
+// The other tasks of the firmware.
+void Proce_HostLoad(TASK_ATTRIBUTE *ptrTask)
+{
+	unsigned int unStart = DWT->CYCCNT;
+
+	while ((int) (DWT->CYCCNT - unStart) < gnHostLoad)
+	{
+	}
+	OSSetTaskContext(ptrTask, 0, 1);
+}
+
+// Proce_Image4() reduced to the dense layers, states 4 and 5 of User_Task.c run in one state.
+void Proce_HostImage4(TASK_ATTRIBUTE *ptrTask)
+{
+	static	int ni;
+	static	int nFrame = 0;
+	static	unsigned int unTickStart;
+	static	CNN_DENSE1 strcDense;
+	static  int nDNN1Out[__DNN1NODE];
+
+	if (ptrTask->nTimer == 0)
+	{
+		switch (ptrTask->nState)
+		{
+			case 0: // State 0 - New input, the flatten nodes of Layer 0.
+			if (nFrame >= gnHostFrames)
+			{
+				gnHostDone = 1;
+				OSSetTaskContext(ptrTask, 0, -1);
+				break;
+			}
+			srand(nFrame + 1);
+			for (ni = 0; ni < __FLATTENNODE; ni++)
+			{
+				gnHostFlat[ni] = rand() % _HOST_INPUT_MAX;
+			}
+			HostReference(gnHostFlat, gnHostRef);
+			memset(gnHostOut, 0, sizeof(gnHostOut));
+			nFrame++;
+			CNNDense1Init(&strcDense);
+			OSSetTaskContext(ptrTask, 4, 1);	// Next state = 4, timer = 1.
+			break;
+
+			case 4: // State 4 - Compute the output of each nodes in Layer DNN1 and DNN2.
+			if (gnHostCoroutine == 1)
+			{
+				unTickStart = gunClockTick;
+				gptrnCNNFlat = gnHostFlat;
+				gptrnCNNOut = gnHostOut;
+				OSSignalEvent(__EVENT_CNN_START);
+				OSSetTaskContext(ptrTask, 5, 0);
+				OSWaitEvent(ptrTask, __EVENT_CNN_DONE, 0);
+				break;
+			}
+			if ((strcDense.ni == 0) && (strcDense.nNode == 0))
+			{
+				unTickStart = gunClockTick;
+			}
+			if (nCNNDense1(&strcDense, gnHostFlat, nDNN1Out) == 0)
+			{
+				OSSetTaskContext(ptrTask, 4, 1);		// Next state = 4, timer = 1.
+				break;
+			}
+			CNNDense2(nDNN1Out, gnHostOut);
+			OSSetTaskContext(ptrTask, 5, 0);			// Next state = 5.
+			// Fall through - check the output in the same system tick.
+
+			case 5: // State 5 - Check the output of DNN2.
+			gunHostTicks = gunHostTicks + gunClockTick - unTickStart + 1;
+			if (memcmp(gnHostOut, gnHostRef, sizeof(gnHostOut)) != 0)
+			{
+				gnHostErrors++;
+			}
+			OSSetTaskContext(ptrTask, 0, 1);			// Next state = 0, timer = 1.
+			break;
+
+			default:
+			OSSetTaskContext(ptrTask, 0, 1);
+			break;
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int ni;
+	int nOpt;
+	unsigned int unNextTick;
+	unsigned int unTickDeadline;
+	unsigned int unBudgetEnd;
+	unsigned int unStart;
+
+	while ((nOpt = getopt(argc, argv, "m:l:n:")) != -1)
+	{
+		switch (nOpt)
+		{
+			case 'm': gnHostCoroutine = (strcmp(optarg, "co") == 0); break;
+			case 'l': gnHostLoad = atoi(optarg); break;
+			case 'n': gnHostFrames = atoi(optarg); break;
+			default:
+			fprintf(stderr, "Usage: %s [-m sm|co] [-l load cycles] [-n frames]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	OSInit();
+	gnTaskCount = 0;
+	OSCreateTask(&gstrcTaskContext[gnTaskCount], Proce_HostLoad);
+	OSCreateTask(&gstrcTaskContext[gnTaskCount], Proce_HostImage4);
+	if (gnHostCoroutine == 1)
+	{
+		OSCreateCoTask(&gstrcTaskContext[gnTaskCount], CoTask_CNNDense, gunCNNDenseStack, _HOST_STACK_WORDS);
+	}
+
+	unStart = DWT->CYCCNT;
+	unNextTick = unStart;
+	while (gnHostDone == 0)
+	{
+		// Same as main.c, SysTick is replaced by the cycle counter.
+		while ((int) (DWT->CYCCNT - unNextTick) < 0)
+		{
+		}
+		unNextTick = unNextTick + __SYSTEMTICK_CYCLES;
+		gunClockTick++;
+		unTickDeadline = DWT->CYCCNT + __SYSTEMTICK_CYCLES - __OS_TICK_RESERVE_CYCLES;
+		OSUpdateTaskTimer();
+		for (ni = nOSNextReadyTask(0); ni >= 0; ni = nOSNextReadyTask(ni + 1))
+		{
+			gunOSBudgetEnd = unTickDeadline;
+			if (gstrcTaskContext[ni].nBudget > 0)
+			{
+				unBudgetEnd = DWT->CYCCNT + gstrcTaskContext[ni].nBudget;
+				if (((int)(unBudgetEnd - unTickDeadline)) < 0)
+				{
+					gunOSBudgetEnd = unBudgetEnd;
+				}
+			}
+			if (((ni == _HOST_IMAGE4_TASK) && (gnHostCoroutine == 0) && (gstrcTaskContext[ni].nState == 4)) ||
+				(ni == _HOST_DENSE_TASK))
+			{
+				gunHostSlices++;					// A system tick of the dense layers.
+			}
+			(*((TASK_POINTER)gfptrTask[ni]))(&gstrcTaskContext[ni]);
+		}
+	}
+
+	if (gnHostCoroutine == 1)
+	{
+		gunHostSlices--;						// 1st dispatch of the co-task, waits for __EVENT_CNN_START.
+	}
+	printf("Mode               : %s\n", (gnHostCoroutine == 1) ? "co-task" : "state machine");
+	printf("Frames             : %d, %d errors\n", gnHostFrames, gnHostErrors);
+	printf("Load per tick      : %d cycles\n", gnHostLoad);
+	printf("Ticks per frame    : %.1f\n", (double) gunHostTicks/gnHostFrames);
+	printf("Slices per frame   : %.1f\n", (double) gunHostSlices/gnHostFrames);
+	printf("Total ticks        : %u (%.3f s)\n", gunClockTick, (double) (DWT->CYCCNT - unStart)/(__FCORE_MHz*1e6));
+	if (gnHostCoroutine == 1)
+	{
+		printf("Co-task stack free : %d of %d words\n", nOSCoTaskStackFree(&gstrcTaskContext[_HOST_DENSE_TASK]), _HOST_STACK_WORDS);
+	}
+	return (gnHostErrors == 0) ? 0 : 1;
+}
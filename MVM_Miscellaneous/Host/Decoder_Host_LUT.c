@@ -0,0 +1,46 @@
+//////////////////////////////////////////////////////////////////////////////////////////////
+//
+// File				: Decoder_Host_LUT.c
+// Author(s)		: Fabian Kung
+// Last modified	: 16 Oct 2026
+// Tool-suites		: GCC C-Compiler (Linux or MinGW)
+//////////////////////////////////////////////////////////////////////////////////////////////
+// Check the RGB565 look-up table of the camera driver (__RGB565_LUT in Driver_TCM8230.c) against
+// the arithmetic pixel decoder unDecodePixel(), luminance mode 0 with saturation and hue, for all
+// 65536 raw pixel words.  Driver_TCM8230.c is compiled from the firmware folder without 
+// __RGB565_LUT, so unDecodePixel() is the arithmetic decoder.  The table is generated first with 
+// MVM_Miscellaneous/Python/MVM_Gen_RGB565_LUT.py, the same file is copied into the firmware folder
+// when __RGB565_LUT is enabled.
+// Build: python3 ../Python/MVM_Gen_RGB565_LUT.py RGB565_LUT.h
+//        gcc -O2 -I. -I../../MVM_Sample_Firmware_R0.95_CNN Decoder_Host_LUT.c Driver_Host_I2C1.c 
+//        Capture_Host_BMP.c ../../MVM_Sample_Firmware_R0.95_CNN/os_APIs.c
+//        ../../MVM_Sample_Firmware_R0.95_CNN/Driver_TCM8230_Regs.c -lm -o decoder_lut
+// Usage: ./decoder_lut
+#include <stdio.h>
+
+#include "Driver_TCM8230.c"
+#include "RGB565_LUT.h"
+
+int main(void)
+{
+	unsigned int unRaw;
+	unsigned int unLUT, unArith;
+	int nMismatch = 0;
+
+	for (unRaw = 0; unRaw < 65536; unRaw++)
+	{
+		unLUT = gunRGB565LUT[unRaw];
+		unArith = unDecodePixel(unRaw, 0, 1);
+		if (unLUT != unArith)
+		{
+			if (nMismatch < 10)
+			{
+				printf("Pixel 0x%04X: table 0x%06X, unDecodePixel() 0x%06X\n", unRaw, unLUT, unArith);
+			}
+			nMismatch++;
+		}
+	}
+	printf("Pixels checked     : 65536\n");
+	printf("Mismatch           : %d\n", nMismatch);
+	return (nMismatch == 0) ? 0 : 1;
+}
@@ -0,0 +1,114 @@
+//////////////////////////////////////////////////////////////////////////////////////////////
+//
+// File				: Decoder_Host_Pair.c
+// Author(s)		: Fabian Kung
+// Last modified	: 16 Oct 2026
+// Tool-suites		: GCC C-Compiler (Linux or MinGW)
+//////////////////////////////////////////////////////////////////////////////////////////////
+// Check the packed SIMD pixel decoder DecodePixelPair() of the camera driver against the single 
+// pixel decoder unDecodePixel(), for the 4 luminance modes with and without saturation and hue.
+// Driver_TCM8230.c is compiled from the firmware folder with __ARM_FEATURE_DSP set to 1, so that
+// __DUAL_PIXEL_SIMD stays enabled, and the DSP intrinsics __USUB8(), __SEL() and __UQSUB8() are the
+// C versions in sam.h.  Every raw pixel word is checked as pixel 0 and as pixel 1 of a pair, with 
+// a random pixel in the other half, then -n random pairs are checked.  With -a all 2^32 pairs are
+// checked (takes a few minutes).
+// Build: gcc -O2 -I. -I../../MVM_Sample_Firmware_R0.95_CNN Decoder_Host_Pair.c Driver_Host_I2C1.c 
+//        Capture_Host_BMP.c ../../MVM_Sample_Firmware_R0.95_CNN/os_APIs.c
+//        ../../MVM_Sample_Firmware_R0.95_CNN/Driver_TCM8230_Regs.c -lm -o decoder_pair
+// Usage: ./decoder_pair [-n random pairs] [-a]
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define		__ARM_FEATURE_DSP		1
+#include "Driver_TCM8230.c"
+
+#ifndef		__DUAL_PIXEL_SIMD
+#error "Decoder_Host_Pair: __DUAL_PIXEL_SIMD is not enabled in Driver_TCM8230.c"
+#endif
+
+unsigned int gunHostSeed = 1;
+long long	glnHostPairs = 0;
+long long	glnHostMismatch = 0;
+
+unsigned int unHostRandom(void)
+{
+	gunHostSeed = gunHostSeed*1103515245 + 12345;
+	return gunHostSeed >> 8;
+}
+
+// Decode one pair with all modes and compare with the single pixel decoder.  The mode and 
+// saturation/hue option are constants in each call, as in the line kernels.
+#define		_CHECK_PAIR(unPair, nMode, nHueSat)															\
+	do {																								\
+		unsigned int unPixel0, unPixel1;																\
+		unsigned int unRef0 = unDecodePixel((unPair) & 0xFFFF, (nMode), (nHueSat));						\
+		unsigned int unRef1 = unDecodePixel((unPair) >> 16, (nMode), (nHueSat));						\
+		DecodePixelPair((unPair), (nMode), (nHueSat), &unPixel0, &unPixel1);							\
+		if ((unPixel0 != unRef0) || (unPixel1 != unRef1))												\
+		{																								\
+			if (glnHostMismatch < 10)																	\
+			{																							\
+				printf("Pair 0x%08X mode %d hue/sat %d: 0x%06X 0x%06X, unDecodePixel() 0x%06X 0x%06X\n",	\
+					(unsigned int) (unPair), (nMode), (nHueSat), unPixel0, unPixel1, unRef0, unRef1);	\
+			}																							\
+			glnHostMismatch++;																			\
+		}																								\
+	} while (0)
+
+void CheckPair(uint32_t unPair)
+{
+	_CHECK_PAIR(unPair, 0, 0);
+	_CHECK_PAIR(unPair, 0, 1);
+	_CHECK_PAIR(unPair, 1, 0);
+	_CHECK_PAIR(unPair, 1, 1);
+	_CHECK_PAIR(unPair, 2, 0);
+	_CHECK_PAIR(unPair, 2, 1);
+	_CHECK_PAIR(unPair, 3, 0);
+	_CHECK_PAIR(unPair, 3, 1);
+	glnHostPairs++;
+}
+
+int main(int argc, char **argv)
+{
+	int nOpt;
+	int nAll = 0;
+	long long lnRandom = 10000000;
+	long long lnIndex;
+	uint32_t unPixel;
+	
+	while ((nOpt = getopt(argc, argv, "n:a")) != -1)
+	{
+		switch (nOpt)
+		{
+			case 'n': lnRandom = atoll(optarg); break;
+			case 'a': nAll = 1; break;
+			default:
+			fprintf(stderr, "Usage: %s [-n random pairs] [-a]\n", argv[0]);
+			return 1;
+		}
+	}
+	
+	for (unPixel = 0; unPixel < 65536; unPixel++)
+	{
+		CheckPair(unPixel | ((unHostRandom() & 0xFFFF) << 16));
+		CheckPair((unPixel << 16) | (unHostRandom() & 0xFFFF));
+	}
+	if (nAll == 1)
+	{
+		for (lnIndex = 0; lnIndex <= 0xFFFFFFFFLL; lnIndex++)
+		{
+			CheckPair((uint32_t) lnIndex);
+		}
+	}
+	else
+	{
+		for (lnIndex = 0; lnIndex < lnRandom; lnIndex++)
+		{
+			CheckPair((unHostRandom() << 8) ^ unHostRandom());
+		}
+	}
+	printf("Pairs checked      : %lld (x 8 modes)\n", glnHostPairs);
+	printf("Mismatch           : %lld\n", glnHostMismatch);
+	return (glnHostMismatch == 0) ? 0 : 1;
+}
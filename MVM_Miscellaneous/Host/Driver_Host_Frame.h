@@ -0,0 +1,118 @@
+//////////////////////////////////////////////////////////////////////////////////////////////
+//
+// File				: Driver_Host_Frame.h
+// Author(s)		: Fabian Kung
+// Last modified	: 16 Oct 2026
+// Tool-suites		: GCC C-Compiler (Linux or MinGW)
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _DRIVER_HOST_FRAME_H
+#define _DRIVER_HOST_FRAME_H
+
+// Pre-process whole frames with the line kernels of the camera driver on the computer.  Include
+// this after Driver_TCM8230.c (the kernels are static).  HostPreprocessFrame() does the start of 
+// frame work of state 9 and the line loop of state 10 of Proce_TCM8230_Driver(): the line table is
+// rebuilt if a window is changed, and the line kernel and line class are selected in the same way
+// for each line.  The raw pixels come from HostFillFrame() instead of the capture HAL.
+
+uint16_t	gun16HostFrame[_IMAGE_VRESOLUTION][_IMAGE_HRESOLUTION] __attribute__ ((aligned (32)));
+unsigned int	gunHostFrameSeed = 1;
+
+static unsigned int unHostFrameRandom(void)
+{
+	gunHostFrameSeed = gunHostFrameSeed*1103515245 + 12345;
+	return gunHostFrameSeed >> 8;
+}
+
+/// Fill gun16HostFrame[][] with raw pixel words (RGB565 before the byte swap, as stored by the DMA).
+/// nPattern 0 - random pixels, 1 - smooth grey level ramps and a bright rectangle with noise, so 
+/// that the gradients are not all saturated.
+static void HostFillFrame(int nPattern)
+{
+	int nLine, ncolindex;
+	int nLevel, nR6, nG6, nB6;
+	unsigned int unRGB;
+	int nRectx = unHostFrameRandom() % gnImageWidth;
+	int nRecty = unHostFrameRandom() % gnImageHeight;
+	int nSlopex = unHostFrameRandom() % 5;
+	int nSlopey = unHostFrameRandom() % 5;
+
+	for (nLine = 0; nLine < gnImageHeight; nLine++)
+	{
+		for (ncolindex = 0; ncolindex < gnImageWidth; ncolindex++)
+		{
+			if (nPattern == 0)
+			{
+				unRGB = unHostFrameRandom() & 0xFFFF;
+			}
+			else
+			{
+				nLevel = 8 + ((ncolindex*nSlopex + nLine*nSlopey) % 24);	// 6-bits grey level.
+				if ((ncolindex >= nRectx) && (ncolindex < nRectx + 30) && (nLine >= nRecty) && (nLine < nRecty + 20))
+				{
+					nLevel = nLevel + 28;
+				}
+				nR6 = nLevel + (unHostFrameRandom() % 5) - 2;
+				nG6 = nLevel + (unHostFrameRandom() % 5) - 2;
+				nB6 = nLevel + (unHostFrameRandom() % 5) - 2;
+				unRGB = ((nR6 >> 1) << 11) | (nG6 << 5) | (nB6 >> 1);
+			}
+			gun16HostFrame[nLine][ncolindex] = __REV16(unRGB);
+		}
+	}
+}
+
+/// Pre-process gun16HostFrame[][] into ptrFrame with the attributes unFrameAttributes, return the sum
+/// of luminance of the pre-processed lines.
+static unsigned int unHostPreprocessFrame(FRAME_BUFFER *ptrFrame, unsigned int unFrameAttributes)
+{
+	int nLineCounter;
+	int nTemp, nTemp2;
+	unsigned int unLumCumulative = 0;
+
+	gunMaskThresholdFrame = gunMaskThreshold;
+	if (gunMaskThresholdFrame == 0)
+	{
+		gunMaskThresholdFrame = gunAverageLuminance;
+	}
+	if (gnCameraWindowChanged == 1)
+	{
+		BuildLineTable();
+		gnCameraWindowChanged = 0;
+	}
+	for (nTemp = 0; nTemp < 128; nTemp++)
+	{
+		gunIHisto[nTemp] = 0;
+	}
+	for (nLineCounter = 1; nLineCounter <= gnImageHeight; nLineCounter++)
+	{
+		if (gun8LineType[nLineCounter - 1] != _LINE_SKIP)
+		{
+			nTemp2 = gnLuminanceMode;
+			if ((nTemp2 < 0) || (nTemp2 > 3))
+			{
+				nTemp2 = 3;
+			}
+			if ((nLineCounter > 2) && (unFrameAttributes & _CAMERA_ATT_GRADIENT) && (gun8LineType[nLineCounter - 2] == _LINE_WINDOW))
+			{
+				nTemp = _LINE_INTERIOR;
+			}
+			else
+			{
+				nTemp = _LINE_FIRST;
+			}
+			unLumCumulative = unLumCumulative + (*gfptrLineKernel[nTemp2][(unFrameAttributes & _CAMERA_ATT_HUESAT) ? 1 : 0][nTemp])(ptrFrame, 
+				gun16HostFrame[nLineCounter - 1], nLineCounter - 1, unFrameAttributes);
+		}
+		#if defined(__INTEGRAL_IMAGE) || defined(__INTEGRAL_MASK)
+		else if (unFrameAttributes & (_CAMERA_ATT_INTEGRAL | _CAMERA_ATT_INTEGRAL_MASK))
+		{
+			IntegralImageLine(ptrFrame, nLineCounter - 1, unFrameAttributes, 1);
+		}
+		#endif
+	}
+	ptrFrame->unAttributes = unFrameAttributes;
+	return unLumCumulative;
+}
+
+#endif
@@ -0,0 +1,18 @@
+//////////////////////////////////////////////////////////////////////////////////////////////
+//
+// File				: Driver_Host_I2C1.c
+// Author(s)		: Fabian Kung
+// Last modified	: 16 Oct 2026
+// Tool-suites		: GCC C-Compiler (Linux or MinGW)
+//////////////////////////////////////////////////////////////////////////////////////////////
+// Variables of the I2C master interface in Driver_I2C1_V100.c, for the host programs which 
+// compile Driver_TCM8230.c.  These programs only run the line pre-processing of the camera driver,
+// no I2C transaction takes place.  See Camera_Host_I2C.c for the I2C write path.
+#include "Driver_I2C1_V100.h"
+
+I2C_STATUS	gI2CStat;
+uint8_t		gbytI2CSlaveAdd;
+uint8_t		gbytI2CRegAdd;
+uint8_t		gbytI2CByteCount;
+uint8_t		gbytI2CRXbuf[__MAX_I2C_DATA_BYTE];
+uint8_t		gbytI2CTXbuf[__MAX_I2C_DATA_BYTE];
@@ -0,0 +1,191 @@
+//////////////////////////////////////////////////////////////////////////////////////////////
+//
+// File				: Gradient_Host_Orientation.c
+// Author(s)		: Fabian Kung
+// Last modified	: 16 Oct 2026
+// Tool-suites		: GCC C-Compiler (Linux or MinGW)
+//////////////////////////////////////////////////////////////////////////////////////////////
+// Check the gradient orientation and the L2 gradient magnitude of the camera driver against the
+// floating point atan2() and sqrt().  Driver_TCM8230.c is compiled from the firmware folder with 
+// __SOBEL_GRADIENT, __GRADIENT_ORIENTATION and __GRADIENT_L2.
+// 1. nGradientOrientation() for all (Gx, Gy) of the Sobel kernel, -508 to 508.  The bin must be 
+//    the bin of atan2(Gy, Gx), except when the angle is within 1 unit of 360/256 degrees of a bin
+//    boundary (the resolution of gun8AtanLUT[]), where the next bin is also accepted.
+// 2. nGradientISqrt() for 0 to 127^2, it must be the floor of the square root.
+// 3. Frames pre-processed with the line kernels (see Driver_Host_Frame.h).  The gradient and 
+//    orientation planes must follow from the Sobel kernel on the luminance plane, with the noise
+//    floor and the limit of 127 of the camera driver.
+// Build: gcc -O2 -I. -I../../MVM_Sample_Firmware_R0.95_CNN Gradient_Host_Orientation.c Driver_Host_I2C1.c 
+//        Capture_Host_BMP.c ../../MVM_Sample_Firmware_R0.95_CNN/os_APIs.c
+//        ../../MVM_Sample_Firmware_R0.95_CNN/Driver_TCM8230_Regs.c -lm -o gradient_orientation
+// Usage: ./gradient_orientation [-f frames]
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <math.h>
+
+#define		__SOBEL_GRADIENT
+#define		__GRADIENT_ORIENTATION
+#define		__GRADIENT_L2
+#include "Driver_TCM8230.c"
+#include "Driver_Host_Frame.h"
+
+#define		_HOST_GRAD_MAX			508			// Max. |Gx| or |Gy| of the Sobel kernel, 4 x 127.
+
+long		glnHostChecked = 0;
+long		glnHostBoundary = 0;
+long		glnHostMismatch = 0;
+
+void ReportMismatch(const char *strMessage, int nA, int nB, int nValue, int nRef)
+{
+	if (glnHostMismatch < 10)
+	{
+		printf("%s (%d, %d): %d, reference %d\n", strMessage, nA, nB, nValue, nRef);
+	}
+	glnHostMismatch++;
+}
+
+// Orientation bin of (nGradx, nGrady) from atan2(), returns the bin and sets *ptrnBoundary to 1 
+// if the angle is near a bin boundary, *ptrnNext is then the bin on the other side.
+int nOrientationReference(int nGradx, int nGrady, int *ptrnBoundary, int *ptrnNext)
+{
+	double dAngle;								// 256 = 360 degrees.
+	double dBin;
+	double dFrac;
+	int nBin;
+
+	if ((nGradx == 0) && (nGrady == 0))
+	{
+		*ptrnBoundary = 0;
+		*ptrnNext = 0;
+		return 0;
+	}
+	dAngle = atan2(nGrady, nGradx)*128.0/M_PI;
+	dBin = (dAngle + 128.0/_GRAD_DIR_BINS)/(256.0/_GRAD_DIR_BINS);
+	nBin = (int) floor(dBin);
+	dFrac = (dBin - nBin)*(256.0/_GRAD_DIR_BINS);		// Distance from the lower boundary in angle units.
+	*ptrnBoundary = 0;
+	*ptrnNext = nBin;
+	if (dFrac < 1.0)
+	{
+		*ptrnBoundary = 1;
+		*ptrnNext = nBin - 1;
+	}
+	else if (dFrac > (256.0/_GRAD_DIR_BINS) - 1.0)
+	{
+		*ptrnBoundary = 1;
+		*ptrnNext = nBin + 1;
+	}
+	*ptrnNext = (*ptrnNext + _GRAD_DIR_BINS) & (_GRAD_DIR_BINS - 1);
+	return (nBin + _GRAD_DIR_BINS) & (_GRAD_DIR_BINS - 1);
+}
+
+void CheckOrientation(int nGradx, int nGrady, int nBin)
+{
+	int nBoundary, nNext;
+	int nRef = nOrientationReference(nGradx, nGrady, &nBoundary, &nNext);
+
+	if ((nBin != nRef) && ((nBoundary == 0) || (nBin != nNext)))
+	{
+		ReportMismatch("Orientation", nGradx, nGrady, nBin, nRef);
+	}
+	if (nBin != nRef)
+	{
+		glnHostBoundary++;
+	}
+	glnHostChecked++;
+}
+
+void CheckFrame(FRAME_BUFFER *ptrFrame)
+{
+	int x, y;
+	int nGradx, nGrady, nGrad, nDir;
+	const uint8_t *ptrLumAbove, *ptrLum, *ptrLumBelow;
+
+	for (y = 0; y < gnImageHeight; y++)
+	{
+		for (x = 0; x < gnImageWidth; x++)
+		{
+			if ((x == 0) || (y == 0) || (x == gnImageWidth - 1) || (y == gnImageHeight - 1))
+			{
+				nGrad = 0;
+				nDir = 0;
+			}
+			else
+			{
+				ptrLumAbove = ptrFrame->un8Lum[y - 1];
+				ptrLum = ptrFrame->un8Lum[y];
+				ptrLumBelow = ptrFrame->un8Lum[y + 1];
+				nGradx = ptrLumAbove[x+1] + ptrLumBelow[x+1] - ptrLumAbove[x-1] - ptrLumBelow[x-1] + 2*(ptrLum[x+1] - ptrLum[x-1]);
+				nGrady = ptrLumBelow[x-1] + ptrLumBelow[x+1] - ptrLumAbove[x-1] - ptrLumAbove[x+1] + 2*(ptrLumBelow[x] - ptrLumAbove[x]);
+				nGrad = (int) floor(sqrt((double) (nGradx*nGradx + nGrady*nGrady)));
+				nGrad = (nGrad > 127) ? 127 : ((nGrad < 20) ? 0 : nGrad);
+				nDir = nGradientOrientation(nGradx, nGrady);
+				CheckOrientation(nGradx, nGrady, ptrFrame->un8GradDir[y][x]);
+			}
+			if (ptrFrame->un8Grad[y][x] != nGrad)
+			{
+				ReportMismatch("Frame gradient", x, y, ptrFrame->un8Grad[y][x], nGrad);
+			}
+			if (ptrFrame->un8GradDir[y][x] != nDir)
+			{
+				ReportMismatch("Frame orientation", x, y, ptrFrame->un8GradDir[y][x], nDir);
+			}
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int nOpt;
+	int nFrames = 50;
+	int nFrame;
+	int nGradx, nGrady;
+	unsigned int unSum;
+	int nRoot;
+	FRAME_BUFFER *ptrFrame = &gstrcFrameBuffer[0];
+	unsigned int unAttributes = _CAMERA_ATT_LUMINANCE | _CAMERA_ATT_GRADIENT | _CAMERA_ATT_GRAD_DIR;
+
+	while ((nOpt = getopt(argc, argv, "f:")) != -1)
+	{
+		switch (nOpt)
+		{
+			case 'f': nFrames = atoi(optarg); break;
+			default:
+			fprintf(stderr, "Usage: %s [-f frames]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	for (nGradx = -_HOST_GRAD_MAX; nGradx <= _HOST_GRAD_MAX; nGradx++)
+	{
+		for (nGrady = -_HOST_GRAD_MAX; nGrady <= _HOST_GRAD_MAX; nGrady++)
+		{
+			CheckOrientation(nGradx, nGrady, nGradientOrientation(nGradx, nGrady));
+		}
+	}
+	printf("Orientation        : %ld gradients, %ld in the next bin near a boundary\n", glnHostChecked, glnHostBoundary);
+	
+	for (unSum = 0; unSum <= 127*127; unSum++)
+	{
+		nRoot = (int) floor(sqrt((double) unSum));
+		if (nGradientISqrt(unSum) != nRoot)
+		{
+			ReportMismatch("Square root", unSum, 0, nGradientISqrt(unSum), nRoot);
+		}
+	}
+	printf("Square root        : 0 to %d\n", 127*127);
+	
+	glnHostChecked = 0;
+	glnHostBoundary = 0;
+	for (nFrame = 0; nFrame < nFrames; nFrame++)
+	{
+		HostFillFrame(nFrame & 0x1);
+		memset(ptrFrame, 0xEE, sizeof(FRAME_BUFFER));
+		unHostPreprocessFrame(ptrFrame, unAttributes);
+		CheckFrame(ptrFrame);
+	}
+	printf("Frames             : %d, %ld pixels, %ld in the next bin near a boundary\n", nFrames, glnHostChecked, glnHostBoundary);
+	printf("Mismatch           : %ld\n", glnHostMismatch);
+	return (glnHostMismatch == 0) ? 0 : 1;
+}
@@ -0,0 +1,297 @@
+//////////////////////////////////////////////////////////////////////////////////////////////
+//
+// File				: Integral_Host_Box.c
+// Author(s)		: Fabian Kung
+// Last modified	: 16 Oct 2026
+// Tool-suites		: GCC C-Compiler (Linux or MinGW)
+//////////////////////////////////////////////////////////////////////////////////////////////
+// Check the integral images of the camera driver against a box filter.  Driver_TCM8230.c is 
+// compiled from the firmware folder with __INTEGRAL_IMAGE and __INTEGRAL_MASK, frames are 
+// pre-processed with the line kernels (see Driver_Host_Frame.h).  For random rectangles, the 
+// luminance sum _FRAME_LUM_SUM() and the dark pixel count _FRAME_MASK_COUNT() (four look-ups each)
+// are compared with the sum and count over the pixels of the rectangle in the luminance plane.
+// Each frame is checked without analysis window, and then with a random window set with 
+// CameraSetWindow(), where the rectangles are within the lines of the window.
+// The 12 ROIs of ImageProcessingAlgorithm2() (IPA2) in MVM_Original_Hex_File_R0.54/User_Task_0_54.c
+// are also checked, with a window around the ROIs.  The nested loops of IPA2 state 3 (luminance
+// sum and binarization against the average luminance of the ROIs in the previous frame) and
+// state 4 (count of the dark pixels in each ROI) are compared with _FRAME_LUM_SUM() and
+// _FRAME_MASK_COUNT() over each ROI, with gunMaskThreshold set to the same average.
+// Build: gcc -O2 -I. -I../../MVM_Sample_Firmware_R0.95_CNN Integral_Host_Box.c Driver_Host_I2C1.c 
+//        Capture_Host_BMP.c ../../MVM_Sample_Firmware_R0.95_CNN/os_APIs.c
+//        ../../MVM_Sample_Firmware_R0.95_CNN/Driver_TCM8230_Regs.c -lm -o integral_box
+// Usage: ./integral_box [-f frames] [-r rectangles per frame]
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define		__INTEGRAL_IMAGE
+#define		__INTEGRAL_MASK
+#include "Driver_TCM8230.c"
+#include "Driver_Host_Frame.h"
+
+// Same as User_Task_0_54.c.
+#define     __IP2_MAX_ROIX		3		// Set the number of ROI along x axis.
+#define     __IP2_MAX_ROIY		4		// Set the number of ROI along y axis.
+#define		__IP2_ROI00_XSTART	53		// Start position for ROI (upper left corner
+#define		__IP2_ROI00_YSTART	79		// coordinate) in pixels.
+#define     __IP2_ROI01_XSTART  45
+#define		__IP2_ROI01_YSTART  88
+#define		__IP2_ROI02_XSTART  39
+#define		__IP2_ROI02_YSTART  97
+#define		__IP2_ROI03_XSTART  32
+#define		__IP2_ROI03_YSTART  106
+#define		__IP2_ROI00_WIDTH	18
+#define		__IP2_ROI01_WIDTH	23		// The width of a single ROI region in pixels.
+#define		__IP2_ROI02_WIDTH	27
+#define		__IP2_ROI03_WIDTH	32
+#define		__IP2_ROI_HEIGHT	9		// The height of a single ROI region in pixels.
+
+typedef struct StructSquareROI
+{
+	int nStartX;				// Start pixel coordinate (top left hand corner).
+	int nStartY;				//
+	unsigned int unWidth;		// Width and height of ROI.
+	unsigned int unHeigth;
+	
+} SQUAREROI;
+
+TASK_ATTRIBUTE	gstrcHostTask;
+long		glnHostChecked = 0;
+long		glnHostMismatch = 0;
+long		glnHostROIChecked = 0;
+long		glnHostROIMismatch = 0;
+SQUAREROI	gobjHostROI[__IP2_MAX_ROIX][__IP2_MAX_ROIY];
+unsigned int	gunHostAverageLumROI;			// unAverageLumROI of IPA2.
+unsigned int	gunHostROILum[_IMAGE_VRESOLUTION][_IMAGE_HRESOLUTION];	// Binarized luminance of IPA2 state 3.
+
+// Same as IPA2 state 0, the ROIs of each row are side by side, the rows form a trapezoid.
+void InitIPA2ROI(void)
+{
+	int ni, nj;
+	const int nStartX[__IP2_MAX_ROIY] = {__IP2_ROI00_XSTART, __IP2_ROI01_XSTART, __IP2_ROI02_XSTART, __IP2_ROI03_XSTART};
+	const int nStartY[__IP2_MAX_ROIY] = {__IP2_ROI00_YSTART, __IP2_ROI01_YSTART, __IP2_ROI02_YSTART, __IP2_ROI03_YSTART};
+	const int nWidth[__IP2_MAX_ROIY] = {__IP2_ROI00_WIDTH, __IP2_ROI01_WIDTH, __IP2_ROI02_WIDTH, __IP2_ROI03_WIDTH};
+
+	for (nj = 0; nj < __IP2_MAX_ROIY; nj++)
+	{
+		for (ni = 0; ni < __IP2_MAX_ROIX; ni++)
+		{
+			gobjHostROI[ni][nj].nStartX = nStartX[nj] + (ni*nWidth[nj]);
+			gobjHostROI[ni][nj].nStartY = nStartY[nj];
+			gobjHostROI[ni][nj].unWidth = nWidth[nj];
+			gobjHostROI[ni][nj].unHeigth = __IP2_ROI_HEIGHT;
+		}
+	}
+}
+
+// Run the nested loops of IPA2 states 3 and 4 on the luminance plane, and compare the luminance 
+// sum and the dark pixel count of each ROI with the integral images.  The mask integral image
+// of the frame must be built with gunMaskThreshold = gunHostAverageLumROI.  Update 
+// gunHostAverageLumROI for the next frame, as IPA2 state 3.
+void CheckIPA2(FRAME_BUFFER *ptrFrame)
+{
+	int ni, nj;
+	int nXindex, nYindex;
+	int nColEnd, nColStart;
+	int nRowEnd, nRowStart;
+	int nLuminance;
+	int nLumReference = 127;
+	int nPixelCount = 0;
+	unsigned int unLumCumulativeROI = 0;
+	unsigned int unLumROI;
+	unsigned int unLumSum = 0;
+	int nROIThreshold[__IP2_MAX_ROIX][__IP2_MAX_ROIY];
+
+	for (nj = 0; nj < __IP2_MAX_ROIY; nj++)		// State 3 - Reduce the grayscale in the ROI to 2.
+	{
+		for (ni = 0; ni < __IP2_MAX_ROIX; ni++)
+		{
+			nRowStart = gobjHostROI[ni][nj].nStartY;
+			nColStart = gobjHostROI[ni][nj].nStartX;
+			nRowEnd = nRowStart + gobjHostROI[ni][nj].unHeigth;
+			nColEnd = nColStart + gobjHostROI[ni][nj].unWidth;
+			unLumROI = unLumCumulativeROI;
+			for (nYindex = nRowStart; nYindex < nRowEnd; nYindex++)
+			{
+				for (nXindex = nColStart; nXindex < nColEnd; nXindex++)
+				{
+					nLuminance = ptrFrame->un8Lum[nYindex][nXindex];
+					if (nLuminance >= (int) gunHostAverageLumROI)	// If current pixel is white.
+					{
+						gunHostROILum[nYindex][nXindex] = nLumReference;
+					}
+					else											// If current pixel is black.
+					{
+						gunHostROILum[nYindex][nXindex] = 0;
+					}
+					unLumCumulativeROI = unLumCumulativeROI + nLuminance;
+					nPixelCount++;
+				}
+			}
+			unLumROI = unLumCumulativeROI - unLumROI;
+			if (_FRAME_LUM_SUM(ptrFrame, nColStart, nRowStart, nColEnd - nColStart, nRowEnd - nRowStart) != unLumROI)
+			{
+				if (glnHostROIMismatch < 10)
+				{
+					printf("IPA2 ROI [%d][%d]: luminance sum %u, loops %u\n", ni, nj, 
+						_FRAME_LUM_SUM(ptrFrame, nColStart, nRowStart, nColEnd - nColStart, nRowEnd - nRowStart), unLumROI);
+				}
+				glnHostROIMismatch++;
+			}
+			unLumSum = unLumSum + _FRAME_LUM_SUM(ptrFrame, nColStart, nRowStart, nColEnd - nColStart, nRowEnd - nRowStart);
+		}
+	}
+
+	for (nj = 0; nj < __IP2_MAX_ROIY; nj++)		// State 4 - Count the 'dark spots' in each ROI.
+	{
+		for (ni = 0; ni < __IP2_MAX_ROIX; ni++)
+		{
+			nRowStart = gobjHostROI[ni][nj].nStartY;
+			nColStart = gobjHostROI[ni][nj].nStartX;
+			nRowEnd = nRowStart + gobjHostROI[ni][nj].unHeigth;
+			nColEnd = nColStart + gobjHostROI[ni][nj].unWidth;
+			nROIThreshold[ni][nj] = 0;
+			for (nYindex = nRowStart; nYindex < nRowEnd; nYindex++)
+			{
+				for (nXindex = nColStart; nXindex < nColEnd; nXindex++)
+				{
+					if ((int) gunHostROILum[nYindex][nXindex] < nLumReference)
+					{
+						nROIThreshold[ni][nj]++;
+					}
+				}
+			}
+			if (_FRAME_MASK_COUNT(ptrFrame, nColStart, nRowStart, nColEnd - nColStart, nRowEnd - nRowStart) != 
+				(unsigned int) nROIThreshold[ni][nj])
+			{
+				if (glnHostROIMismatch < 10)
+				{
+					printf("IPA2 ROI [%d][%d]: dark pixels %u, loops %d\n", ni, nj, 
+						_FRAME_MASK_COUNT(ptrFrame, nColStart, nRowStart, nColEnd - nColStart, nRowEnd - nRowStart), 
+						nROIThreshold[ni][nj]);
+				}
+				glnHostROIMismatch++;
+			}
+			glnHostROIChecked++;
+		}
+	}
+	if (unLumSum != unLumCumulativeROI)			// Sum of the 12 ROIs.
+	{
+		glnHostROIMismatch++;
+	}
+	gunHostAverageLumROI = unLumCumulativeROI/nPixelCount;
+}
+
+// Compare the integral image look-ups with the box filter for nRect random rectangles within 
+// rows nStarty to nStopy-1.
+void CheckRectangles(FRAME_BUFFER *ptrFrame, int nStarty, int nStopy, int nRect)
+{
+	int ni, x, y;
+	int nx, ny, nw, nh;
+	unsigned int unSum, unCount;
+	unsigned int unLumSum, unMaskCount;
+
+	for (ni = 0; ni < nRect; ni++)
+	{
+		nx = unHostFrameRandom() % gnImageWidth;
+		ny = nStarty + (unHostFrameRandom() % (nStopy - nStarty));
+		nw = 1 + (unHostFrameRandom() % (gnImageWidth - nx));
+		nh = 1 + (unHostFrameRandom() % (nStopy - ny));
+		unSum = 0;
+		unCount = 0;
+		for (y = ny; y < ny + nh; y++)
+		{
+			for (x = nx; x < nx + nw; x++)
+			{
+				unSum = unSum + ptrFrame->un8Lum[y][x];
+				if (ptrFrame->un8Lum[y][x] < gunMaskThresholdFrame)
+				{
+					unCount++;
+				}
+			}
+		}
+		unLumSum = _FRAME_LUM_SUM(ptrFrame, nx, ny, nw, nh);
+		unMaskCount = _FRAME_MASK_COUNT(ptrFrame, nx, ny, nw, nh);
+		if ((unLumSum != unSum) || (unMaskCount != unCount))
+		{
+			if (glnHostMismatch < 10)
+			{
+				printf("Rectangle (%d, %d) %dx%d: sum %u count %u, box filter %u %u\n", nx, ny, nw, nh, 
+					unLumSum, unMaskCount, unSum, unCount);
+			}
+			glnHostMismatch++;
+		}
+		glnHostChecked++;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int nOpt;
+	int nFrames = 100;
+	int nRect = 1000;
+	int nFrame;
+	int nStartx, nStarty, nWidth, nHeight;
+	FRAME_BUFFER *ptrFrame = &gstrcFrameBuffer[0];
+	unsigned int unAttributes = _CAMERA_ATT_LUMINANCE | _CAMERA_ATT_INTEGRAL | _CAMERA_ATT_INTEGRAL_MASK;
+	unsigned int unLumSum;
+
+	while ((nOpt = getopt(argc, argv, "f:r:")) != -1)
+	{
+		switch (nOpt)
+		{
+			case 'f': nFrames = atoi(optarg); break;
+			case 'r': nRect = atoi(optarg); break;
+			default:
+			fprintf(stderr, "Usage: %s [-f frames] [-r rectangles per frame]\n", argv[0]);
+			return 1;
+		}
+	}
+	gstrcHostTask.nID = 1;
+	InitIPA2ROI();
+	gunHostAverageLumROI = 64;
+
+	for (nFrame = 0; nFrame < nFrames; nFrame++)
+	{
+		HostFillFrame(nFrame & 0x1);
+		
+		// Whole frame, the mask threshold is the average luminance of the previous frame.
+		CameraSetWindow(&gstrcHostTask, 0, 0, 0, 0);
+		memset(ptrFrame, 0xEE, sizeof(FRAME_BUFFER));
+		memset(ptrFrame->unLumIntegral[0], 0, sizeof(ptrFrame->unLumIntegral[0]));		// Row 0 is 0, see 
+		memset(ptrFrame->un16MaskIntegral[0], 0, sizeof(ptrFrame->un16MaskIntegral[0]));	// IntegralImageLine().
+		unLumSum = unHostPreprocessFrame(ptrFrame, unAttributes);
+		CheckRectangles(ptrFrame, 0, gnImageHeight, nRect);
+		gunAverageLuminance = unLumSum/(gnImageWidth*gnImageHeight);
+		
+		// Analysis window, the skipped lines are taken as 0.
+		nStartx = unHostFrameRandom() % gnImageWidth;
+		nStarty = unHostFrameRandom() % gnImageHeight;
+		nWidth = 1 + (unHostFrameRandom() % (gnImageWidth - nStartx));
+		nHeight = 1 + (unHostFrameRandom() % (gnImageHeight - nStarty));
+		CameraSetWindow(&gstrcHostTask, nStartx, nStarty, nWidth, nHeight);
+		memset(ptrFrame, 0xEE, sizeof(FRAME_BUFFER));
+		memset(ptrFrame->unLumIntegral[0], 0, sizeof(ptrFrame->unLumIntegral[0]));
+		memset(ptrFrame->un16MaskIntegral[0], 0, sizeof(ptrFrame->un16MaskIntegral[0]));
+		unHostPreprocessFrame(ptrFrame, unAttributes);
+		CheckRectangles(ptrFrame, nStarty, nStarty + nHeight, nRect);
+		
+		// IPA2, window around the 12 ROIs, the mask threshold is the average of the ROIs.
+		CameraSetWindow(&gstrcHostTask, __IP2_ROI03_XSTART, __IP2_ROI00_YSTART, 3*__IP2_ROI03_WIDTH, 
+			__IP2_ROI03_YSTART + __IP2_ROI_HEIGHT - __IP2_ROI00_YSTART);
+		memset(ptrFrame, 0xEE, sizeof(FRAME_BUFFER));
+		memset(ptrFrame->unLumIntegral[0], 0, sizeof(ptrFrame->unLumIntegral[0]));
+		memset(ptrFrame->un16MaskIntegral[0], 0, sizeof(ptrFrame->un16MaskIntegral[0]));
+		gunMaskThreshold = gunHostAverageLumROI;
+		unHostPreprocessFrame(ptrFrame, unAttributes);
+		gunMaskThreshold = 0;
+		CheckIPA2(ptrFrame);
+	}
+	printf("Frames             : %d\n", nFrames);
+	printf("Rectangles checked : %ld\n", glnHostChecked);
+	printf("Mismatch           : %ld\n", glnHostMismatch);
+	printf("IPA2 ROIs checked  : %ld\n", glnHostROIChecked);
+	printf("IPA2 ROI mismatch  : %ld\n", glnHostROIMismatch);
+	return ((glnHostMismatch == 0) && (glnHostROIMismatch == 0)) ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+//////////////////////////////////////////////////////////////////////////////////////////////
+//
+// File				: Kernel_Host_Cycles.c
+// Author(s)		: Fabian Kung
+// Last modified	: 16 Oct 2026
+// Tool-suites		: GCC C-Compiler (Linux or MinGW)
+//////////////////////////////////////////////////////////////////////////////////////////////
+// Measure the processor cycles per line of each specialised line kernel in gfptrLineKernel[][]
+// of the camera driver.  Driver_TCM8230.c is compiled from the firmware folder with the hue and
+// saturation planes.  Each kernel pre-processes frames of random pixels, and the same frames are 
+// pre-processed by unPreprocessLine() with the luminance mode, saturation/hue option and line class
+// passed in as variables, e.g. the single loop with the checks in every pixel before the kernels
+// were specialised.  The planes and the sum of luminance must be the same.  The cycles are host 
+// time x 300 MHz (DWT->CYCCNT of sam.h), so only the ratio of the two loops is meaningful.
+// Build: gcc -O2 -I. -I../../MVM_Sample_Firmware_R0.95_CNN Kernel_Host_Cycles.c Driver_Host_I2C1.c 
+//        Capture_Host_BMP.c ../../MVM_Sample_Firmware_R0.95_CNN/os_APIs.c
+//        ../../MVM_Sample_Firmware_R0.95_CNN/Driver_TCM8230_Regs.c -lm -o kernel_cycles
+// Usage: ./kernel_cycles [-f frames]
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define		__FRAME_HUE_PLANE
+#define		__FRAME_SAT_PLANE
+#include "Driver_TCM8230.c"
+
+uint16_t	gun16HostPixel[_IMAGE_VRESOLUTION][_IMAGE_HRESOLUTION] __attribute__ ((aligned (32)));
+const char	*gstrHostKernelName[4] = {"RGB", "R", "G", "B"};
+
+// Line loop before the kernels were specialised, the arguments are not constants.
+__attribute__((noinline, noclone)) unsigned int unHostGenericLine(FRAME_BUFFER *ptrFrame, const uint16_t *ptrPixel, int nLine, 
+	unsigned int unAttributes, int nMode, int nHueSat, int nLineClass)
+{
+	return unPreprocessLine(ptrFrame, ptrPixel, nLine, unAttributes, nMode, nHueSat, nLineClass);
+}
+
+// Pre-process nFrames frames into ptrFrame, return the processor cycles per line.  The sum of 
+// luminance of the last frame is returned in *ptrunLumSum.
+double dHostRunKernel(int nGeneric, FRAME_BUFFER *ptrFrame, int nMode, int nHueSat, int nLineClass, int nFrames, 
+	unsigned int *ptrunLumSum)
+{
+	int nFrame;
+	int nLine;
+	unsigned int unAttributes = _CAMERA_ATT_LUMINANCE | (nHueSat ? _CAMERA_ATT_HUESAT : 0);
+	unsigned int unLumSum = 0;
+	uint32_t unStart, unCycles;
+	
+	unStart = DWT->CYCCNT;
+	for (nFrame = 0; nFrame < nFrames; nFrame++)
+	{
+		unLumSum = 0;
+		for (nLine = 0; nLine < gnImageHeight; nLine++)
+		{
+			if (nGeneric == 1)
+			{
+				unLumSum += unHostGenericLine(ptrFrame, gun16HostPixel[nLine], nLine, unAttributes, nMode, nHueSat, nLineClass);
+			}
+			else
+			{
+				unLumSum += (*gfptrLineKernel[nMode][nHueSat][nLineClass])(ptrFrame, gun16HostPixel[nLine], nLine, unAttributes);
+			}
+		}
+	}
+	unCycles = DWT->CYCCNT - unStart;
+	*ptrunLumSum = unLumSum;
+	return (double) unCycles/((double) nFrames*gnImageHeight);
+}
+
+int main(int argc, char **argv)
+{
+	int nOpt;
+	int nFrames = 200;
+	int nMode, nHueSat, nLineClass;
+	int nLine, ncolindex;
+	int nError = 0;
+	unsigned int unLumKernel, unLumGeneric;
+	double dKernel, dGeneric;
+	char strName[40];
+	FRAME_BUFFER *ptrKernel = &gstrcFrameBuffer[0];
+	FRAME_BUFFER *ptrGeneric = &gstrcFrameBuffer[1];
+	
+	while ((nOpt = getopt(argc, argv, "f:")) != -1)
+	{
+		switch (nOpt)
+		{
+			case 'f': nFrames = atoi(optarg); break;
+			default:
+			fprintf(stderr, "Usage: %s [-f frames]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (nFrames < 1)
+	{
+		nFrames = 1;
+	}
+	srand(1);
+	for (nLine = 0; nLine < _IMAGE_VRESOLUTION; nLine++)
+	{
+		for (ncolindex = 0; ncolindex < _IMAGE_HRESOLUTION; ncolindex++)
+		{
+			gun16HostPixel[nLine][ncolindex] = rand() & 0xFFFF;
+		}
+	}
+	BuildLineTable();								// No window, the whole frame.
+	
+	printf("Kernel                         Cycles/line  Generic  Planes\n");
+	for (nMode = 0; nMode < 4; nMode++)
+	{
+		for (nHueSat = 0; nHueSat < 2; nHueSat++)
+		{
+			for (nLineClass = _LINE_FIRST; nLineClass <= _LINE_INTERIOR; nLineClass++)
+			{
+				memset(ptrKernel, 0, sizeof(FRAME_BUFFER));
+				memset(ptrGeneric, 0, sizeof(FRAME_BUFFER));
+				dKernel = dHostRunKernel(0, ptrKernel, nMode, nHueSat, nLineClass, nFrames, &unLumKernel);
+				dGeneric = dHostRunKernel(1, ptrGeneric, nMode, nHueSat, nLineClass, nFrames, &unLumGeneric);
+				snprintf(strName, sizeof(strName), "unLineKernel_%s%s_%s", gstrHostKernelName[nMode], nHueSat ? "_HS" : "", 
+					(nLineClass == _LINE_FIRST) ? "First" : "Interior");
+				printf("%-30s %8.0f  %8.0f   %s\n", strName, dKernel, dGeneric, 
+					((unLumKernel == unLumGeneric) && (memcmp(ptrKernel, ptrGeneric, sizeof(FRAME_BUFFER)) == 0)) ? "same" : "DIFFERENT");
+				if ((unLumKernel != unLumGeneric) || (memcmp(ptrKernel, ptrGeneric, sizeof(FRAME_BUFFER)) != 0))
+				{
+					nError++;
+				}
+			}
+		}
+	}
+	return (nError == 0) ? 0 : 1;
+}
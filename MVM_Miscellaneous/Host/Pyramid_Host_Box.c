@@ -0,0 +1,169 @@
+//////////////////////////////////////////////////////////////////////////////////////////////
+//
+// File				: Pyramid_Host_Box.c
+// Author(s)		: Fabian Kung
+// Last modified	: 16 Oct 2026
+// Tool-suites		: GCC C-Compiler (Linux or MinGW)
+//////////////////////////////////////////////////////////////////////////////////////////////
+// Check the luminance pyramid of the camera driver against a box filter.  Driver_TCM8230.c is 
+// compiled from the firmware folder with __LUM_PYRAMID, frames are pre-processed with the line
+// kernels (see Driver_Host_Frame.h).  Level 1 and level 2 must be the rounded 2x2 and 4x4 box 
+// filter averages of the luminance plane, (sum + 2)/4 and (sum + 8)/16.
+// Each frame is checked without analysis window, and then with 1 to 3 random windows set with
+// CameraSetWindow(), where the pyramid rows made up of pre-processed lines are checked.  These
+// include all the pyramid rows covering the windows.
+// Build: gcc -O2 -I. -I../../MVM_Sample_Firmware_R0.95_CNN Pyramid_Host_Box.c Driver_Host_I2C1.c 
+//        Capture_Host_BMP.c ../../MVM_Sample_Firmware_R0.95_CNN/os_APIs.c
+//        ../../MVM_Sample_Firmware_R0.95_CNN/Driver_TCM8230_Regs.c -lm -o pyramid_box
+// Usage: ./pyramid_box [-f frames]
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define		__LUM_PYRAMID
+#include "Driver_TCM8230.c"
+#include "Driver_Host_Frame.h"
+
+TASK_ATTRIBUTE	gstrcHostTask[3];
+long		glnHostChecked = 0;
+long		glnHostMismatch = 0;
+
+// Rounded nSize x nSize box filter average of the luminance plane, top left corner at column x 
+// and row y.
+int nBoxAverage(FRAME_BUFFER *ptrFrame, int x, int y, int nSize)
+{
+	int ni, nj;
+	int nSum = 0;
+
+	for (ni = 0; ni < nSize; ni++)
+	{
+		for (nj = 0; nj < nSize; nj++)
+		{
+			nSum = nSum + ptrFrame->un8Lum[y + ni][x + nj];
+		}
+	}
+	return (nSum + (nSize*nSize)/2)/(nSize*nSize);
+}
+
+// Compare the pyramid row nRow of level nLevel (1 or 2) with the box filter.
+void CheckPyramidRow(FRAME_BUFFER *ptrFrame, int nLevel, int nRow)
+{
+	int x;
+	int nSize = (nLevel == 1) ? 2 : 4;
+	int nPyramid, nRef;
+
+	for (x = 0; x < gnImageWidth/nSize; x++)
+	{
+		nPyramid = (nLevel == 1) ? _FRAME_LUM1(ptrFrame, x, nRow) : _FRAME_LUM2(ptrFrame, x, nRow);
+		nRef = nBoxAverage(ptrFrame, x*nSize, nRow*nSize, nSize);
+		if (nPyramid != nRef)
+		{
+			if (glnHostMismatch < 10)
+			{
+				printf("Level %d (%d, %d): %d, box filter %d\n", nLevel, x, nRow, nPyramid, nRef);
+			}
+			glnHostMismatch++;
+		}
+		glnHostChecked++;
+	}
+}
+
+// Check the pyramid rows whose lines are all pre-processed.
+void CheckPyramid(FRAME_BUFFER *ptrFrame)
+{
+	int nRow;
+	int nLine;
+	int nValid;
+	int nLevel;
+	int nSize;
+
+	for (nLevel = 1; nLevel <= 2; nLevel++)
+	{
+		nSize = (nLevel == 1) ? 2 : 4;
+		for (nRow = 0; nRow < gnImageHeight/nSize; nRow++)
+		{
+			nValid = 1;
+			for (nLine = nRow*nSize; nLine < (nRow + 1)*nSize; nLine++)
+			{
+				if (gun8LineType[nLine] == _LINE_SKIP)
+				{
+					nValid = 0;
+				}
+			}
+			if (nValid == 1)
+			{
+				CheckPyramidRow(ptrFrame, nLevel, nRow);
+			}
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int nOpt;
+	int nFrames = 100;
+	int nFrame;
+	int nWindows, ni;
+	int nLine;
+	int nStartx, nStarty, nWidth, nHeight;
+	FRAME_BUFFER *ptrFrame = &gstrcFrameBuffer[0];
+	unsigned int unAttributes = _CAMERA_ATT_LUMINANCE | _CAMERA_ATT_PYRAMID;
+
+	while ((nOpt = getopt(argc, argv, "f:")) != -1)
+	{
+		switch (nOpt)
+		{
+			case 'f': nFrames = atoi(optarg); break;
+			default:
+			fprintf(stderr, "Usage: %s [-f frames]\n", argv[0]);
+			return 1;
+		}
+	}
+	for (ni = 0; ni < 3; ni++)
+	{
+		gstrcHostTask[ni].nID = ni + 1;
+	}
+
+	for (nFrame = 0; nFrame < nFrames; nFrame++)
+	{
+		HostFillFrame(nFrame & 0x1);
+		
+		// Whole frame.
+		for (ni = 0; ni < 3; ni++)
+		{
+			CameraSetWindow(&gstrcHostTask[ni], 0, 0, 0, 0);
+		}
+		memset(ptrFrame, 0xEE, sizeof(FRAME_BUFFER));
+		unHostPreprocessFrame(ptrFrame, unAttributes);
+		CheckPyramid(ptrFrame);
+		
+		// Analysis windows, the border lines are extended to multiples of 4 lines by BuildLineTable().
+		nWindows = 1 + (unHostFrameRandom() % 3);
+		for (ni = 0; ni < nWindows; ni++)
+		{
+			nStartx = unHostFrameRandom() % gnImageWidth;
+			nStarty = unHostFrameRandom() % gnImageHeight;
+			nWidth = 1 + (unHostFrameRandom() % (gnImageWidth - nStartx));
+			nHeight = 1 + (unHostFrameRandom() % (gnImageHeight - nStarty));
+			CameraSetWindow(&gstrcHostTask[ni], nStartx, nStarty, nWidth, nHeight);
+		}
+		memset(ptrFrame, 0xEE, sizeof(FRAME_BUFFER));
+		unHostPreprocessFrame(ptrFrame, unAttributes);
+		for (ni = 0; ni < nWindows; ni++)		// The level 2 rows covering the window must be checked.
+		{
+			for (nLine = gstrcCameraWindow[ni + 1].nStarty & ~0x3; nLine < ((gstrcCameraWindow[ni + 1].nStopy + 3) & ~0x3); nLine++)
+			{
+				if (gun8LineType[nLine] == _LINE_SKIP)
+				{
+					printf("Line %d of a pyramid row covering window %d is not pre-processed\n", nLine, ni + 1);
+					glnHostMismatch++;
+				}
+			}
+		}
+		CheckPyramid(ptrFrame);
+	}
+	printf("Frames             : %d\n", nFrames);
+	printf("Pixels checked     : %ld (level 1 and 2)\n", glnHostChecked);
+	printf("Mismatch           : %ld\n", glnHostMismatch);
+	return (glnHostMismatch == 0) ? 0 : 1;
+}
@@ -0,0 +1,327 @@
+//////////////////////////////////////////////////////////////////////////////////////////////
+//
+// File				: Scheduler_Host_Event.c
+// Author(s)		: Fabian Kung
+// Last modified	: 16 Oct 2026
+// Tool-suites		: GCC C-Compiler (Linux or MinGW)
+//////////////////////////////////////////////////////////////////////////////////////////////
+// Compare the task dispatches and idle processor cycles per frame of the scheduler loop in
+// main.c, with the tasks polling for frames and UART flags every system tick, and with the
+// tasks blocked by OSWaitEvent() until the drivers call OSSignalEvent().  os_APIs.c is compiled
+// from the firmware folder (sam.h and sams70j20.h in this folder replace the device headers), and
+// the scheduler loop is the same as main.c.  The tasks are reduced to the states which wait for
+// something:
+// Stream image - Wait for a command from the remote host on UART2 (state 1), send one line and
+//                wait for the DMA transmission to end (state 4).
+// Image4       - Wait for a new frame (state 1), run the CNN for a number of system ticks, send
+//                the result on USART0 and wait for the transmission to end (state 6).
+// The drivers run every system tick in both cases.  The remote host sends the next command a
+// short time after a line is received when streaming (-s), else it is silent.
+// Build: gcc -O2 -I. -I../../MVM_Sample_Firmware_R0.95_CNN Scheduler_Host_Event.c
+//        ../../MVM_Sample_Firmware_R0.95_CNN/os_APIs.c -o scheduler_event
+// Usage: ./scheduler_event [-s] [-r fps] [-w CNN ticks] [-n frames]
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "osmain.h"
+
+#define		_HOST_FRAME_RATE		20.83			// Same as Capture_Host_BMP.h.
+#define		_HOST_TASKS				8
+
+// Processor cycles of the model, estimated from the 'U' command of the firmware.
+#define		_DISPATCH_CYCLES		60				// Call through function pointer, switch and OSSetTaskContext().
+#define		_TIMER_CYCLES			20				// OSUpdateTaskTimer() and the scan of the ready map per system tick.
+#define		_DRIVER_CYCLES			150				// UART2, I2C1, camera LED and USART0 drivers.
+#define		_CAMERA_CYCLES			4000			// Camera driver, line pre-processing.
+#define		_RLE_CYCLES				30000			// Stream image, RLE of 1 line.
+#define		_CNN_CYCLES				45000			// Image4, 1 system tick of CNN.
+#define		_LINE_BYTES				120				// Stream image, bytes per line after RLE.
+#define		_UART_KBPS				115.2			// Same as _UART_BAUDRATE_kBPS in Driver_UART2_V100.c.
+#define		_HOST_TURNAROUND_US		2000.0			// Remote host, from the end of a line to the next command.
+
+unsigned int	gunDispatch[__MAXTASK];			// Dispatches of each task.
+unsigned long long	gulnBusy;					// Processor cycles used by the tasks and the scheduler.
+
+// Simulated hardware and remote host.
+int			gnEventMode = 0;					// 1 = OSWaitEvent(), 0 = poll every system tick.
+int			gnStream = 0;						// 1 = remote host is streaming.
+int			gnCNNTicks = 60;
+double		gdTime = 0.0;						// Simulated time in usec.
+double		gdFrame;							// Frame period in usec.
+double		gdNextFrame;
+double		gdUARTTXEnd = -1.0;					// Time when the DMA transmission of UART2 ends, -1 if idle.
+double		gdUARTRX = -1.0;					// Time when the next command arrives on UART2, -1 if none.
+double		gdUSARTTXEnd = -1.0;				// Time when the transmission of USART0 ends, -1 if idle.
+int			gnFrameCounter = 0;
+int			gnUARTTXRDY = 0;					// Same as gSCIstatus.bTXRDY.
+int			gnUARTRXRDY = 0;					// Same as gSCIstatus.bRXRDY.
+int			gnUSARTTXRDY = 0;					// Same as gSCIstatus2.bTXRDY.
+
+/// Wait for an event, or poll again in the next system tick.
+static void TaskWait(TASK_ATTRIBUTE *ptrTask, unsigned int unEventMask)
+{
+	if (gnEventMode == 1)
+	{
+		OSWaitEvent(ptrTask, unEventMask, 0);
+	}
+	else
+	{
+		OSSetTaskContext(ptrTask, ptrTask->nState, 1);
+	}
+}
+
+// --- Tasks ---
+static void Proce1(TASK_ATTRIBUTE *ptrTask)
+{
+	OSSetTaskContext(ptrTask, 0, 3000);			// Blink LED1 every 500 msec.
+}
+
+static void Driver(TASK_ATTRIBUTE *ptrTask)
+{
+	gulnBusy = gulnBusy + _DRIVER_CYCLES;
+	OSSetTaskContext(ptrTask, 0, 1);
+}
+
+static void UART2Driver(TASK_ATTRIBUTE *ptrTask)
+{
+	gulnBusy = gulnBusy + _DRIVER_CYCLES;
+	if ((gnUARTTXRDY == 1) && (gdTime >= gdUARTTXEnd))
+	{
+		gnUARTTXRDY = 0;
+		OSSignalEvent(__EVENT_UART_TXDONE);
+		if (gnStream == 1)
+		{
+			gdUARTRX = gdUARTTXEnd + _HOST_TURNAROUND_US;	// Remote host asks for the next line.
+		}
+	}
+	if ((gdUARTRX >= 0.0) && (gdTime >= gdUARTRX))
+	{
+		gdUARTRX = -1.0;
+		gnUARTRXRDY = 1;
+		OSSignalEvent(__EVENT_UART_RXRDY);
+	}
+	OSSetTaskContext(ptrTask, 0, 1);
+}
+
+static void USART0Driver(TASK_ATTRIBUTE *ptrTask)
+{
+	gulnBusy = gulnBusy + _DRIVER_CYCLES;
+	if ((gnUSARTTXRDY == 1) && (gdTime >= gdUSARTTXEnd))
+	{
+		gnUSARTTXRDY = 0;
+		OSSignalEvent(__EVENT_USART0_TXDONE);
+	}
+	OSSetTaskContext(ptrTask, 0, 1);
+}
+
+static void CameraDriver(TASK_ATTRIBUTE *ptrTask)
+{
+	gulnBusy = gulnBusy + _CAMERA_CYCLES;
+	if (gdTime >= gdNextFrame)
+	{
+		gdNextFrame = gdNextFrame + gdFrame;
+		gnFrameCounter++;
+		OSSignalEvent(__EVENT_FRAME_COMPLETE);
+	}
+	OSSetTaskContext(ptrTask, 0, 1);
+}
+
+static void StreamImage(TASK_ATTRIBUTE *ptrTask)
+{
+	switch (ptrTask->nState)
+	{
+		case 1: // Wait for a command.
+		if (gnUARTRXRDY == 1)
+		{
+			gnUARTRXRDY = 0;
+			OSSetTaskContext(ptrTask, 2, 1);
+		}
+		else
+		{
+			TaskWait(ptrTask, __EVENT_UART_RXRDY);
+		}
+		break;
+
+		case 2: // Send a line.
+		gulnBusy = gulnBusy + _RLE_CYCLES;
+		gnUARTTXRDY = 1;
+		gdUARTTXEnd = gdTime + (_LINE_BYTES + 3)*10*1000.0/_UART_KBPS;
+		OSSetTaskContext(ptrTask, 4, 1);
+		break;
+
+		case 4: // Wait for the transmission to end.
+		if (gnUARTTXRDY == 0)
+		{
+			OSSetTaskContext(ptrTask, 1, 1);
+		}
+		else
+		{
+			TaskWait(ptrTask, __EVENT_UART_TXDONE);
+		}
+		break;
+
+		default:
+		OSSetTaskContext(ptrTask, 1, 1);
+		break;
+	}
+}
+
+static void Image4(TASK_ATTRIBUTE *ptrTask)
+{
+	static int nCurrentFrame = 0;
+	static int nWork;
+
+	switch (ptrTask->nState)
+	{
+		case 1: // Wait for a new frame.
+		if (gnFrameCounter != nCurrentFrame)
+		{
+			nCurrentFrame = gnFrameCounter;
+			nWork = gnCNNTicks;
+			OSSetTaskContext(ptrTask, 3, 1);
+		}
+		else
+		{
+			TaskWait(ptrTask, __EVENT_FRAME_COMPLETE);
+		}
+		break;
+
+		case 3: // CNN.
+		gulnBusy = gulnBusy + _CNN_CYCLES;
+		nWork--;
+		OSSetTaskContext(ptrTask, (nWork > 0) ? 3 : 5, 1);
+		break;
+
+		case 5: // Send the result, 2 bytes.
+		case 6: // Send the last 2 bytes.
+		if (gnUSARTTXRDY == 0)
+		{
+			gnUSARTTXRDY = 1;
+			gdUSARTTXEnd = gdTime + 2*10*1000.0/_UART_KBPS;
+			OSSetTaskContext(ptrTask, (ptrTask->nState == 5) ? 6 : 1, 3);
+		}
+		else if (ptrTask->nState == 5)
+		{
+			OSSetTaskContext(ptrTask, 1, 1);
+		}
+		else
+		{
+			TaskWait(ptrTask, __EVENT_USART0_TXDONE);
+		}
+		break;
+
+		default:
+		OSSetTaskContext(ptrTask, 1, 1);
+		break;
+	}
+}
+
+/// Run the scheduler loop of main.c for a no. of frames, after 1 frame of warm up.
+static void Run(int nFrames, unsigned int *ptrunDispatch, unsigned long long *ptrulnIdle, unsigned int *ptrunTicks)
+{
+	int ni;
+	int nFrameStart;
+	unsigned int unTicks = 0;
+
+	OSInit();
+	OSCreateTask(&gstrcTaskContext[gnTaskCount], Proce1);			// Same order as main.c.
+	OSCreateTask(&gstrcTaskContext[gnTaskCount], UART2Driver);
+	OSCreateTask(&gstrcTaskContext[gnTaskCount], Driver);			// I2C1.
+	OSCreateTask(&gstrcTaskContext[gnTaskCount], Driver);			// Camera LED.
+	OSCreateTask(&gstrcTaskContext[gnTaskCount], USART0Driver);
+	OSCreateTask(&gstrcTaskContext[gnTaskCount], CameraDriver);
+	OSCreateTask(&gstrcTaskContext[gnTaskCount], StreamImage);		// Start in state 0, the default case goes to state 1.
+	OSCreateTask(&gstrcTaskContext[gnTaskCount], Image4);
+	gdTime = 0.0;
+	gdNextFrame = gdFrame;
+	gdUARTTXEnd = -1.0;
+	gdUSARTTXEnd = -1.0;
+	gdUARTRX = (gnStream == 1) ? 0.0 : -1.0;
+	gnFrameCounter = 0;
+	gnUARTTXRDY = 0;
+	gnUARTRXRDY = 0;
+	gnUSARTTXRDY = 0;
+	nFrameStart = -1;
+
+	while (gnFrameCounter < nFrames + 1)
+	{
+		if ((nFrameStart < 0) && (gnFrameCounter == 1))	// Start counting after the first frame.
+		{
+			nFrameStart = 1;
+			for (ni = 0; ni < gnTaskCount; ni++)
+			{
+				gunDispatch[ni] = 0;
+			}
+			gulnBusy = 0;
+			unTicks = 0;
+		}
+		gdTime = gdTime + __SYSTEMTICK_US;
+		unTicks++;
+		gunClockTick++;							// Same as main.c.
+		OSUpdateTaskTimer();
+		gulnBusy = gulnBusy + _TIMER_CYCLES;
+		for (ni = nOSNextReadyTask(0); ni >= 0; ni = nOSNextReadyTask(ni + 1))
+		{
+			(*((TASK_POINTER)gfptrTask[ni]))(&gstrcTaskContext[ni]);
+			gunDispatch[ni]++;
+			gulnBusy = gulnBusy + _DISPATCH_CYCLES;
+		}
+	}
+	for (ni = 0; ni < gnTaskCount; ni++)
+	{
+		ptrunDispatch[ni] = gunDispatch[ni];
+	}
+	*ptrulnIdle = (unsigned long long) unTicks*__SYSTEMTICK_CYCLES - gulnBusy;
+	*ptrunTicks = unTicks;
+}
+
+int main(int argc, char **argv)
+{
+	int nOption;
+	int ni;
+	int nFrames = 20;
+	double dFrameRate = _HOST_FRAME_RATE;
+	unsigned int unDispatch[2][_HOST_TASKS];
+	unsigned long long ulnIdle[2];
+	unsigned int unTicks[2];
+	unsigned int unTotal[2] = {0, 0};
+	const char *strName[] = {"OSProce1", "UART2", "I2C1", "Camera LED", "USART0", "TCM8230",
+							"StreamImage", "Image4"};
+
+	while ((nOption = getopt(argc, argv, "sr:w:n:")) != -1)
+	{
+		switch (nOption)
+		{
+			case 's':	gnStream = 1;	break;
+			case 'r':	dFrameRate = atof(optarg);	break;
+			case 'w':	gnCNNTicks = atoi(optarg);	break;
+			case 'n':	nFrames = atoi(optarg);	break;
+			default:
+				printf("Usage: %s [-s] [-r fps] [-w CNN ticks] [-n frames]\n", argv[0]);
+				return 1;
+		}
+	}
+	gdFrame = 1000000.0/dFrameRate;
+
+	for (gnEventMode = 0; gnEventMode < 2; gnEventMode++)
+	{
+		Run(nFrames, unDispatch[gnEventMode], &ulnIdle[gnEventMode], &unTicks[gnEventMode]);
+	}
+
+	printf("%.2f frames/sec, %d system ticks of CNN per frame, remote host %s, %d frames\n", dFrameRate,
+			gnCNNTicks, (gnStream == 1) ? "streaming" : "silent", nFrames);
+	printf("Dispatches per frame:   Poll  OSWaitEvent\n");
+	for (ni = 0; ni < gnTaskCount; ni++)
+	{
+		printf("  %-12s %12.1f %12.1f\n", strName[ni], (double) unDispatch[0][ni]/nFrames,
+				(double) unDispatch[1][ni]/nFrames);
+		unTotal[0] = unTotal[0] + unDispatch[0][ni];
+		unTotal[1] = unTotal[1] + unDispatch[1][ni];
+	}
+	printf("  %-12s %12.1f %12.1f\n", "All tasks", (double) unTotal[0]/nFrames, (double) unTotal[1]/nFrames);
+	printf("Idle cycles per frame: %12.0f %12.0f (%.2f%% / %.2f%% of the processor)\n",
+			(double) ulnIdle[0]/nFrames, (double) ulnIdle[1]/nFrames,
+			100.0*ulnIdle[0]/((double) unTicks[0]*__SYSTEMTICK_CYCLES), 100.0*ulnIdle[1]/((double) unTicks[1]*__SYSTEMTICK_CYCLES));
+	return 0;
+}
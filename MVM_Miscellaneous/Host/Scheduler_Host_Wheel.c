@@ -0,0 +1,246 @@
+//////////////////////////////////////////////////////////////////////////////////////////////
+//
+// File				: Scheduler_Host_Wheel.c
+// Author(s)		: Fabian Kung
+// Last modified	: 16 Oct 2026
+// Tool-suites		: GCC C-Compiler (Linux or MinGW)
+//////////////////////////////////////////////////////////////////////////////////////////////
+// Compare the Scheduler loop of main.c, with the timer wheel and ready list of os_APIs.c, against
+// the previous loop which decrements the timer of every task and checks every task in each
+// system tick (a copy is kept here).  os_APIs.c is compiled from the firmware folder, sam.h and
+// sams70j20.h in this folder replace the device headers.
+// The same tasks run with both schedulers.  Each task uses a pseudo-random sequence to choose
+// its next action: sleep for a no. of system ticks (up to -d, longer than the timer wheel), wait
+// for an event with or without timeout, or signal an event.  The sequence of (system tick, task)
+// dispatches must be the same.  The time per system tick is then measured with -n tasks which
+// are mostly sleeping, e.g. protocol handlers and telemetry.
+// Build: gcc -O2 -I. -I../../MVM_Sample_Firmware_R0.95_CNN Scheduler_Host_Wheel.c
+//        ../../MVM_Sample_Firmware_R0.95_CNN/os_APIs.c -o scheduler_wheel
+// Usage: ./scheduler_wheel [-n tasks] [-t ticks] [-d max. delay]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "osmain.h"
+
+#define		_HOST_EVENTS			4				// No. of events used by the tasks.
+
+int				gnHostTasks = __MAXTASK;
+int				gnHostTicks = 200000;
+int				gnHostMaxDelay = 500;
+int				gnHostWheel = 1;				// 1 - os_APIs.c, 0 - previous Scheduler.
+unsigned int	gunHostTrace;					// Hash of the (system tick, task) dispatches.
+unsigned int	gunHostDispatch;
+unsigned int	gunHostSeed[__MAXTASK];
+
+// Previous Scheduler, same as os_APIs.c and main.c before the timer wheel.
+TASK_ATTRIBUTE	gstrcOldTaskContext[__MAXTASK];
+TASK_POINTER	gfptrOldTask[__MAXTASK];
+int				gnOldTaskCount;
+
+void OldWaitEvent(TASK_ATTRIBUTE *ptrTaskData, unsigned int unEventMask, int nTimeout)
+{
+	ptrTaskData->unEventWait = unEventMask;
+	ptrTaskData->unEvent = 0;
+	ptrTaskData->nTimer = (nTimeout > 0) ? nTimeout : -1;
+}
+
+void OldSignalEvent(unsigned int unEvent)
+{
+	int ni;
+
+	for (ni = 0; ni < gnOldTaskCount; ni++)
+	{
+		if ((gstrcOldTaskContext[ni].unEventWait & unEvent) > 0)
+		{
+			gstrcOldTaskContext[ni].unEvent = gstrcOldTaskContext[ni].unEventWait & unEvent;
+			gstrcOldTaskContext[ni].unEventWait = 0;
+			gstrcOldTaskContext[ni].nTimer = 0;
+		}
+	}
+}
+
+void OldTick(void)
+{
+	int ni;
+
+	gunClockTick++;
+	for (ni = 0; ni < gnOldTaskCount; ni++)
+	{
+		if (gstrcOldTaskContext[ni].nTimer > 0)
+		{
+			--(gstrcOldTaskContext[ni].nTimer);
+		}
+	}
+	for (ni = 0; ni < gnOldTaskCount; ni++)
+	{
+		if (gstrcOldTaskContext[ni].nTimer == 0)
+		{
+			gstrcOldTaskContext[ni].unEventWait = 0;
+			(*gfptrOldTask[ni])(&gstrcOldTaskContext[ni]);
+		}
+	}
+}
+
+// Same as main.c.
+void WheelTick(void)
+{
+	int ni;
+
+	gunClockTick++;
+	OSUpdateTaskTimer();
+	for (ni = nOSNextReadyTask(0); ni >= 0; ni = nOSNextReadyTask(ni + 1))
+	{
+		(*((TASK_POINTER)gfptrTask[ni]))(&gstrcTaskContext[ni]);
+	}
+}
+
+unsigned int unHostRandom(int nTask)
+{
+	gunHostSeed[nTask] = gunHostSeed[nTask]*1103515245 + 12345;
+	return gunHostSeed[nTask] >> 8;
+}
+
+void Proce_HostTask(TASK_ATTRIBUTE *ptrTask)
+{
+	int nTask = ptrTask->nID - 1;
+	unsigned int unAction = unHostRandom(nTask) % 16;
+	unsigned int unEvent = 1 << (unHostRandom(nTask) % _HOST_EVENTS);
+	int nDelay = unHostRandom(nTask) % gnHostMaxDelay;
+
+	gunHostTrace = (gunHostTrace*31) ^ (gunClockTick*__MAXTASK + nTask);
+	gunHostDispatch++;
+	if (unAction < 2)					// Stay ready, run again in the next system tick.
+	{
+		return;
+	}
+	if (unAction < 4)					// Signal an event, then sleep.
+	{
+		if (gnHostWheel == 1)
+		{
+			OSSignalEvent(unEvent);
+		}
+		else
+		{
+			OldSignalEvent(unEvent);
+		}
+	}
+	if (unAction < 12)					// Sleep.
+	{
+		if (gnHostWheel == 1)
+		{
+			OSSetTaskContext(ptrTask, 0, nDelay + 1);
+		}
+		else
+		{
+			ptrTask->nState = 0;
+			ptrTask->nTimer = nDelay + 1;
+		}
+		return;
+	}
+	if (unAction < 14)					// Wait with timeout.
+	{
+		nDelay = nDelay + 1;
+	}
+	else								// Wait without timeout.
+	{
+		nDelay = 0;
+	}
+	if (gnHostWheel == 1)
+	{
+		OSWaitEvent(ptrTask, unEvent, nDelay);
+	}
+	else
+	{
+		OldWaitEvent(ptrTask, unEvent, nDelay);
+	}
+}
+
+// Run the tasks, return the time per system tick in nsec.
+double dHostRun(int nWheel, int nTasks, int nTicks)
+{
+	int ni;
+	struct timespec strcStart, strcStop;
+
+	gnHostWheel = nWheel;
+	gunHostTrace = 0;
+	gunHostDispatch = 0;
+	gunClockTick = 0;
+	for (ni = 0; ni < nTasks; ni++)
+	{
+		gunHostSeed[ni] = ni + 1;
+	}
+	if (nWheel == 1)
+	{
+		OSInit();
+		for (ni = 0; ni < nTasks; ni++)
+		{
+			OSCreateTask(&gstrcTaskContext[gnTaskCount], Proce_HostTask);
+		}
+	}
+	else
+	{
+		gnOldTaskCount = 0;
+		for (ni = 0; ni < nTasks; ni++)
+		{
+			memset(&gstrcOldTaskContext[ni], 0, sizeof(TASK_ATTRIBUTE));
+			gstrcOldTaskContext[ni].nTimer = 1;
+			gstrcOldTaskContext[ni].nID = ni + 1;
+			gfptrOldTask[ni] = Proce_HostTask;
+			gnOldTaskCount++;
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &strcStart);
+	for (ni = 0; ni < nTicks; ni++)
+	{
+		if (nWheel == 1)
+		{
+			WheelTick();
+		}
+		else
+		{
+			OldTick();
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &strcStop);
+	return ((strcStop.tv_sec - strcStart.tv_sec)*1e9 + (strcStop.tv_nsec - strcStart.tv_nsec))/nTicks;
+}
+
+int main(int argc, char **argv)
+{
+	int nOpt;
+	unsigned int unTrace;
+	unsigned int unDispatch;
+	double dOld, dWheel;
+
+	while ((nOpt = getopt(argc, argv, "n:t:d:")) != -1)
+	{
+		switch (nOpt)
+		{
+			case 'n': gnHostTasks = atoi(optarg); break;
+			case 't': gnHostTicks = atoi(optarg); break;
+			case 'd': gnHostMaxDelay = atoi(optarg); break;
+			default:
+			fprintf(stderr, "Usage: %s [-n tasks] [-t ticks] [-d max. delay]\n", argv[0]);
+			return 1;
+		}
+	}
+	if ((gnHostTasks < 1) || (gnHostTasks > __MAXTASK) || (gnHostMaxDelay < 1))
+	{
+		fprintf(stderr, "1 to %d tasks, max. delay at least 1.\n", __MAXTASK);
+		return 1;
+	}
+
+	dOld = dHostRun(0, gnHostTasks, gnHostTicks);
+	unTrace = gunHostTrace;
+	unDispatch = gunHostDispatch;
+	dWheel = dHostRun(1, gnHostTasks, gnHostTicks);
+
+	printf("Tasks              : %d, %d system ticks, max. delay %d ticks\n", gnHostTasks, gnHostTicks, gnHostMaxDelay);
+	printf("Dispatches         : %u previous, %u timer wheel\n", unDispatch, gunHostDispatch);
+	printf("Same sequence      : %s\n", ((unTrace == gunHostTrace) && (unDispatch == gunHostDispatch)) ? "yes" : "NO");
+	printf("Time per tick      : %.1f nsec previous, %.1f nsec timer wheel\n", dOld, dWheel);
+	return ((unTrace == gunHostTrace) && (unDispatch == gunHostDispatch)) ? 0 : 1;
+}
@@ -0,0 +1,157 @@
+//////////////////////////////////////////////////////////////////////////////////////////////
+//
+// File				: Sobel_Host_Gradient.c
+// Author(s)		: Fabian Kung
+// Last modified	: 16 Oct 2026
+// Tool-suites		: GCC C-Compiler (Linux or MinGW)
+//////////////////////////////////////////////////////////////////////////////////////////////
+// Check the Sobel gradient stage of the camera driver against the Sobel transform of 
+// MVM_Miscellaneous/Scilab/Sobel_Transform.sce.  Driver_TCM8230.c is compiled from the firmware
+// folder with __SOBEL_GRADIENT, frames are pre-processed with the line kernels (see 
+// Driver_Host_Frame.h), and the gradient plane is compared with the reference below, computed on
+// the luminance plane of the same frame.  The reference follows the loop of Sobel_Transform.sce 
+// (Lu1 to Lu8 are the same neighbours, the script flips the rows so Lu1, Lu7 and Lu2 are in the
+// row above), with two differences: the centre weights are 2 as in the Sobel kernel and the camera
+// driver (the script uses 0.5), and the magnitude is limited to 127 with the noise floor of 20 
+// as in the camera driver.  The first and last rows and columns have zero gradient.
+// Each frame is checked without analysis window, and then with 1 to 3 random windows set with
+// CameraSetWindow(), where all pixels inside the windows are checked.
+// Build: gcc -O2 -I. -I../../MVM_Sample_Firmware_R0.95_CNN Sobel_Host_Gradient.c Driver_Host_I2C1.c 
+//        Capture_Host_BMP.c ../../MVM_Sample_Firmware_R0.95_CNN/os_APIs.c
+//        ../../MVM_Sample_Firmware_R0.95_CNN/Driver_TCM8230_Regs.c -lm -o sobel_gradient
+// Usage: ./sobel_gradient [-f frames]
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define		__SOBEL_GRADIENT
+#include "Driver_TCM8230.c"
+#include "Driver_Host_Frame.h"
+
+TASK_ATTRIBUTE	gstrcHostTask[3];
+long		glnHostChecked = 0;
+long		glnHostEdge = 0;
+long		glnHostMismatch = 0;
+
+// Gradient of the interior pixel at column x and row y, Sobel_Transform.sce.
+int nSobelReference(FRAME_BUFFER *ptrFrame, int x, int y)
+{
+	int Lu1 = ptrFrame->un8Lum[y-1][x-1];
+	int Lu2 = ptrFrame->un8Lum[y-1][x+1];
+	int Lu3 = ptrFrame->un8Lum[y][x-1];
+	int Lu4 = ptrFrame->un8Lum[y][x+1];
+	int Lu5 = ptrFrame->un8Lum[y+1][x-1];
+	int Lu6 = ptrFrame->un8Lum[y+1][x+1];
+	int Lu7 = ptrFrame->un8Lum[y-1][x];
+	int Lu8 = ptrFrame->un8Lum[y+1][x];
+	int DIx = Lu2 + Lu6 - Lu1 - Lu5 + 2*(Lu4 - Lu3);
+	int DIy = Lu5 + Lu6 - Lu1 - Lu2 + 2*(Lu8 - Lu7);
+	int nGrad = abs(DIx) + abs(DIy);
+
+	if (nGrad > 127)
+	{
+		nGrad = 127;
+	}
+	if (nGrad < 20)
+	{
+		nGrad = 0;
+	}
+	return nGrad;
+}
+
+// Compare the gradient plane with the reference for columns nStartx to nStopx-1 and rows nStarty
+// to nStopy-1.
+void CheckRegion(FRAME_BUFFER *ptrFrame, int nStartx, int nStarty, int nStopx, int nStopy)
+{
+	int x, y;
+	int nRef;
+
+	for (y = nStarty; y < nStopy; y++)
+	{
+		for (x = nStartx; x < nStopx; x++)
+		{
+			if ((x == 0) || (y == 0) || (x == gnImageWidth - 1) || (y == gnImageHeight - 1))
+			{
+				nRef = 0;
+			}
+			else
+			{
+				nRef = nSobelReference(ptrFrame, x, y);
+			}
+			if (ptrFrame->un8Grad[y][x] != nRef)
+			{
+				if (glnHostMismatch < 10)
+				{
+					printf("Pixel (%d, %d): gradient %d, Sobel_Transform.sce %d\n", x, y, ptrFrame->un8Grad[y][x], nRef);
+				}
+				glnHostMismatch++;
+			}
+			glnHostChecked++;
+			if (nRef > 0)
+			{
+				glnHostEdge++;
+			}
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int nOpt;
+	int nFrames = 100;
+	int nFrame;
+	int nWindows, ni;
+	int nStartx[3], nStarty[3], nWidth[3], nHeight[3];
+	FRAME_BUFFER *ptrFrame = &gstrcFrameBuffer[0];
+	unsigned int unAttributes = _CAMERA_ATT_LUMINANCE | _CAMERA_ATT_GRADIENT;
+
+	while ((nOpt = getopt(argc, argv, "f:")) != -1)
+	{
+		switch (nOpt)
+		{
+			case 'f': nFrames = atoi(optarg); break;
+			default:
+			fprintf(stderr, "Usage: %s [-f frames]\n", argv[0]);
+			return 1;
+		}
+	}
+	for (ni = 0; ni < 3; ni++)
+	{
+		gstrcHostTask[ni].nID = ni + 1;
+	}
+
+	for (nFrame = 0; nFrame < nFrames; nFrame++)
+	{
+		HostFillFrame(nFrame & 0x1);
+		
+		// Whole frame.
+		for (ni = 0; ni < 3; ni++)
+		{
+			CameraSetWindow(&gstrcHostTask[ni], 0, 0, 0, 0);
+		}
+		memset(ptrFrame, 0xEE, sizeof(FRAME_BUFFER));
+		unHostPreprocessFrame(ptrFrame, unAttributes);
+		CheckRegion(ptrFrame, 0, 0, gnImageWidth, gnImageHeight);
+		
+		// Analysis windows, the lines outside the windows are not updated.
+		nWindows = 1 + (unHostFrameRandom() % 3);
+		for (ni = 0; ni < nWindows; ni++)
+		{
+			nStartx[ni] = unHostFrameRandom() % gnImageWidth;
+			nStarty[ni] = unHostFrameRandom() % gnImageHeight;
+			nWidth[ni] = 1 + (unHostFrameRandom() % (gnImageWidth - nStartx[ni]));
+			nHeight[ni] = 1 + (unHostFrameRandom() % (gnImageHeight - nStarty[ni]));
+			CameraSetWindow(&gstrcHostTask[ni], nStartx[ni], nStarty[ni], nWidth[ni], nHeight[ni]);
+		}
+		memset(ptrFrame, 0xEE, sizeof(FRAME_BUFFER));
+		unHostPreprocessFrame(ptrFrame, unAttributes);
+		for (ni = 0; ni < nWindows; ni++)
+		{
+			CheckRegion(ptrFrame, nStartx[ni], nStarty[ni], nStartx[ni] + nWidth[ni], nStarty[ni] + nHeight[ni]);
+		}
+	}
+	printf("Frames             : %d\n", nFrames);
+	printf("Pixels checked     : %ld, %ld with gradient above the noise floor\n", glnHostChecked, glnHostEdge);
+	printf("Mismatch           : %ld\n", glnHostMismatch);
+	return (glnHostMismatch == 0) ? 0 : 1;
+}
@@ -0,0 +1,175 @@
+//////////////////////////////////////////////////////////////////////////////////////////////
+//
+// File				: sam.h
+// Author(s)		: Fabian Kung
+// Last modified	: 16 Oct 2026
+// Tool-suites		: GCC C-Compiler (Linux or MinGW)
+//////////////////////////////////////////////////////////////////////////////////////////////
+// Host replacement of the CMSIS device header, so that osmain.h, os_APIs.c, os_Coroutine.c and
+// Driver_TCM8230.c compile on the computer.  The cycle counter DWT->CYCCNT is emulated with the
+// monotonic clock of the computer at __FCORE_MHz.  The PIO and PMC registers used by the camera
+// driver are plain variables, and the Cortex-M7 intrinsics are written in C.
+
+#ifndef _HOST_SAM_H
+#define _HOST_SAM_H
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#define		__INLINE				inline
+#define		__STATIC_INLINE			static inline
+#define		__STATIC_FORCEINLINE	static inline __attribute__((always_inline))
+#define		__ASM					__asm
+#define		_HOST_FCORE_MHz			300				// Same as __FCORE_MHz in osmain.h.
+
+typedef struct
+{
+	uint32_t	CTRL;
+	uint32_t	CYCCNT;
+	uint32_t	LAR;
+} DWT_Type;
+
+typedef struct
+{
+	uint32_t	DEMCR;
+} CoreDebug_Type;
+
+#define		DWT_CTRL_CYCCNTENA_Msk			(1UL << 0)
+#define		CoreDebug_DEMCR_TRCENA_Msk		(1UL << 24)
+
+// Update CYCCNT from the clock of the computer on every access of DWT.
+__STATIC_INLINE DWT_Type *ptrHostDWT(void)
+{
+	static DWT_Type strcDWT;
+	struct timespec strcTime;
+
+	clock_gettime(CLOCK_MONOTONIC, &strcTime);
+	strcDWT.CYCCNT = (uint32_t) ((uint64_t) strcTime.tv_sec*_HOST_FCORE_MHz*1000000 + (uint64_t) strcTime.tv_nsec*_HOST_FCORE_MHz/1000);
+	return &strcDWT;
+}
+
+__STATIC_INLINE CoreDebug_Type *ptrHostCoreDebug(void)
+{
+	static CoreDebug_Type strcCoreDebug;
+
+	return &strcCoreDebug;
+}
+
+#define		DWT						(ptrHostDWT())
+#define		CoreDebug				(ptrHostCoreDebug())
+
+typedef struct
+{
+	uint32_t	PIO_PDR;
+	uint32_t	PIO_ODSR;
+	uint32_t	PIO_PDSR;
+	uint32_t	PIO_ABCDSR[2];
+} Pio;
+
+typedef struct
+{
+	uint32_t	PMC_SCER;
+	uint32_t	PMC_SCDR;
+	uint32_t	PMC_PCK[8];
+} Pmc;
+
+__STATIC_INLINE Pio *ptrHostPIO(int nPort)
+{
+	static Pio strcPIO[4];
+
+	return &strcPIO[nPort];
+}
+
+__STATIC_INLINE Pmc *ptrHostPMC(void)
+{
+	static Pmc strcPMC;
+
+	return &strcPMC;
+}
+
+#define		PIOA					(ptrHostPIO(0))
+#define		PIOB					(ptrHostPIO(1))
+#define		PIOD					(ptrHostPIO(3))
+#define		PMC						(ptrHostPMC())
+
+#define		PIO_ODSR_P0				(1UL << 0)
+#define		PIO_ODSR_P7				(1UL << 7)
+#define		PIO_ODSR_P8				(1UL << 8)
+#define		PIO_ODSR_P21			(1UL << 21)
+#define		PIO_ODSR_P22			(1UL << 22)
+#define		PIO_ODSR_P31			(1UL << 31)
+#define		PIO_PDR_P3				(1UL << 3)
+#define		PIO_PDR_P12				(1UL << 12)
+#define		PIO_ABCDSR_P3			(1UL << 3)
+#define		PIO_ABCDSR_P12			(1UL << 12)
+#define		PMC_SCER_PCK0			(1UL << 8)
+#define		PMC_SCER_PCK2			(1UL << 10)
+#define		PMC_SCDR_PCK2			(1UL << 10)
+#define		PMC_PCK_CSS_MAIN_CLK	(1UL << 0)
+#define		PMC_PCK_CSS_MCK			(4UL << 0)
+#define		PMC_PCK_PRES(value)		((uint32_t) (value) << 4)
+
+// Swap the bytes in each 16-bits half word, same as the REV16 instruction.
+__STATIC_FORCEINLINE uint32_t __REV16(uint32_t unValue)
+{
+	return ((unValue & 0x00FF00FF) << 8) | ((unValue >> 8) & 0x00FF00FF);
+}
+
+// Packed SIMD instructions of the DSP extension, used by Driver_TCM8230.c when __ARM_FEATURE_DSP
+// is 1.  The GE flags of the APSR, set by __USUB8() and read by __SEL(), are kept in a variable.
+__STATIC_INLINE uint32_t *ptrHostGE(void)
+{
+	static uint32_t unGE;
+
+	return &unGE;
+}
+
+__STATIC_FORCEINLINE uint32_t __USUB8(uint32_t unOp1, uint32_t unOp2)
+{
+	uint32_t unResult = 0;
+	uint32_t unA, unB;
+	int nLane;
+
+	*ptrHostGE() = 0;
+	for (nLane = 0; nLane < 4; nLane++)
+	{
+		unA = (unOp1 >> (8*nLane)) & 0xFF;
+		unB = (unOp2 >> (8*nLane)) & 0xFF;
+		unResult |= ((unA - unB) & 0xFF) << (8*nLane);
+		if (unA >= unB)
+		{
+			*ptrHostGE() |= 1 << nLane;
+		}
+	}
+	return unResult;
+}
+
+__STATIC_FORCEINLINE uint32_t __SEL(uint32_t unOp1, uint32_t unOp2)
+{
+	uint32_t unResult = 0;
+	int nLane;
+
+	for (nLane = 0; nLane < 4; nLane++)
+	{
+		unResult |= (((*ptrHostGE() >> nLane) & 1) ? unOp1 : unOp2) & (0xFFUL << (8*nLane));
+	}
+	return unResult;
+}
+
+__STATIC_FORCEINLINE uint32_t __UQSUB8(uint32_t unOp1, uint32_t unOp2)
+{
+	uint32_t unResult = 0;
+	uint32_t unA, unB;
+	int nLane;
+
+	for (nLane = 0; nLane < 4; nLane++)
+	{
+		unA = (unOp1 >> (8*nLane)) & 0xFF;
+		unB = (unOp2 >> (8*nLane)) & 0xFF;
+		unResult |= ((unA > unB) ? (unA - unB) : 0) << (8*nLane);
+	}
+	return unResult;
+}
+
+#endif
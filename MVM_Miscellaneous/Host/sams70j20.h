@@ -0,0 +1,8 @@
+//////////////////////////////////////////////////////////////////////////////////////////////
+//
+// File				: sams70j20.h
+// Author(s)		: Fabian Kung
+// Last modified	: 16 Oct 2026
+// Tool-suites		: GCC C-Compiler (Linux or MinGW)
+//////////////////////////////////////////////////////////////////////////////////////////////
+// Host replacement of the device header, the peripherals are not used on the computer, see sam.h.
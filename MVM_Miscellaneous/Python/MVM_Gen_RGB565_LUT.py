@@ -0,0 +1,88 @@
+# -*- coding: utf-8 -*-
+"""
+Created on Fri Oct 16 2026
+
+@author: User
+
+Generate the RGB565 pixel decoder look-up table used by the camera driver
+(Driver_TCM8230.c) when __RGB565_LUT is defined.
+
+The table is indexed by the raw 16-bits word stored by the parallel capture
+DMA in gun16Pixel[], e.g. before the byte swap.  Each entry holds the packed
+pixel attributes in the same format as gunImgAtt[][]:
+   bit6 - bit0   = Luminance, 7-bits (luminance mode 0, I = (2R + 5G + B)/8).
+   bit16 - bit8  = Hue, 9-bits.
+   bit22 - bit17 = Saturation, 6-bits.
+The arithmetic below mirrors the pre-processing codes in state 10 of
+Proce_TCM8230_Driver() line by line, including the truncation towards zero
+of C integer division, so that the table output is bit exact with the
+arithmetic path.
+
+Usage: python MVM_Gen_RGB565_LUT.py [output file]
+The default output is RGB565_LUT.h in the current folder, run the script in
+the firmware folder (or copy the output file there) before enabling
+__RGB565_LUT.  The table occupies 256 KBytes of flash.  The table is checked
+against the arithmetic decoder with MVM_Miscellaneous/Host/Decoder_Host_LUT.c.
+"""
+import sys
+
+_LUMINANCE_SHIFT = 0
+_HUE_SHIFT = 8
+_SAT_SHIFT = 17
+_NO_HUE_BRIGHT = 366
+_NO_HUE_DARK = 363
+
+#Integer division with the same rounding as C, e.g. truncate towards zero.
+def cdiv(a, b):
+    q = abs(a) // abs(b)
+    if (a < 0) != (b < 0):
+        q = -q
+    return q
+
+#Compute the packed pixel attributes for one raw pixel word.
+def pixel_attribute(raw):
+    unTemp = ((raw << 8) & 0xFF00) | ((raw >> 8) & 0x00FF)   #Same as __REV16().
+    nR6 = (unTemp >> 10) & 0x3E
+    nG6 = (unTemp >> 5) & 0x3F
+    nB6 = (unTemp & 0x01F) << 1
+    nLuminance = ((nR6 << 1) + (nG6 << 2) + nB6 + nG6) >> 2
+
+    unMaxRGB = max(nR6, nG6, nB6)
+    unMinRGB = min(nR6, nG6, nB6)
+    nDeltaRGB = unMaxRGB - unMinRGB
+    unSat = nDeltaRGB
+
+    if nDeltaRGB < 2:
+        if nLuminance < 60:
+            nHue = _NO_HUE_DARK
+        else:
+            nHue = _NO_HUE_BRIGHT
+    else:
+        if nR6 == unMaxRGB:
+            nHue = cdiv(60*(nG6 - nB6), nDeltaRGB)
+        elif nG6 == unMaxRGB:
+            nHue = 120 + cdiv(60*(nB6 - nR6), nDeltaRGB)
+        else:
+            nHue = 240 + cdiv(60*(nR6 - nG6), nDeltaRGB)
+        if nHue < 0:
+            nHue = nHue + 360
+
+    return (nLuminance << _LUMINANCE_SHIFT) | (unSat << _SAT_SHIFT) | (nHue << _HUE_SHIFT)
+
+_filename = 'RGB565_LUT.h'
+if len(sys.argv) > 1:
+    _filename = sys.argv[1]
+
+print("Generating RGB565 look-up table...")
+with open(_filename, 'w') as f:
+    f.write('// Generated by MVM_Gen_RGB565_LUT.py, do not edit.\n')
+    f.write('// Packed pixel attributes (luminance mode 0) indexed by the raw pixel word from the\n')
+    f.write('// parallel capture DMA, e.g. before byte swap.\n')
+    f.write('const unsigned int gunRGB565LUT[65536] = {\n')
+    for nIndex in range(0, 65536, 8):
+        f.write('  ' + ', '.join('0x%06X' % pixel_attribute(n) for n in range(nIndex, nIndex + 8)))
+        if nIndex + 8 < 65536:
+            f.write(',')
+        f.write('\n')
+    f.write('};\n')
+print("Table written to ", _filename)
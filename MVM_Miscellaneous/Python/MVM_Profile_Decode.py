@@ -0,0 +1,193 @@
+# -*- coding: utf-8 -*-
+"""
+Created on Fri Oct 16 2026
+
+@author: User
+
+Decode the profile dump of the MVM firmware into a profile report.  The dump
+is sent on UART0 in response to the 'T' command when __OS_PROFILE is defined
+in os_Profile.h, see nProfilePacket() in os_Profile.c for the packet format.
+Packets are framed like the image lines: [0xFF][252][Length][Payload], other
+packets in the capture (image lines, auxiliary data) are skipped.
+The task statistics sent in response to the 'U' command (line 251, see
+nTaskStatPacket() in os_Profile.c) are decoded from the same capture.
+
+Usage: python MVM_Profile_Decode.py capture.bin
+       python MVM_Profile_Decode.py -p COM3 [-b 115200] [-c T|U]
+With -p the command (default 'T') is sent to the serial port (requires
+pyserial) and the reply is decoded.  The raw reply is also saved to
+profile.bin.
+"""
+import sys
+
+_SYSTEMTICK_US = 166.67
+
+#Marker names, same order as the marker IDs in os_Profile.h.
+_marker_names = ['Camera line', 'RLE line', 'CNN Conv2D', 'CNN Dense1',
+                 'CNN Dense2', 'IPA4 state 0', 'IPA4 state 1', 'IPA4 state 2',
+                 'IPA4 state 3', 'IPA4 state 4', 'IPA4 state 5',
+                 'IPA4 state 6']
+
+#Task names, same order as the OSCreateTask() calls in main.c.  CNNDense is only present
+#when __OS_COROUTINE is defined, see os_Coroutine.h.
+_task_names = ['OSProce1', 'UART2', 'I2C1', 'Camera LED', 'USART0',
+               'TCM8230', 'StreamImage', 'Image4', 'CNNDense']
+
+#Upper limit of the task histogram bins in system ticks, see _TASK_HISTO_BINS.
+_histo_bins = ['<1/32', '<1/16', '<1/8', '<1/4', '<1/2', '<1', '<2', '>=2']
+
+#32-bits value sent as 5 bytes of 7-bits, lowest bits first.
+def get32(payload, index):
+    value = 0
+    for n in range(5):
+        value = value | ((payload[index + n] & 0x7F) << (7*n))
+    return value & 0xFFFFFFFF
+
+def marker_name(nid):
+    if nid < len(_marker_names):
+        return _marker_names[nid]
+    return 'Marker %d' % nid
+
+def task_name(position):
+    if position < len(_task_names):
+        return _task_names[position]
+    return 'Task %d' % position
+
+#Return the payloads of all profile (line 252) or task statistics (line 251)
+#packets in the byte stream.
+def profile_packets(data, line=252):
+    packets = []
+    n = 0
+    while n + 3 <= len(data):
+        if data[n] == 0xFF and n + 3 + data[n+2] <= len(data):
+            length = data[n+2]
+            if data[n+1] == line:
+                packets.append(data[n+3:n+3+length])
+            n = n + 3 + length
+        else:
+            n = n + 1
+    return packets
+
+def task_report(data):
+    packets = profile_packets(data, 251)
+    if len(packets) == 0 or packets[0][0] != 0:
+        return False
+    header = packets[0]
+    task_count = header[1]
+    overrun_task = header[2]
+    core_mhz = get32(header, 3)
+    ticks = get32(header, 8)
+    overrun = get32(header, 13)
+    overrun_cycles = get32(header, 18)
+    print("Core clock %d MHz, %d tasks, %d system ticks (%.1f msec) since the last dump"
+          % (core_mhz, task_count, ticks, ticks*_SYSTEMTICK_US/1000.0))
+    print("%-12s %3s %8s %8s %8s %8s %8s %7s %7s" % ('Task', 'ID', 'Dispatch',
+          'Min(us)', 'Avg(us)', 'Max(us)', 'Overrun', 'Load%', 'Ticks%'))
+    histograms = []
+    for payload in packets[1:]:
+        if payload[0] != 1:
+            continue
+        position = payload[1]
+        nid = payload[2]
+        dispatch = get32(payload, 3)
+        cmin = get32(payload, 8)
+        cavg = get32(payload, 13)
+        cmax = get32(payload, 18)
+        task_overrun = get32(payload, 23)
+        histo = [get32(payload, 28 + 5*n) for n in range(len(_histo_bins))]
+        load = 0.0
+        active = 0.0
+        if ticks > 0:
+            load = 100.0*dispatch*cavg/core_mhz/(ticks*_SYSTEMTICK_US)
+            active = 100.0*dispatch/ticks
+        print("%-12s %3d %8d %8.2f %8.2f %8.2f %8d %7.2f %7.2f" % (
+              task_name(position), nid, dispatch, cmin/core_mhz,
+              cavg/core_mhz, cmax/core_mhz, task_overrun, load, active))
+        histograms.append((task_name(position), histo))
+    print("Load% is the share of the processor time, Ticks% the share of the system")
+    print("ticks in which the task is dispatched.")
+    print()
+    print("Dispatch duration histogram, in system ticks:")
+    print("%-12s" % 'Task' + ''.join(["%8s" % b for b in _histo_bins]))
+    for name, histo in histograms:
+        print("%-12s" % name + ''.join(["%8d" % h for h in histo]))
+    print()
+    if overrun == 0:
+        print("No system tick overrun.")
+    else:
+        print("%d system ticks overran, last by task ID %d: %d cycles (%.2f usec)"
+              % (overrun, overrun_task, overrun_cycles, overrun_cycles/core_mhz))
+    return True
+
+def report(data):
+    tasks = task_report(data)
+    packets = profile_packets(data)
+    if len(packets) == 0 or packets[0][0] != 0:
+        if not tasks:
+            print("No profile or task statistics header found, is __OS_PROFILE defined?")
+        return
+    if tasks:
+        print()
+    header = packets[0]
+    core_mhz = get32(header, 3)
+    ticks = get32(header, 8)
+    trace_count = get32(header, 13)
+    print("Core clock %d MHz, %d system ticks (%.1f msec) since the last dump"
+          % (core_mhz, ticks, ticks*_SYSTEMTICK_US/1000.0))
+    print("%-14s %8s %10s %10s %10s %8s %8s %7s" % ('Marker', 'Count',
+          'Min', 'Avg', 'Max', 'Avg(us)', 'Max(us)', 'Load%'))
+    trace = []
+    for payload in packets[1:]:
+        if payload[0] == 1:
+            nid = payload[1]
+            count = get32(payload, 2)
+            if count == 0:
+                continue
+            cmin = get32(payload, 7)
+            cavg = get32(payload, 12)
+            cmax = get32(payload, 17)
+            load = 0.0
+            if ticks > 0:
+                load = 100.0*count*cavg/core_mhz/(ticks*_SYSTEMTICK_US)
+            print("%-14s %8d %10d %10d %10d %8.2f %8.2f %7.2f" % (
+                  marker_name(nid), count, cmin, cavg, cmax,
+                  cavg/core_mhz, cmax/core_mhz, load))
+        elif payload[0] == 2:
+            for n in range(payload[1]):
+                trace.append((payload[2 + 6*n], get32(payload, 3 + 6*n)))
+    print("Load% is the share of the processor time between the two dumps.")
+    print()
+    print("Last %d of %d trace entries, oldest first:" % (len(trace), trace_count))
+    for nid, cycles in trace:
+        flag = ''
+        if cycles/core_mhz > _SYSTEMTICK_US:
+            flag = '  > 1 system tick'
+        print("  %-14s %10d cycles %8.2f usec%s" % (marker_name(nid), cycles,
+              cycles/core_mhz, flag))
+
+if __name__ == '__main__':
+    if len(sys.argv) > 2 and sys.argv[1] == '-p':
+        import serial
+        import time
+        baud = 115200
+        command = b'T'
+        for n in range(3, len(sys.argv) - 1):
+            if sys.argv[n] == '-b':
+                baud = int(sys.argv[n+1])
+            elif sys.argv[n] == '-c':
+                command = sys.argv[n+1].encode()[:1]
+        port = serial.Serial(sys.argv[2], baud, timeout=0.5)
+        port.reset_input_buffer()
+        port.write(command)
+        time.sleep(1.0)
+        data = port.read(8192)
+        port.close()
+        with open('profile.bin', 'wb') as f:
+            f.write(data)
+    elif len(sys.argv) > 1:
+        with open(sys.argv[1], 'rb') as f:
+            data = f.read()
+    else:
+        print("Usage: python MVM_Profile_Decode.py capture.bin | -p port [-b baud] [-c T|U]")
+        sys.exit(1)
+    report(bytearray(data))
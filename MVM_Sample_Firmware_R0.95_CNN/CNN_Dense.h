@@ -0,0 +1,205 @@
+//////////////////////////////////////////////////////////////////////////////////////////////
+//
+// File				: CNN_Dense.h
+// Author(s)		: Fabian Kung
+// Last modified	: 16 Oct 2026
+// Tool-suites		: Atmel Studio 7.0 or later
+//                    GCC C-Compiler
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _CNN_DENSE_H
+#define _CNN_DENSE_H
+
+// Dense layers DNN1 and DNN2 of the CNN in Proce_Image4().  DNN1 is computed by nCNNDense1() in
+// the state machine (Proce_Image4() state 4), or by CNNDenseCoTask() in CoTask_CNNDense() when
+// __OS_COROUTINE is defined.  DNN2 is computed by CNNDense2() in both cases.  Both versions are
+// compiled on the computer by MVM_Miscellaneous/Host/Coroutine_Host_CNN.c (__OS_COROUTINE_HOST).
+// The weights are defined (not declared) in CNN.h, so CNN.h and this file are included by one
+// source file only.  Include after osmain.h, os_Profile.h, os_Coroutine.h and CNN.h, and after
+// PIN_FLAG4_SET and PIN_FLAG4_CLEAR are defined.
+
+//
+// --- PUBLIC CONSTANTS ---
+//
+// Number of nodes in dense neural network (DNN) layer 1
+#define		__FLATTENNODE			__LAYER0_CHANNEL*(__LAYER0_X/2)*(__LAYER0_Y/2)
+										
+#define		__CNN_BUDGET_CHECK		16	// No. of multiply-and-accumulate between the checks of OSBudgetExhausted(), 
+										// power of 2.
+										 
+										// 16 Oct 2026: The max number of path or weight to compute for a node in
+										// a DNN layer in each Systick used to be fixed by __LIMIT_CNN_FLATTEN (544 
+										// for 20.83 fps and 50x70 ROI), which was determined experimentally and 
+										// had to be reduced when other tasks were added.  Now the computation 
+										// continues until the processor cycles left in the Systick are used up,
+										// see OSBudgetExhausted() in osmain.h.  As an example, suppose
+										// we have Layer N with 1000 nodes map to Layer N+1 with 25 nodes in a
+										// DNN structure.  To compute the value in node k in Layer N+1, we need
+										// to: 
+										// (1) Multiply the output of 1000 nodes in Layer N with the respective
+										// weights, 
+										// (2) Accumulate the results and add a bias, then
+										// (3) Apply an activation function in node k in Layer N+1.  
+										// Step (1) is the most time consuming and to limit this operating within
+										// one Systick, we stop the multiply-and-accumulate when the budget is
+										// used up.  Thus for this example, if the budget allows for 864
+										// operations, in the 1st cycle the system will perform multiply-and-
+										// accumulate for 1st 864 outputs from Layer N, then the 2nd cycle will
+										// perform subsequent 136 multiply-and-accumulate operations.  In other
+										// words Step (1) will require 2 Systicks to complete.
+
+#if !defined(__OS_COROUTINE) || defined(__OS_COROUTINE_HOST)
+// Progress of DNN1 between two Systicks.
+typedef struct StructCNN_DENSE1
+{
+	int		ni;						// Index of the flatten node.
+	int		nNode;					// Node of DNN1 being computed.
+	int64_t	lnsTemp;				// 64-bits accumulator of the node.
+} CNN_DENSE1;
+
+/// Start DNN1 from the 1st flatten node of node 0.
+__STATIC_INLINE void CNNDense1Init(CNN_DENSE1 *ptrDense)
+{
+	ptrDense->ni = 0;
+	ptrDense->nNode = 0;
+	ptrDense->lnsTemp = 0;				// Clear the 64-bits accumulator register first.
+}
+
+/// Continue the multiply-and-accumulate of DNN1 until all the nodes are computed or the processor
+/// cycles of the Systick are used up, see OSBudgetExhausted().  Return 1 when all the nodes in
+/// ptrnDNN1Out[] are computed, 0 to continue in the next Systick.
+__STATIC_INLINE int nCNNDense1(CNN_DENSE1 *ptrDense, const int *ptrnFlat, int *ptrnDNN1Out)
+{
+	int		ni = ptrDense->ni;			// Local copies, kept in the registers in the loop.
+	int		nNode = ptrDense->nNode;
+	int64_t	lnsTemp = ptrDense->lnsTemp;
+	int64_t	lnTemp2;
+	int64_t	lnBias;
+	int		nTemp;
+	int		nCompCount = 0;
+	
+	while (nNode < __DNN1NODE)
+	{
+		lnTemp2 = ptrnFlat[ni];					// Load and convert to 64 bits integer.
+		nTemp = gnDNN1w[ni][nNode];				// Load 32 bits integer coefficients.
+		lnsTemp = lnsTemp + (lnTemp2*nTemp);	// Multiply and accumulate.	
+												// 9 May 2020: Initially I use 64 bits integer to
+												// store both multiplicands.  I discovered that if
+												// one of the multiplicands is 32 bits integer, the
+												// execution time will be halved. If both multiplicands
+												// are 32-bits integer, then overflow occurs.							
+		ni++;									// Increment index.
+		nCompCount++;							// Increment computation counter.
+		if (ni >= __FLATTENNODE)				// Check if reach end of flatten input for current DNN1 node.
+		{
+			lnBias = gnDNN1bias[nNode];			// Note: 19 May 2020. I discovered that because gnDNN1bias[]
+												// is a 32-bits integer register, if we use
+												// gnDNN1bias[nNode]*1000000, overflow will occur. Somehow
+												// the processor stores the result in 32-bits register before
+												// converting to 64-bits long integer.  This causes overflow.
+			lnBias = lnBias*1000000;			// Thus we need to divide this into two steps.
+			lnsTemp = lnsTemp + lnBias;			// Add bias.
+			ptrnDNN1Out[nNode] = lnsTemp/1000000;	// Scale back to 32 bits integer.
+			// ReLu activation function
+			if (ptrnDNN1Out[nNode] < 0)
+			{
+				ptrnDNN1Out[nNode] = 0;
+			}					
+			
+			ni = 0;								// Reset index.
+			lnsTemp = 0;						// Clear the 64-bits accumulator register first.					
+			nNode++;							// Point to next node in layer.
+		}
+		if (((nCompCount & (__CNN_BUDGET_CHECK-1)) == 0) && (OSBudgetExhausted()))	// Check if reach the BW of 
+		{																		// one Systick.
+			break;
+		}
+	}
+	ptrDense->ni = ni;
+	ptrDense->nNode = nNode;
+	ptrDense->lnsTemp = lnsTemp;
+	return (nNode >= __DNN1NODE) ? 1 : 0;
+}
+
+#endif
+
+/// Compute the output of each node in DNN2 from the output of DNN1.
+__STATIC_INLINE void CNNDense2(const int *ptrnDNN1Out, int *ptrnDNN2Out)
+{
+	int		nNode;
+	int		ni;
+	int		nTemp;
+	int64_t	lnsTemp;
+	int64_t	lnTemp2;
+	int64_t	lnBias;
+	
+	for (nNode = 0; nNode < __DNN2NODE; nNode++)
+	{
+		lnsTemp = 0;							// Clear temp 64-bits register first.
+		for (ni = 0; ni < __DNN1NODE; ni++)
+		{
+			lnTemp2 = ptrnDNN1Out[ni];			// Load and convert to 64 bits integer.
+			nTemp = gnDNN2w[ni][nNode];			// Load 32 bits integer coefficient.
+			lnsTemp = lnsTemp + (lnTemp2*nTemp);	// Multiply and accumulate.
+		}
+		lnBias = gnDNN2bias[nNode];
+		lnBias = lnBias*1000000;
+		lnsTemp = lnsTemp + lnBias;				// Add bias.
+		ptrnDNN2Out[nNode] = lnsTemp/1000000;	// Scale back to 32 bits integer.				
+	}
+}
+
+#if defined(__OS_COROUTINE) || defined(__OS_COROUTINE_HOST)
+/// Compute DNN1 and DNN2 in a co-task, see os_Coroutine.h.  DNN1 is written as nested loops, the
+/// co-task yields inside the inner loop when the processor cycles of the Systick are used up and
+/// continues there in the next Systick.  The indices and the accumulator are local variables
+/// which the compiler keeps in the registers, there is no state to save and reload at each
+/// Systick as in nCNNDense1().
+__STATIC_INLINE void CNNDenseCoTask(const int *ptrnFlat, int *ptrnDNN2Out)
+{
+	int		nDNN1Out[__DNN1NODE];
+	int		nNode;
+	int		ni;
+	int		nTemp;
+	int64_t	lnsTemp;
+	int64_t	lnTemp2;
+	int64_t	lnBias;
+	
+	PIN_FLAG4_SET;
+	PROFILE_BEGIN(_PROF_CNN_DENSE1);
+	for (nNode = 0; nNode < __DNN1NODE; nNode++)
+	{
+		lnsTemp = 0;							// Clear the 64-bits accumulator register first.
+		for (ni = 0; ni < __FLATTENNODE; ni++)
+		{
+			lnTemp2 = ptrnFlat[ni];				// Load and convert to 64 bits integer.
+			nTemp = gnDNN1w[ni][nNode];			// Load 32 bits integer coefficients.
+			lnsTemp = lnsTemp + (lnTemp2*nTemp);	// Multiply and accumulate.
+			if (((ni & (__CNN_BUDGET_CHECK-1)) == (__CNN_BUDGET_CHECK-1)) && (OSBudgetExhausted()))
+			{
+				PROFILE_END(_PROF_CNN_DENSE1);
+				PIN_FLAG4_CLEAR;
+				OSYield();						// Continue in next Systick.
+				PIN_FLAG4_SET;
+				PROFILE_BEGIN(_PROF_CNN_DENSE1);
+			}
+		}
+		lnBias = gnDNN1bias[nNode];				// See the note on gnDNN1bias[] in nCNNDense1().
+		lnBias = lnBias*1000000;
+		lnsTemp = lnsTemp + lnBias;				// Add bias.
+		nDNN1Out[nNode] = lnsTemp/1000000;		// Scale back to 32 bits integer.
+		if (nDNN1Out[nNode] < 0)				// ReLu activation function.
+		{
+			nDNN1Out[nNode] = 0;
+		}
+	}
+	PROFILE_END(_PROF_CNN_DENSE1);
+	
+	PROFILE_BEGIN(_PROF_CNN_DENSE2);
+	CNNDense2(nDNN1Out, ptrnDNN2Out);
+	PROFILE_END(_PROF_CNN_DENSE2);
+	PIN_FLAG4_CLEAR;
+}
+#endif
+
+#endif
@@ -0,0 +1,88 @@
+//////////////////////////////////////////////////////////////////////////////////////////////
+//
+// File				: Driver_Cache_HAL.h
+// Author(s)		: Fabian Kung
+// Last modified	: 16 Oct 2026
+// Tool-suites		: Atmel Studio 7.0 or later
+//                    GCC C-Compiler
+//                    ARM CMSIS 5.4.0
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _DRIVER_CACHE_HAL_H
+#define _DRIVER_CACHE_HAL_H
+
+// Data cache (D-Cache) maintenance of the DMA buffers.  Only the cache lines covering the address
+// range of the buffer are cleaned or invalidated, instead of the whole 16 KBytes D-Cache.
+// CacheCleanRange() - Write the cached data back to SRAM, call this before a DMA reads the buffer.
+// CacheInvalidateRange() - Discard the cached data, call this before and after a DMA writes the
+//                          buffer.  The buffer should be aligned to _DCACHE_LINE_SIZE and its size
+//                          an integer multiple of _DCACHE_LINE_SIZE, else variables sharing a cache
+//                          line with the buffer are discarded too.
+// When __CACHE_HAL_HOST is defined (computer build, see MVM_Miscellaneous/Host) the functions only
+// count the no. of bytes maintained in gunCacheCleanBytes and gunCacheInvalidateBytes.
+//#define		__CACHE_MAINT_WHOLE			// Uncomment this to maintain the whole D-Cache in each call (previous
+											// behaviour), for comparison.
+#define		_DCACHE_SIZE			16384	// Bytes.
+#define		_DCACHE_LINE_SIZE		32		// Bytes.
+
+#ifdef		__CACHE_HAL_HOST
+
+#include <stdint.h>
+
+extern	unsigned int	gunCacheCleanBytes;			// No. of bytes cleaned since power on.
+extern	unsigned int	gunCacheInvalidateBytes;	// No. of bytes invalidated since power on.
+
+/// No. of bytes in the cache lines covering nBytes from address ptrAddr.
+static inline unsigned int unCacheRangeBytes(void *ptrAddr, int nBytes)
+{
+	uintptr_t unStart = (uintptr_t) ptrAddr & ~(uintptr_t) (_DCACHE_LINE_SIZE - 1);
+	uintptr_t unStop = ((uintptr_t) ptrAddr + nBytes + _DCACHE_LINE_SIZE - 1) & ~(uintptr_t) (_DCACHE_LINE_SIZE - 1);
+	
+	#ifdef		__CACHE_MAINT_WHOLE
+	return _DCACHE_SIZE;
+	#else
+	return (unsigned int) (unStop - unStart);
+	#endif
+}
+
+static inline void CacheCleanRange(void *ptrAddr, int nBytes)
+{
+	gunCacheCleanBytes = gunCacheCleanBytes + unCacheRangeBytes(ptrAddr, nBytes);
+}
+
+static inline void CacheInvalidateRange(void *ptrAddr, int nBytes)
+{
+	gunCacheInvalidateBytes = gunCacheInvalidateBytes + unCacheRangeBytes(ptrAddr, nBytes);
+}
+
+#else
+
+#include "osmain.h"
+
+/// SCB_CleanDCache_by_Addr() steps through the cache lines from the start address, so the start
+/// address is aligned to the cache line and the size extended accordingly.
+__STATIC_FORCEINLINE void CacheCleanRange(void *ptrAddr, int nBytes)
+{
+	#ifdef		__CACHE_MAINT_WHOLE
+	SCB_CleanDCache();
+	#else
+	uint32_t unStart = (uint32_t) ptrAddr & ~(_DCACHE_LINE_SIZE - 1);
+	
+	SCB_CleanDCache_by_Addr((uint32_t *) unStart, nBytes + ((uint32_t) ptrAddr - unStart));
+	#endif
+}
+
+__STATIC_FORCEINLINE void CacheInvalidateRange(void *ptrAddr, int nBytes)
+{
+	#ifdef		__CACHE_MAINT_WHOLE
+	SCB_InvalidateDCache();
+	#else
+	uint32_t unStart = (uint32_t) ptrAddr & ~(_DCACHE_LINE_SIZE - 1);
+	
+	SCB_InvalidateDCache_by_Addr((uint32_t *) unStart, nBytes + ((uint32_t) ptrAddr - unStart));
+	#endif
+}
+
+#endif
+
+#endif
@@ -0,0 +1,32 @@
+//////////////////////////////////////////////////////////////////////////////////////////////
+//
+// File				: Driver_Capture_HAL.h
+// Author(s)		: Fabian Kung
+// Last modified	: 16 Oct 2026
+// Tool-suites		: Atmel Studio 7.0 or later
+//                    GCC C-Compiler
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _DRIVER_CAPTURE_HAL_H
+#define _DRIVER_CAPTURE_HAL_H
+
+// Hardware abstraction of the camera parallel capture, used by Proce_TCM8230_Driver() to 
+// receive one line of pixel data at a time.  There are two implementations:
+// 1. Driver_Capture_SAMS70.c - PIOA parallel capture with XDMAC channel 0, for the MVM hardware.
+// 2. MVM_Miscellaneous/Host/Capture_Host_BMP.c - Plays back BMP files on a computer with the line
+//    timing of the camera, to measure the line processing margin of the camera driver.
+// This header does not include osmain.h so that it can be compiled on the computer.
+#include <stdint.h>
+
+//
+// --- PUBLIC FUNCTION PROTOTYPE ---
+//
+void CaptureHALInit(uint16_t *, int);	// Setup the capture hardware, destination line buffer and line width in pixels.
+int nCaptureHALIdle(void);				// Return 1 during vertical blanking (VSync = 'H' and HSync = 'L').
+int nCaptureHALStartOfFrame(void);		// Return 1 when a new frame starts (VSync = 'L').
+void CaptureHALArmLine(uint16_t *);		// Start the transfer of the next line of pixels into the line buffer.
+int nCaptureHALLineDone(void);			// Return 1 when the transfer started by CaptureHALArmLine() is complete.
+int nCaptureHALOverrun(void);			// Return 1 if pixel data is lost since the last call, e.g. a line 
+										// started before the transfer is armed.  The flag is cleared.
+
+#endif
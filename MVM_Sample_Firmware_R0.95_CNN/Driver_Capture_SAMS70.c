@@ -0,0 +1,142 @@
+//////////////////////////////////////////////////////////////////////////////////////////////
+//
+// File				: Driver_Capture_SAMS70.c
+// Author(s)		: Fabian Kung
+// Last modified	: 16 Oct 2026
+// Tool-suites		: Atmel Studio 7.0 or later
+//                    GCC C-Compiler
+//                    ARM CMSIS 5.4.0
+//                    SAMS70_DFP 2.3.88
+//////////////////////////////////////////////////////////////////////////////////////////////
+#include "osmain.h"
+#include "Driver_Capture_HAL.h"
+#include "Driver_Cache_HAL.h"
+
+// NOTE: Public function prototypes are declared in the corresponding *.h file.
+
+// Parallel capture of the camera pixel data with PIOA and XDMAC channel 0, see Driver_Capture_HAL.h.
+//
+// Pins: PA3-PA5, PA9-PA13 (Inputs) = PIODC0 to PIODC7 (Data0-7 of camera)
+//       PA22 (Input) = PIODCCLK (Dclk)
+//       PA14 (Input) = PIODCEN1 (VSync)
+//       PA21 (Input) = PIODCEN2 (HSync)
+
+int		gnCaptureLineBytes;				// Size of the line buffer in bytes.
+
+///
+/// Setup XDMAC channel 0 and the parallel capture mode of PIOA.  ptrLine is the first line buffer
+/// and nWidth the no. of pixels in a line.
+void CaptureHALInit(uint16_t *ptrLine, int nWidth)
+{
+	int nTemp;
+	
+	gnCaptureLineBytes = nWidth*sizeof(uint16_t);
+	// --- The following initialization sequence for PIOA with DMA follows the recommendation of the datasheet ---
+	// Parallel Capture mode interrupt settings.
+	PIOA->PIO_PCIDR = PIOA->PIO_PCIDR | PIO_PCISR_DRDY | PIO_PCIDR_ENDRX | PIO_PCIDR_DRDY | PIO_PCIDR_RXBUFF | PIO_PCIDR_OVRE; // Disable all PCM interrupts.
+	
+	// Setup XDMAC Channel to handle transfer of data from parallel capture buffer to memory.
+	// Channel allocation: 0.
+	// Source: PIOA (XDMAC_CC.PERID = 34).
+	// Destination: SRAM.
+	// Transfer mode (TYPE): Single block with single microblock. (BLEN = 0)
+	// Chunk size (CSIZE): 1 chunks
+	// Memory burst size (MBSIZE): 4
+	// Channel data width (DWIDTH): halfword.
+	// Source address mode (SAM): fixed.
+	// Destination addres mode (DAM): increment.
+	//
+	// For peripheral to memory transfer, each microblock transfer is further divided into 'Chunks'.
+	// The datasheet did not explain clearly the size of each chunk, I would understand it as the smallest unit of data transfer 
+	// from the peripheral as set in DWIDTH in XDMAC_CC register i.e. if the smallest data unit for the peripheral is byte, 
+	// then 1 chunk = 1 byte.  If the smallest data unit from the peripheral is a 16-bits half word, then 1 chunk = 1 half word. 
+	// Here we will use maximum of 16 chunks per burst.  Note that the
+	// number of burst should be an integral number of the microblock length.
+	// 
+	
+	nTemp = XDMAC->XDMAC_CHID[0].XDMAC_CIS;			// Clear channel 0 interrupt status register.  This is a read-only register, reading it will clear all
+													// interrupt flags.
+	XDMAC->XDMAC_CHID[0].XDMAC_CSA = (uint32_t)&(PIOA->PIO_PCRHR);	// Set source start address.
+	XDMAC->XDMAC_CHID[0].XDMAC_CDA = (uint32_t) ptrLine;	// Set destination start address.
+	XDMAC->XDMAC_CHID[0].XDMAC_CUBC = XDMAC_CUBC_UBLEN(nWidth); // Set the number of data chunks in a microblock.
+	XDMAC->XDMAC_CHID[0].XDMAC_CC = XDMAC_CC_TYPE_PER_TRAN| 
+									XDMAC_CC_CSIZE_CHK_1| 
+									XDMAC_CC_MBSIZE_FOUR| 
+									XDMAC_CC_DWIDTH_HALFWORD|
+									XDMAC_CC_SAM_FIXED_AM| 
+									XDMAC_CC_DAM_INCREMENTED_AM|
+									XDMAC_CC_SIF_AHB_IF1|		// IF1 is Master AHB 5, connected to peripheral bus.
+									XDMAC_CC_DIF_AHB_IF0|		// IF0 is Master AHB 4, connected to internal SRAM.
+									XDMAC_CC_DSYNC_PER2MEM|
+									XDMAC_CC_SWREQ_HWR_CONNECTED|
+									XDMAC_CC_PERID(34); 
+	
+	XDMAC->XDMAC_CHID[0].XDMAC_CNDC = 0;		// Next descriptor control register.
+	XDMAC->XDMAC_CHID[0].XDMAC_CBC = 0;			// Block control register.
+	XDMAC->XDMAC_CHID[0].XDMAC_CDS_MSP = 0;		// Data stride memory set pattern register.
+	XDMAC->XDMAC_CHID[0].XDMAC_CSUS = 0;		// Source microblock stride register.
+	XDMAC->XDMAC_CHID[0].XDMAC_CDUS = 0;		// Destination microblock stride register.		
+				
+	// Enable parallel Capture mode of PIOA.
+	// Note: 26 Nov 2015, the following sequence needs to be followed (from datasheet), setting of PCEN flag
+	// should be the last.  Once PCEN is set, all the associated pins will automatically become input pins.
+	// Note that upon power up, by default all pins are set to output, so momentarily there can be a high current
+	// drawn from the chip.
+	
+	PIOA->PIO_PCMR = PIOA->PIO_PCMR | PIO_PCMR_DSIZE_HALFWORD;				// Data size is half word (16 bits).
+	PIOA->PIO_PCMR = PIOA->PIO_PCMR & ~PIO_PCMR_ALWYS & ~PIO_PCMR_HALFS;	// Sample all data, sample the data only when both
+																			// PIODCEN1 or PIODCEN2 are HIGH.	
+	PIOA->PIO_PCMR = PIOA->PIO_PCMR | PIO_PCMR_PCEN;						// Enable Parallel Capture module.  All related pins
+																			// will be automatically set to input.
+}
+
+/// Check pin PA14 (PIODCEN1) and PA21 (PIODCEN2) status, VSync = 'H' and HSync = 'L' between frames.
+int nCaptureHALIdle(void)
+{
+	return (((PIOA->PIO_PDSR & PIO_PDSR_P14) > 0) && ((PIOA->PIO_PDSR & PIO_PDSR_P21) == 0));
+}
+
+/// Check pin PA14 (PIODCEN1), VSync = 'L' at the start of a frame.
+int nCaptureHALStartOfFrame(void)
+{
+	return ((PIOA->PIO_PDSR & PIO_PDSR_P14) == 0);
+}
+
+/// Enable XDMAC channel 0 to transfer the next line of pixels into ptrLine.  The data cache lines of
+/// ptrLine are cleaned before and invalidated after enabling the DMA.
+void CaptureHALArmLine(uint16_t *ptrLine)
+{
+	int nTemp;
+	
+	CacheCleanRange(ptrLine, gnCaptureLineBytes);	// According to Atmel's AT17417 (Usage of XDMAC on SAMS/SAME/SAMV), to
+													// prevent memory coherency issue, we should clean data cache first before
+													// enabling DMA, then we should invalidate data cache after DMA is enabled.
+													// This is especially true when more than 1 masters is accessing the SRAM, here
+													// it is the XDMAC master and Cortex M7 master accessing SRAM simultaneously.
+													// Assuming Write-Back with Read and Write-Allocate (WB-RWA) cache policy:
+													// Cleaning the DCache writes the cache line back to SRAM.
+													// Invalidating the DCache forces subsequent read to copy the data from SRAM
+													// to the cache.
+													// Reference: TB3195, "Managing cache coherency on Cortex M7 based MCUs", Microchip Technology 2018.
+													
+	nTemp = XDMAC->XDMAC_CHID[0].XDMAC_CIS;			// Clear channel 0 interrupt status register.  This is a read-only register, reading it will clear all
+													// interrupt flags.
+	XDMAC->XDMAC_CHID[0].XDMAC_CDA = (uint32_t) ptrLine;	// Set destination start address.
+	XDMAC->XDMAC_GE = XDMAC_GE_EN0;					// Enable XDMAC Channel 0 (Flag ST0 in XDMAC_GS will be set by hardware).
+	CacheInvalidateRange(ptrLine, gnCaptureLineBytes);	// Mark the data cache as invalid. Subsequent read from DCache forces data to be copied from SRAM to
+													// the cache.  This is to be used after XDMAC updates the SRAM without the knowledge of the CPU's cache
+													// controller.
+}
+
+/// The flag ST0 in XDMAC_GS is cleared when the transfer is complete, indicating the line buffer is full.
+int nCaptureHALLineDone(void)
+{
+	return ((XDMAC->XDMAC_GS & XDMAC_GS_ST0_Msk) == 0);
+}
+
+/// The OVRE flag in PIO_PCISR is set when a new pixel data is captured before the previous one is read 
+/// from PIO_PCRHR, e.g. the line starts before the XDMAC channel is enabled.  Reading PIO_PCISR clears the flag.
+int nCaptureHALOverrun(void)
+{
+	return ((PIOA->PIO_PCISR & PIO_PCISR_OVRE) > 0);
+}
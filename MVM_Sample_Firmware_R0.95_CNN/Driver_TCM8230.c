@@ -11,26 +11,42 @@
 //////////////////////////////////////////////////////////////////////////////////////////////
 #include "osmain.h"
 #include "Driver_I2C1_V100.h"
+#include "Driver_TCM8230.h"
+#include "Driver_Capture_HAL.h"
+#include "os_Profile.h"
+#include <string.h>					// For memcpy().
 
 // NOTE: Public function prototypes are declared in the corresponding *.h file.
 
+// Optional table-driven pixel decoder.  When enabled the luminance, saturation and hue of each pixel
+// are read from a pre-computed table in flash (256 KBytes) indexed by the raw pixel word, instead of
+// being computed with the arithmetic routines in state 10.  The table only covers luminance mode 0
+// (luminance computed from R, G and B components), other luminance modes still use the arithmetic
+// routines.  The table is not kept in this folder, it is generated as a build step before enabling 
+// __RGB565_LUT, by running the Python script in this folder:
+//    python ../MVM_Miscellaneous/Python/MVM_Gen_RGB565_LUT.py RGB565_LUT.h
+// MVM_Miscellaneous/Host/Decoder_Host_LUT.c checks the table against unDecodePixel().
+//#define		__RGB565_LUT				// Uncomment this to use the look-up table.
+
+#ifdef		__RGB565_LUT
+#ifdef		__has_include
+#if !__has_include("RGB565_LUT.h")
+#error "Driver_TCM8230: RGB565_LUT.h not found, generate it with MVM_Gen_RGB565_LUT.py"
+#endif
+#endif
+#include "RGB565_LUT.h"
+#endif
+
 	
 //
 //
 // --- PUBLIC VARIABLES ---
 //
-#define _IMAGE_HRESOLUTION   160		// For 160x120 pixels QQVGA resolution.
-#define _IMAGE_VRESOLUTION   120
-#define _NOPIXELSINFRAME	 19200
 
-//#define _IMAGE_HRESOLUTION   128		// For 128x96 pixels subQCIF resolution.
-//#define _IMAGE_VRESOLUTION   96
-//#define _NOPIXELSINFRAME	 12288
-				
 int		gnFrameCounter = 0;
 int		gnImageWidth = _IMAGE_HRESOLUTION;
 int		gnImageHeight = _IMAGE_VRESOLUTION;
-int		gnCameraLED = 0;
+unsigned int	gnCameraLED = 0;
 int		gnLuminanceMode = 0;		// Option to set how luminance value for each pixel
 									// is computed from the RGB component.
 									// 0 - Luminance (I) is computed from RGB using 
@@ -39,47 +55,62 @@ int		gnLuminanceMode = 0;		// Option to set how luminance value for each pixel
 									// 2 - I = 2G
 									// Else - I = 4B
 
-unsigned int gunImgAtt[_IMAGE_HRESOLUTION][_IMAGE_VRESOLUTION];   // 1st image frame image attribute buffer.
-unsigned int gunImgAtt2[_IMAGE_HRESOLUTION][_IMAGE_VRESOLUTION];   // 2nd image frame image attribute buffer.
-int		gnValidFrameBuffer;			// If equals 1, it means gunImgAtt[] data can be used for image processing.
-									// If equals 2, then gunImgAtt2[] data can be used instead for image processing.
-									// Under normal operation, the value of gnValidFrameBuffer will alternate
-									// between 1 and 2 as raw pixel data captured from the camera is store in 
-									// gunImgAtt[] and gunImgAtt2[] alternately.
-
-// bit6 - bit0 = Luminance information, 7-bits.
-// bit7 - Marker flag, set to 1 if we wish the external/remote display to highlight
-//        this pixel. (Currently not used).
-// bit16 - bit8 = Hue information, 9-bits, 0 to 360, No hue (gray scale) = 511.
-// bit22 - bit17 = Saturation, 6-bits, 0-63 (63 = pure spectral).
-// bit30 - bit23 = Luminance gradient, 8-bits.
-// bit31 - Special flag. Can be used to store boolean type results of image processing algorithms.
-
-#define     _LUMINANCE_MASK     0x0000007F  // luminance mask, bit6-0.
-#define     _CLUMINANCE_MASK    0xFFFFFF80  // One's complement of luminance mask.
-#define     _LUMINANCE_SHIFT    0
-#define     _HUE_MASK           0x0001FF00  // bit16-8
-#define     _HUE_SHIFT          8
-#define     _SAT_MASK           0x003E0000  // Saturation mask, bit22-17.
-#define     _CSAT_MASK          0xFFC1FFFF  // One's complement of saturation mask.
-#define     _SAT_SHIFT          17
-#define     _NO_HUE_BRIGHT      366         // Value for no hue when object is too bright or near grayscale.
-#define     _NO_HUE_DARK		363         // Value for no hue when object is too dark.
-// Valid hue ranges from 0 to 360.
-#define     _GRAD_MASK          0x7F800000  // bit30-23
-#define     _CGRAD_MASK         0x807FFFFF  // One's complement of gradient mask.
-#define     _GRAD_SHIFT         23
-#define     _MAX_GRADIENT       255
+FRAME_BUFFER	gstrcFrameBuffer[_FRAME_POOL_SIZE];	// Frame pool, see Driver_TCM8230.h for the pixel attribute planes.
+unsigned int	gunFrameDropped = 0;		// No. of frames not stored as all free slots are held by the image processing tasks,
+											// or with line overrun.
+unsigned int	gunCameraFrameCycles = 0;	// No. of processor cycles spent on pre-processing the last frame.
+unsigned int	gunCameraLineCyclesMax = 0;	// Max. no. of processor cycles spent on pre-processing one line in the last frame.
+unsigned int	gunLineOverrun = 0;			// No. of line overruns, pixel data lost as the line buffer is not ready in time.
 
 int16_t gunIHisto[255];    // Histogram for intensity, 255 levels.
 unsigned int gunAverageLuminance = 0;
+FRAME_STATISTICS	gstrcFrameStat;			// Luminance statistics of the last frame.
+unsigned int	gunMaskThreshold = 0;		// Luminance threshold for the binarized mask integral image, pixels with luminance
+											// below this are counted.  0 = use average luminance of the previous frame.
 
 #define			_CAMERA_READY			1	// 1 = Camera module ready.
 #define			_CAMERA_NOT_READY		0	// 0 = Camera module not ready.
 int				gnCameraReady = _CAMERA_NOT_READY;		
 
 // --- PRIVATE VARIABLES ---										
-uint16_t gun16Pixel[_IMAGE_HRESOLUTION];		// Temporary buffer to store 1 line of pixel data (
+int		gnFrameSlotHold[_FRAME_POOL_SIZE];			// No. of image processing tasks holding each slot of the frame pool.
+unsigned int	gunFrameSlotSeq[_FRAME_POOL_SIZE];	// Frame sequence number (value of gnFrameCounter) of each slot.
+int		gnFrameNewest = -1;							// Slot with the newest complete frame, -1 if none.
+int		gnFrameWrite = -1;							// Slot being filled by the driver, -1 if the frame is dropped.
+unsigned int	gunCameraSubscription[__MAXTASK+1];	// Pixel attributes needed by each task, indexed by task ID.
+
+// Analysis windows, the camera driver only pre-processes the lines covered by the union of all windows.
+typedef struct StructCAMERA_WINDOW
+{
+	int		nStartx;				// First column.
+	int		nStarty;				// First row.
+	int		nStopx;					// Last column + 1, 0 if the window is not used.
+	int		nStopy;					// Last row + 1.
+} CAMERA_WINDOW;
+
+CAMERA_WINDOW	gstrcCameraWindow[__MAXTASK+1];		// Analysis window of each task, indexed by task ID.
+int		gnCameraWindowChanged = 1;					// Set to 1 to rebuild the line table at the next frame.
+#define		_LINE_SKIP			0					// Line is not covered by any window, not pre-processed.
+#define		_LINE_BORDER		1					// Line above or below a window, luminance only (for the Sobel window).
+#define		_LINE_WINDOW		2					// Line covered by at least one window.
+uint8_t		gun8LineType[_IMAGE_VRESOLUTION];		// Line table, type of each line.
+uint16_t	gun16LineStartx[_IMAGE_VRESOLUTION];	// Line table, columns covered by the windows in each line,
+uint16_t	gun16LineStopx[_IMAGE_VRESOLUTION];		// hue, saturation, gradient and RGB565 are only computed here.
+unsigned int	gunMaskThresholdFrame;				// Mask threshold for current frame, latched at start of frame.
+#ifdef		__LUM_HISTORY
+LUM_PLANE	gstrcLumHistory[_LUM_HISTORY_SIZE];		// Luminance history ring.
+int		gnLumHistoryNewest = 0;						// Plane with the luminance of the newest frame.
+int		gnLumHistoryWrite = 0;						// Plane being filled by the driver.
+int		gnLumHistoryCount = 0;						// No. of frames in the ring.
+#endif
+#ifdef		__LUM_PYRAMID
+uint16_t	gun16PyramidAcc1[_IMAGE_HRESOLUTION/2];	// Line state for pyramid level 1, sum of 2 pixels of the even line.
+uint16_t	gun16PyramidAcc2[_IMAGE_HRESOLUTION/4];	// Line state for pyramid level 2, sum of 8 pixels of the lower rows.
+#endif
+#define		_CAMERA_LINE_BUFFERS	2			// No. of line buffers, 2 or more.  The DMA fills one line buffer while the
+												// previous line is pre-processed.
+uint16_t gun16PixelLine[_CAMERA_LINE_BUFFERS][_IMAGE_HRESOLUTION] __attribute__ ((aligned (32)));	// Line buffers for raw pixel data,
+												// used in rotation.  Aligned to the D-Cache line, see Driver_Cache_HAL.h.
 
 // --- PRIVATE FUNCTION PROTOTYPES ---
 inline int Min(int a, int b) {return (a < b)? a: b;}
@@ -97,6 +128,1035 @@ __STATIC_FORCEINLINE uint16_t _REV16 (uint16_t op1)
 	return(result);
 }
 
+// Decode two pixels per iteration in the line pre-processing kernels using the packed SIMD instructions
+// of the Cortex-M7 DSP extension.  Comment this out to use the single pixel decoder.  The single pixel
+// decoder is also used when the DSP extension is not available.
+#define		__DUAL_PIXEL_SIMD
+#if defined(__DUAL_PIXEL_SIMD) && !(defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1))
+#undef		__DUAL_PIXEL_SIMD
+#endif
+
+///
+/// --- Line pre-processing kernels ---
+/// The pre-processing of one line of pixels is performed by a set of specialised line kernels, one 
+/// for each luminance mode, saturation/hue option and line class.  The line class is _LINE_FIRST for the first two lines of
+/// a frame, where the 3x3 Sobel window is not yet filled up, and _LINE_INTERIOR for subsequent lines
+/// (only when the gradient is needed for the previous line).
+/// The Sobel gradient stage works on the luminance plane of the last three lines.
+/// The kernel is selected once per line from gfptrLineKernel[][] in state 10, and the frame buffer to
+/// update is passed in as a pointer.  Thus the luminance mode, frame buffer and Sobel window checks
+/// are not repeated for every pixel, the compiler generates straight-line codes for each pixel.
+#define		_LINE_FIRST			0
+#define		_LINE_INTERIOR		1
+
+typedef unsigned int (*LINE_KERNEL)(FRAME_BUFFER *, const uint16_t *, int, unsigned int);
+
+/// Compute the hue of one pixel from the 6-bits RGB components, the maximum RGB component, the 
+/// saturation (difference between maximum and minimum RGB components) and the luminance.
+__STATIC_FORCEINLINE int nComputeHue(int nR6, int nG6, int nB6, unsigned int unMaxRGB, int nDeltaRGB, int nLuminance)
+{
+	int nHue;
+	
+	// --- Compute the hue ---
+	// When saturation is too low, the color is near gray scale, and hue value is not accurate.
+	// Similarly when the light is too bright, the difference between color components may not be large
+	// enough to work out the hue, and hue is also not accurate.
+	// From color theory (e.g. see Digital Image Processing by Gonzales and Woods, 2018), the minimum
+	// RGB component intensity corresponds to the white level intensity.  Thus the difference
+	// between maximum RGB component and white level is an indication of the saturation level.
+	// This difference needs to be sufficiently large for reliable hue computation.
+	// For 6 bits RGB components, the maximum value of recognition, we arbitrary sets this to at least
+	// 10% of the maximum RGB component. For 6 bits RGB color (as in RGB565 format) components, max = 63
+	// and min = 0.  Thus maximum difference is 63.  10% of this is 6.30. We then experiment with
+	// thresholds of 2 to 7 and select the best in terms of sensitivity and accuracy for the camera.
+	// Once we identified the condition where hue calculation is no valid, we need to distinguish
+	// between too bright and too dark/grayscale conditions.  For these two scenarios, we analyze the
+	// luminance.  From experiment, we set the threshold at 60.
+	if (nDeltaRGB < 2)              // Check if it is possible to make out the hue.
+	{
+		if(nLuminance < 60)			// Using luminance criteria.
+		{
+			nHue = _NO_HUE_DARK;
+		}
+		else
+		{
+			nHue = _NO_HUE_BRIGHT;
+		}
+	}
+	else   // Computation of hue, here I am using the hexagonal projection method for HSV color space,
+		   // as described in Wikipedia. https://en.wikipedia.org/wiki/HSL_and_HSV
+		   // This is easier than circular projection which require arc cosine function.
+	{
+		if (nR6 == unMaxRGB)					// nR6 is maximum. Note: since we are working with integers,
+		{										// be aware that when we perform integer division,
+			nHue = (60*(nG6 - nB6))/nDeltaRGB;	// the remainder will be discarded.
+		}
+		else if (nG6 == unMaxRGB)				// nG6 is maximum.
+		{
+			nHue = 120 + (60*(nB6 - nR6))/nDeltaRGB;
+		}
+		else									// nB6 is maximum.
+		{
+			nHue = 240 + (60*(nR6 - nG6))/nDeltaRGB;
+		}
+
+		if (nHue < 0)
+		{
+			nHue = nHue + 360;
+		}
+	}
+	return nHue;
+}
+
+/// Decode one raw pixel word from the line buffer into the pixel attributes (luminance, saturation
+/// and hue).  Arguments nMode (the luminance mode) and nHueSat (1 to compute saturation and hue, 0 for
+/// luminance only) are constants in each line kernel so that the unused branches are removed by the 
+/// compiler.
+__STATIC_FORCEINLINE unsigned int unDecodePixel(uint16_t un16Pixel, const int nMode, const int nHueSat)
+{
+	unsigned int unTemp;
+	int nR6, nG6, nB6;
+	int nLuminance;
+	int nHue;
+	unsigned int unSat;
+	unsigned int unMaxRGB, unMinRGB;
+	int nDeltaRGB;
+	
+	#ifdef		__RGB565_LUT
+	if (nMode == 0)									// Table-driven decoder, the table entry is already in the pixel 
+	{												// attribute format.
+		return gunRGB565LUT[un16Pixel];				// One load for luminance, saturation and hue.
+	}
+	#endif
+	
+	// --- Compute the 8-bits grey scale or intensity value of each pixel ---
+	// The data read into parallel bus by ARM Cortex M7 is: [Byte0][Byte1], e.g. in big endian format.
+	// However, the correct order should be small endian, so we need to swap the bytes order to obtain
+	// [Byte1][Byte0].
+	unTemp = __REV16(un16Pixel);				// Swap the position of lower and upper 8 bits!
+
+	nR6 = (unTemp >> 10) & 0x3E;				// Form the 6 bits R component.
+	nG6 = (unTemp >> 5) & 0x3F;					// Get the 6 bits G component.
+	nB6 = (unTemp & 0x01F)<<1;					// For the 6 bits B component.
+	
+	// --- 6 Jan 2015 ---
+	// Here we approximate the luminance I (or Y) as:
+	// I = 0.250R + 0.625G + 0.125B = (2R + 5G + B)/8
+	// where R, G and B ranges from 0 to 255.
+	// Since actual values for R, G and B are 5, 6 and 5 bits respectively, we normalize R and B to 6 bits
+	// by shifting, this will result in gray scale value from 0 to 127, occupying 7 bits.
+	if (nMode == 0)
+	{
+		nLuminance = ((nR6<<1) + (nG6<<2) + nB6 + nG6)>>2; // 7-bits luminance from RGB components.
+	}
+	else if (nMode == 1)
+	{
+		nLuminance = nR6<<1;	// 7-bits luminance from only 6-bits Red component.
+	}
+	else if (nMode == 2)
+	{
+		nLuminance = nG6<<1;	// 7-bits luminance from only 6-bits Green component.
+	}
+	else
+	{
+		nLuminance = nB6<<1;	// 7-bits luminance from only 6-bits Blue component.
+	}
+	
+	if (nHueSat == 0)						// No one needs the saturation and hue.
+	{
+		return nLuminance;
+	}
+
+	// --- Compute the saturation level ---
+	unMaxRGB = Max(nR6, Max(nG6, nB6));     // Find the maximum of R, G or B component
+	unMinRGB = Min(nR6, Min(nG6, nB6));     // Find the minimum of R, G or B components.
+	nDeltaRGB = unMaxRGB - unMinRGB;
+	unSat = nDeltaRGB;
+	// Note: Here we define the saturation as the difference between the maximum and minimum RGB values.
+	// A more proper term is called Chroma (as per Wikipedia article).
+	// In normal usage this value needs to be normalized with respect to maximum RGB value so that
+	// saturation is between 0.0 to 1.0.  Here to speed up computation we avoid using floating point
+	// variables. Thus the saturation is 6 bits since the color components are 6 bits, from 0 to 63.
+
+	nHue = nComputeHue(nR6, nG6, nB6, unMaxRGB, nDeltaRGB, nLuminance);
+	
+	return nLuminance | (unSat << _SAT_SHIFT) | (nHue << _HUE_SHIFT);
+}
+
+#ifdef		__DUAL_PIXEL_SIMD
+/// Decode two adjacent raw pixel words from the line buffer into the pixel attributes.  The two pixels
+/// are read as one 32-bits word, pixel 0 in the lower 16 bits and pixel 1 in the upper 16 bits.  The RGB
+/// components of both pixels are kept in byte 0 and byte 2 of a 32-bits word, so that the luminance, 
+/// maximum and minimum RGB components of both pixels are computed together.  The hue still needs one 
+/// division per pixel.  The result is bit exact with unDecodePixel().
+__STATIC_FORCEINLINE void DecodePixelPair(uint32_t unPixel2, const int nMode, const int nHueSat, unsigned int *ptrunPixel0, unsigned int *ptrunPixel1)
+{
+	uint32_t unTemp;
+	uint32_t unR6, unG6, unB6;
+	uint32_t unLuminance;
+	uint32_t unMaxRGB, unMinRGB, unDeltaRGB;
+	int nR6, nG6, nB6;
+	int nLuminance;
+	int nDeltaRGB;
+	int nHue;
+	
+	unTemp = __REV16(unPixel2);					// Swap the bytes of both pixels.
+	unR6 = (unTemp >> 10) & 0x003E003E;			// Form the 6 bits R components.
+	unG6 = (unTemp >> 5) & 0x003F003F;			// Get the 6 bits G components.
+	unB6 = (unTemp << 1) & 0x003E003E;			// Form the 6 bits B components.
+	
+	if (nMode == 0)								// See unDecodePixel().  Each 16 bits half is less than 512
+	{											// so no carry propagates into the upper pixel.
+		unLuminance = (((unR6<<1) + (unG6<<2) + unB6 + unG6) >> 2) & 0x007F007F;
+	}
+	else if (nMode == 1)
+	{
+		unLuminance = unR6<<1;
+	}
+	else if (nMode == 2)
+	{
+		unLuminance = unG6<<1;
+	}
+	else
+	{
+		unLuminance = unB6<<1;
+	}
+	
+	if (nHueSat == 0)							// No one needs the saturation and hue.
+	{
+		*ptrunPixel0 = unLuminance & 0xFF;
+		*ptrunPixel1 = unLuminance >> 16;
+		return;
+	}
+	
+	// Maximum and minimum of the RGB components for both pixels.  __USUB8() sets the GE flag of each byte
+	// lane where the first operand is larger or equal, __SEL() then picks each byte lane according to the GE flags.
+	__USUB8(unG6, unB6);
+	unMaxRGB = __SEL(unG6, unB6);
+	unMinRGB = __SEL(unB6, unG6);
+	__USUB8(unR6, unMaxRGB);
+	unMaxRGB = __SEL(unR6, unMaxRGB);
+	__USUB8(unR6, unMinRGB);
+	unMinRGB = __SEL(unMinRGB, unR6);
+	unDeltaRGB = __UQSUB8(unMaxRGB, unMinRGB);	// Saturation of both pixels.
+	
+	// Pixel 0.
+	nR6 = unR6 & 0xFF;
+	nG6 = unG6 & 0xFF;
+	nB6 = unB6 & 0xFF;
+	nLuminance = unLuminance & 0xFF;
+	nDeltaRGB = unDeltaRGB & 0xFF;
+	nHue = nComputeHue(nR6, nG6, nB6, unMaxRGB & 0xFF, nDeltaRGB, nLuminance);
+	*ptrunPixel0 = nLuminance | (nDeltaRGB << _SAT_SHIFT) | (nHue << _HUE_SHIFT);
+	
+	// Pixel 1.
+	nR6 = unR6 >> 16;
+	nG6 = unG6 >> 16;
+	nB6 = unB6 >> 16;
+	nLuminance = unLuminance >> 16;
+	nDeltaRGB = unDeltaRGB >> 16;
+	nHue = nComputeHue(nR6, nG6, nB6, unMaxRGB >> 16, nDeltaRGB, nLuminance);
+	*ptrunPixel1 = nLuminance | (nDeltaRGB << _SAT_SHIFT) | (nHue << _HUE_SHIFT);
+}
+#endif
+
+#ifdef		__SOBEL_GRADIENT
+#if defined(__GRADIENT_ORIENTATION) || defined(__GRADIENT_L2)
+#if _GRAD_DIR_BINS == 16
+#define		_GRAD_DIR_SHIFT			4				// 256/16 = 2^4 angle units per bin.
+#elif _GRAD_DIR_BINS == 8
+#define		_GRAD_DIR_SHIFT			5				// 256/8 = 2^5 angle units per bin.
+#else
+#error "Driver_TCM8230: _GRAD_DIR_BINS should be 8 or 16"
+#endif
+
+// atan(n/32) for n = 0 to 32, in units of 360/256 degrees.
+const uint8_t gun8AtanLUT[33] = {
+	0, 1, 3, 4, 5, 6, 8, 9, 10, 11, 12, 13, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 25, 26, 27, 28, 29, 29, 30, 31, 31, 32};
+
+// Integer square root of n for n = 0 to 255.
+const uint8_t gun8SqrtLUT[256] = {
+	0, 1, 1, 1, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3,
+	4, 4, 4, 4, 4, 4, 4, 4, 4, 5, 5, 5, 5, 5, 5, 5,
+	5, 5, 5, 5, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+	6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+	8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8,
+	8, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9,
+	9, 9, 9, 9, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+	10, 10, 10, 10, 10, 10, 10, 10, 10, 11, 11, 11, 11, 11, 11, 11,
+	11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+	12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+	12, 12, 12, 12, 12, 12, 12, 12, 12, 13, 13, 13, 13, 13, 13, 13,
+	13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+	13, 13, 13, 13, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+	14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+	14, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+	15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15};
+
+/// Integer square root of unSum for the L2 gradient magnitude, the result is limited to 127.  The 
+/// argument is scaled into the range of gun8SqrtLUT[] by an even no. of bits, the estimate from the 
+/// table is refined with one Newton-Raphson iteration and corrected to the floor of the square root.
+__STATIC_FORCEINLINE int nGradientISqrt(unsigned int unSum)
+{
+	int nShift;
+	int nRoot;
+	
+	if (unSum >= 127*127)
+	{
+		return 127;
+	}
+	if (unSum < 256)
+	{
+		return gun8SqrtLUT[unSum];
+	}
+	nShift = (unSum < 1024) ? 1 : ((unSum < 4096) ? 2 : 3);
+	nRoot = gun8SqrtLUT[unSum >> (2*nShift)] << nShift;		// Error is less than 2^nShift.
+	nRoot = (nRoot + (1 << (nShift - 1)) + unSum/(nRoot + (1 << (nShift - 1)))) >> 1;	// Newton-Raphson iteration.
+	while (nRoot*nRoot > unSum)
+	{
+		nRoot--;
+	}
+	while ((nRoot + 1)*(nRoot + 1) <= unSum)
+	{
+		nRoot++;
+	}
+	return nRoot;
+}
+
+/// Quantised orientation of the gradient (nGradx, nGrady).  The angle is atan2(nGrady, nGradx), e.g.
+/// measured from the +x axis (to the right) towards the +y axis (downward), in _GRAD_DIR_BINS bins 
+/// over 360 degrees with bin 0 centred at 0 degree.  The angle within an octant is read from 
+/// gun8AtanLUT[] with the ratio of the smaller to the larger component, and then mapped to the 
+/// octant from the signs and the larger component.
+__STATIC_FORCEINLINE int nGradientOrientation(int nGradx, int nGrady)
+{
+	int nAbsx = (nGradx < 0) ? -nGradx : nGradx;
+	int nAbsy = (nGrady < 0) ? -nGrady : nGrady;
+	int nAngle;										// 256 = 360 degrees.
+	
+	if (nAbsx >= nAbsy)
+	{
+		if (nAbsx == 0)								// No gradient.
+		{
+			return 0;
+		}
+		nAngle = gun8AtanLUT[(nAbsy << 5)/nAbsx];	// 0 to 45 degrees.
+	}
+	else
+	{
+		nAngle = 64 - gun8AtanLUT[(nAbsx << 5)/nAbsy];	// 45 to 90 degrees.
+	}
+	if (nGradx < 0)									// 90 to 180 degrees.
+	{
+		nAngle = 128 - nAngle;
+	}
+	if (nGrady < 0)									// 180 to 360 degrees.
+	{
+		nAngle = 256 - nAngle;
+	}
+	return ((nAngle + (128/_GRAD_DIR_BINS)) >> _GRAD_DIR_SHIFT) & (_GRAD_DIR_BINS - 1);
+}
+#endif
+
+/// Sobel gradient stage.  Compute the luminance gradient of line nLine-1 from the luminance of lines
+/// nLine-2, nLine-1 and nLine, and store the result in the gradient plane of the frame buffer.  Only 
+/// columns nStartx to nStopx-1 are computed.  The luminance plane is row-major, so each line of luminance
+/// is read sequentially.  The first and last columns have zero gradient.  The orientation of the
+/// gradient is also stored if _CAMERA_ATT_GRAD_DIR is set in unAttributes.
+static void SobelGradientLine(FRAME_BUFFER *ptrFrame, int nLine, int nStartx, int nStopx, unsigned int unAttributes)
+{
+	int ncolindex;
+	const uint8_t *ptrLumAbove;
+	const uint8_t *ptrLumCenter;
+	const uint8_t *ptrLumBelow;
+	uint8_t *ptrGrad;
+	int	nLuminance1, nLuminance2, nLuminance3, nLuminance4, nLuminance5, nLuminance6;
+	int nLuminance7, nLuminance8;
+	int	nLumGradx, nLumGrady, nLumGrad;
+	#ifdef		__GRADIENT_ORIENTATION
+	uint8_t *ptrGradDir = ptrFrame->un8GradDir[nLine - 1];
+	int nGradDir = ((unAttributes & _CAMERA_ATT_GRAD_DIR) != 0);
+	#endif
+	
+	ptrLumAbove = ptrFrame->un8Lum[nLine - 2];
+	ptrLumCenter = ptrFrame->un8Lum[nLine - 1];
+	ptrLumBelow = ptrFrame->un8Lum[nLine];
+	ptrGrad = ptrFrame->un8Grad[nLine - 1];
+	
+	// Computing the luminance gradient using Sobel's Kernel.
+	//  |  L1 L7 L2  ---> Columns
+	//  |  L3 G  L4
+	// \|/ L5 L8 L6   Where G = pixel whose gradient we are computing.
+	//  Rows
+	// For each column we only need to read in the luminance values for 4 adjacent pixels, the rest are 
+	// shifted from the previous column.
+	if (nStartx < 1)
+	{
+		ptrGrad[0] = 0;
+		#ifdef		__GRADIENT_ORIENTATION
+		ptrGradDir[0] = 0;
+		#endif
+		nStartx = 1;
+	}
+	if (nStopx > gnImageWidth - 1)
+	{
+		ptrGrad[gnImageWidth - 1] = 0;
+		#ifdef		__GRADIENT_ORIENTATION
+		ptrGradDir[gnImageWidth - 1] = 0;
+		#endif
+		nStopx = gnImageWidth - 1;
+	}
+	if (nStartx >= nStopx)
+	{
+		return;
+	}
+	nLuminance1 = ptrLumAbove[nStartx - 1];
+	nLuminance5 = ptrLumBelow[nStartx - 1];
+	nLuminance7 = ptrLumAbove[nStartx];
+	nLuminance8 = ptrLumBelow[nStartx];
+	for (ncolindex = nStartx; ncolindex < nStopx; ncolindex++)
+	{
+		nLuminance2 = ptrLumAbove[ncolindex+1];
+		nLuminance3 = ptrLumCenter[ncolindex-1];
+		nLuminance4 = ptrLumCenter[ncolindex+1];
+		nLuminance6 = ptrLumBelow[ncolindex+1];
+		
+		// Calculate x gradient
+		nLumGradx = nLuminance2  + nLuminance6 - nLuminance1 - nLuminance5;
+		nLumGradx = nLumGradx + ((nLuminance4 - nLuminance3) << 1);
+		// Calculate y gradient
+		nLumGrady = nLuminance5  + nLuminance6 - nLuminance1 - nLuminance2;
+		nLumGrady = nLumGrady + ((nLuminance8 - nLuminance7) << 1);
+		
+		// Shift samples to obtain adjacent luminance values for next column.
+		nLuminance1 = nLuminance7;
+		nLuminance5 = nLuminance8;
+		nLuminance7 = nLuminance2;
+		nLuminance8 = nLuminance6;
+		
+		#ifdef		__GRADIENT_ORIENTATION
+		if (nGradDir)
+		{
+			ptrGradDir[ncolindex] = nGradientOrientation(nLumGradx, nLumGrady);
+		}
+		#endif
+		
+		if (nLumGradx < 0)		// Only magnitude is required.
+		{
+			nLumGradx = -nLumGradx;
+		}
+		if (nLumGrady < 0)		// Only magnitude is required.
+		{
+			nLumGrady = -nLumGrady;
+		}
+											// Calculate the magnitude of the luminance gradient.
+		#ifdef		__GRADIENT_L2
+		nLumGrad = nGradientISqrt(nLumGradx*nLumGradx + nLumGrady*nLumGrady);	// nLumGrad = sqrt(nLumGradx^2 + nLumGrady^2)
+		#else
+		nLumGrad = nLumGradx + nLumGrady;	// It should be nLumGrad = sqrt(nLumGradx^2 + nLumGrady^2)
+											// Here we the approximation nLumGrad = |nLumGradx| + |nLumGrady|
+		#endif
+
+		if (nLumGrad > 127)		// Limit the maximum value to 127 (7 bits only).  Bit8 is not used for
+		{						// luminance indication.
+			nLumGrad = 127;
+		}
+		if (nLumGrad < 20)		// To remove gradient noise.  Can reduce to 10 if the camera quality is good.
+		{
+			nLumGrad = 0;
+		}
+		ptrGrad[ncolindex] = nLumGrad;
+	}
+}
+#endif
+
+#if defined(__INTEGRAL_IMAGE) || defined(__INTEGRAL_MASK)
+/// Integral image stage.  Compute row nLine+1 of the integral images from row nLine of the luminance 
+/// plane, each entry is the sum of all pixels above and to the left: 
+/// I[y+1][x+1] = I[y][x+1] + (sum of row y from column 0 to x).  Row 0 and column 0 of the integral 
+/// images are 0, row 0 is never written by the driver.  If nSkip is 1 the line is not pre-processed
+/// (outside the analysis windows), the line is taken as 0 so that the region sums within the analysis
+/// windows are still correct.
+static void IntegralImageLine(FRAME_BUFFER *ptrFrame, int nLine, unsigned int unAttributes, int nSkip)
+{
+	int ncolindex;
+	const uint8_t *ptrLum = ptrFrame->un8Lum[nLine];
+	unsigned int unRowSum;
+	unsigned int unThreshold = gunMaskThresholdFrame;
+	#ifdef		__INTEGRAL_IMAGE
+	const uint32_t *ptrIntAbove = ptrFrame->unLumIntegral[nLine];
+	uint32_t *ptrInt = ptrFrame->unLumIntegral[nLine + 1];
+	#endif
+	#ifdef		__INTEGRAL_MASK
+	const uint16_t *ptrMaskAbove = ptrFrame->un16MaskIntegral[nLine];
+	uint16_t *ptrMask = ptrFrame->un16MaskIntegral[nLine + 1];
+	#endif
+	
+	#ifdef		__INTEGRAL_IMAGE
+	if (unAttributes & _CAMERA_ATT_INTEGRAL)
+	{
+		unRowSum = 0;
+		ptrInt[0] = 0;
+		for (ncolindex = 0; ncolindex < gnImageWidth; ncolindex++)
+		{
+			if (nSkip == 0)
+			{
+				unRowSum = unRowSum + ptrLum[ncolindex];
+			}
+			ptrInt[ncolindex + 1] = ptrIntAbove[ncolindex + 1] + unRowSum;
+		}
+	}
+	#endif
+	#ifdef		__INTEGRAL_MASK
+	if (unAttributes & _CAMERA_ATT_INTEGRAL_MASK)
+	{
+		unRowSum = 0;
+		ptrMask[0] = 0;
+		for (ncolindex = 0; ncolindex < gnImageWidth; ncolindex++)
+		{
+			if ((nSkip == 0) && (ptrLum[ncolindex] < unThreshold))	// Count the dark pixels.
+			{
+				unRowSum++;
+			}
+			ptrMask[ncolindex + 1] = ptrMaskAbove[ncolindex + 1] + unRowSum;
+		}
+	}
+	#endif
+}
+#endif
+
+#ifdef		__LUM_PYRAMID
+/// Luminance pyramid stage.  Each pyramid level is the 2x2 average of the level below, e.g. level 1 
+/// and 2 are the 2x2 and 4x4 box filter averages of the luminance plane, with rounding.  The 
+/// horizontal sums of the even lines are kept in one line of state per level, and the pyramid line 
+/// is produced when the odd line arrives, using the unrounded sums so that level 2 is the exact 
+/// 4x4 average.
+static void PyramidLine(FRAME_BUFFER *ptrFrame, int nLine)
+{
+	int ncolindex;
+	const uint8_t *ptrLum = ptrFrame->un8Lum[nLine];
+	uint8_t *ptrLum1;
+	uint8_t *ptrLum2;
+	unsigned int unSum, unSum1;
+	
+	if ((nLine & 0x1) == 0)						// Even line, keep the horizontal sums.
+	{
+		for (ncolindex = 0; ncolindex < gnImageWidth/2; ncolindex++)
+		{
+			gun16PyramidAcc1[ncolindex] = ptrLum[2*ncolindex] + ptrLum[2*ncolindex + 1];
+		}
+		return;
+	}
+	ptrLum1 = ptrFrame->un8Lum1[nLine >> 1];
+	if ((nLine & 0x2) == 0)						// Odd line, even line of level 1.
+	{
+		for (ncolindex = 0; ncolindex < gnImageWidth/4; ncolindex++)
+		{
+			unSum = gun16PyramidAcc1[2*ncolindex] + ptrLum[4*ncolindex] + ptrLum[4*ncolindex + 1];
+			unSum1 = gun16PyramidAcc1[2*ncolindex + 1] + ptrLum[4*ncolindex + 2] + ptrLum[4*ncolindex + 3];
+			ptrLum1[2*ncolindex] = (unSum + 2) >> 2;
+			ptrLum1[2*ncolindex + 1] = (unSum1 + 2) >> 2;
+			gun16PyramidAcc2[ncolindex] = unSum + unSum1;
+		}
+	}
+	else										// Odd line, odd line of level 1.
+	{
+		ptrLum2 = ptrFrame->un8Lum2[nLine >> 2];
+		for (ncolindex = 0; ncolindex < gnImageWidth/4; ncolindex++)
+		{
+			unSum = gun16PyramidAcc1[2*ncolindex] + ptrLum[4*ncolindex] + ptrLum[4*ncolindex + 1];
+			unSum1 = gun16PyramidAcc1[2*ncolindex + 1] + ptrLum[4*ncolindex + 2] + ptrLum[4*ncolindex + 3];
+			ptrLum1[2*ncolindex] = (unSum + 2) >> 2;
+			ptrLum1[2*ncolindex + 1] = (unSum1 + 2) >> 2;
+			ptrLum2[ncolindex] = (gun16PyramidAcc2[ncolindex] + unSum + unSum1 + 8) >> 4;
+		}
+	}
+}
+#endif
+
+/// Store the packed pixel attributes from the pixel decoder into the planes of the frame buffer.
+__STATIC_FORCEINLINE void StorePixelAttribute(FRAME_BUFFER *ptrFrame, int nLine, int ncolindex, unsigned int unPixel, const int nHueSat)
+{
+	ptrFrame->un8Lum[nLine][ncolindex] = unPixel & _LUMINANCE_MASK;
+	if (nHueSat == 1)
+	{
+		#ifdef		__FRAME_HUE_PLANE
+		ptrFrame->un16Hue[nLine][ncolindex] = (unPixel & _HUE_MASK) >> _HUE_SHIFT;
+		#endif
+		#ifdef		__FRAME_SAT_PLANE
+		ptrFrame->un8Sat[nLine][ncolindex] = (unPixel & _SAT_MASK) >> _SAT_SHIFT;
+		#endif
+	}
+}
+
+/// Decode columns nStartx to nStopx-1 of the line of raw pixels ptrPixel and store the pixel
+/// attributes in row nLine of the frame buffer ptrFrame.  The packed SIMD decoder reads two pixels
+/// with memcpy() into a 32-bits word (no pointer cast, so the strict aliasing rule holds), the
+/// compiler turns this into one LDR.  nStartx is always even (0, or a column from the line table
+/// which BuildLineTable() rounds down to even), and the line buffers are aligned to 32 bytes, so the
+/// LDR is word aligned.
+/// Return: The sum of luminance of the pixels.
+__STATIC_FORCEINLINE unsigned int unDecodeSegment(FRAME_BUFFER *ptrFrame, const uint16_t *ptrPixel, int nLine, int nStartx, int nStopx, const int nMode, const int nHueSat)
+{
+	int ncolindex;
+	unsigned int unPixel;
+	int nLuminance;
+	unsigned int unLumSum = 0;
+	#ifdef		__DUAL_PIXEL_SIMD
+	unsigned int unPixel1;
+	int nLuminance1;
+	uint32_t unPixel2;
+	#endif
+	
+	ncolindex = nStartx;
+	#ifdef		__DUAL_PIXEL_SIMD
+	#ifdef		__RGB565_LUT
+	if (nMode != 0)									// The look-up table is faster for luminance mode 0.
+	#endif
+	{
+		for ( ; ncolindex < nStopx - 1; ncolindex += 2)
+		{
+			memcpy(&unPixel2, &ptrPixel[ncolindex], sizeof(unPixel2));	// Pixel ncolindex and ncolindex+1.
+			DecodePixelPair(unPixel2, nMode, nHueSat, &unPixel, &unPixel1);
+			nLuminance = unPixel & _LUMINANCE_MASK;
+			nLuminance1 = unPixel1 & _LUMINANCE_MASK;
+			unLumSum = unLumSum + nLuminance + nLuminance1;	// Update the sum of luminance for all pixels in the line.
+			StorePixelAttribute(ptrFrame, nLine, ncolindex, unPixel, nHueSat);	// Update the pixel attributes.
+			StorePixelAttribute(ptrFrame, nLine, ncolindex+1, unPixel1, nHueSat);
+		}
+	}
+	#endif
+	for ( ; ncolindex < nStopx; ncolindex++)		// Remaining pixels.
+	{
+		unPixel = unDecodePixel(ptrPixel[ncolindex], nMode, nHueSat);
+		nLuminance = unPixel & _LUMINANCE_MASK;
+		unLumSum = unLumSum + nLuminance;			// Update the sum of luminance for all pixels in the line.
+		StorePixelAttribute(ptrFrame, nLine, ncolindex, unPixel, nHueSat);	// Update the pixel attributes.
+	}
+	return unLumSum;
+}
+
+/// Generic line kernel, pre-process one line of raw pixels ptrPixel and store the pixel attributes
+/// in row nLine of the frame buffer ptrFrame.  Arguments nMode, nHueSat and nLineClass are constants in
+/// each specialised line kernel.  The optional stages (histogram, gradient and RGB565 pass-through) are
+/// selected by the attribute mask unAttributes, see CameraSubscribe().  The integral images and luminance
+/// pyramid stages are also selected by unAttributes.  The luminance is computed for
+/// the whole line, the other attributes only for the columns covered by the analysis windows, see 
+/// CameraSetWindow().
+/// Return: The sum of luminance of all pixels in the line.
+__STATIC_FORCEINLINE unsigned int unPreprocessLine(FRAME_BUFFER *ptrFrame, const uint16_t *ptrPixel, int nLine, unsigned int unAttributes, const int nMode, const int nHueSat, const int nLineClass)
+{
+	int ncolindex;
+	unsigned int unLumSum;
+	uint8_t *ptrLum;
+	int nStartx = gun16LineStartx[nLine];
+	int nStopx = gun16LineStopx[nLine];
+	
+	if (nHueSat == 1)
+	{
+		unLumSum = unDecodeSegment(ptrFrame, ptrPixel, nLine, 0, nStartx, nMode, 0);
+		unLumSum = unLumSum + unDecodeSegment(ptrFrame, ptrPixel, nLine, nStartx, nStopx, nMode, 1);
+		unLumSum = unLumSum + unDecodeSegment(ptrFrame, ptrPixel, nLine, nStopx, gnImageWidth, nMode, 0);
+	}
+	else
+	{
+		unLumSum = unDecodeSegment(ptrFrame, ptrPixel, nLine, 0, gnImageWidth, nMode, 0);
+	}
+	
+	if (unAttributes & _CAMERA_ATT_HISTOGRAM)		// Update the intensity histogram.
+	{
+		ptrLum = ptrFrame->un8Lum[nLine];
+		for (ncolindex = 0; ncolindex < gnImageWidth; ncolindex++)
+		{
+			gunIHisto[ptrLum[ncolindex]]++;
+		}
+	}
+	
+	#ifdef		__FRAME_RGB_PLANE
+	if (unAttributes & _CAMERA_ATT_RGB)				// Pass-through of the RGB565 pixel data.
+	{
+		for (ncolindex = nStartx; ncolindex < nStopx; ncolindex++)
+		{
+			ptrFrame->un16RGB[nLine][ncolindex] = __REV16(ptrPixel[ncolindex]);
+		}
+	}
+	#endif
+	
+	#if defined(__INTEGRAL_IMAGE) || defined(__INTEGRAL_MASK)
+	if (unAttributes & (_CAMERA_ATT_INTEGRAL | _CAMERA_ATT_INTEGRAL_MASK))
+	{
+		IntegralImageLine(ptrFrame, nLine, unAttributes, 0);
+	}
+	#endif
+	
+	#ifdef		__LUM_PYRAMID
+	if (unAttributes & _CAMERA_ATT_PYRAMID)
+	{
+		PyramidLine(ptrFrame, nLine);
+	}
+	#endif
+	
+	#ifdef		__LUM_HISTORY
+	if (unAttributes & _CAMERA_ATT_HISTORY)			// Copy the luminance to the history ring.
+	{
+		memcpy(gstrcLumHistory[gnLumHistoryWrite].un8Lum[nLine], ptrFrame->un8Lum[nLine], gnImageWidth);
+	}
+	#endif
+	
+	#ifdef		__SOBEL_GRADIENT
+	if (unAttributes & _CAMERA_ATT_GRADIENT)
+	{
+		if (nLineClass == _LINE_INTERIOR)			// Gradient of the previous line.
+		{
+			SobelGradientLine(ptrFrame, nLine, gun16LineStartx[nLine-1], gun16LineStopx[nLine-1], unAttributes);
+		}
+		if ((nLine == 0) || (nLine == gnImageHeight - 1))	// No gradient for the first and last lines.
+		{
+			for (ncolindex = 0; ncolindex < gnImageWidth; ncolindex++)
+			{
+				ptrFrame->un8Grad[nLine][ncolindex] = 0;
+				#ifdef		__GRADIENT_ORIENTATION
+				ptrFrame->un8GradDir[nLine][ncolindex] = 0;
+				#endif
+			}
+		}
+	}
+	#endif
+	
+	return unLumSum;
+}
+
+// Specialised line kernels, one for each luminance mode, saturation/hue option and line class.
+#define		_DEFINE_LINE_KERNEL(KernelName, nMode, nHueSat, nLineClass)	\
+static unsigned int KernelName(FRAME_BUFFER *ptrFrame, const uint16_t *ptrPixel, int nLine, unsigned int unAttributes)	\
+{																						\
+	return unPreprocessLine(ptrFrame, ptrPixel, nLine, unAttributes, nMode, nHueSat, nLineClass);	\
+}
+
+_DEFINE_LINE_KERNEL(unLineKernel_RGB_First, 0, 0, _LINE_FIRST)
+_DEFINE_LINE_KERNEL(unLineKernel_RGB_Interior, 0, 0, _LINE_INTERIOR)
+_DEFINE_LINE_KERNEL(unLineKernel_RGB_HS_First, 0, 1, _LINE_FIRST)
+_DEFINE_LINE_KERNEL(unLineKernel_RGB_HS_Interior, 0, 1, _LINE_INTERIOR)
+_DEFINE_LINE_KERNEL(unLineKernel_R_First, 1, 0, _LINE_FIRST)
+_DEFINE_LINE_KERNEL(unLineKernel_R_Interior, 1, 0, _LINE_INTERIOR)
+_DEFINE_LINE_KERNEL(unLineKernel_R_HS_First, 1, 1, _LINE_FIRST)
+_DEFINE_LINE_KERNEL(unLineKernel_R_HS_Interior, 1, 1, _LINE_INTERIOR)
+_DEFINE_LINE_KERNEL(unLineKernel_G_First, 2, 0, _LINE_FIRST)
+_DEFINE_LINE_KERNEL(unLineKernel_G_Interior, 2, 0, _LINE_INTERIOR)
+_DEFINE_LINE_KERNEL(unLineKernel_G_HS_First, 2, 1, _LINE_FIRST)
+_DEFINE_LINE_KERNEL(unLineKernel_G_HS_Interior, 2, 1, _LINE_INTERIOR)
+_DEFINE_LINE_KERNEL(unLineKernel_B_First, 3, 0, _LINE_FIRST)
+_DEFINE_LINE_KERNEL(unLineKernel_B_Interior, 3, 0, _LINE_INTERIOR)
+_DEFINE_LINE_KERNEL(unLineKernel_B_HS_First, 3, 1, _LINE_FIRST)
+_DEFINE_LINE_KERNEL(unLineKernel_B_HS_Interior, 3, 1, _LINE_INTERIOR)
+
+const LINE_KERNEL gfptrLineKernel[4][2][2] = {	// Index = [luminance mode][saturation/hue][line class].
+	{{unLineKernel_RGB_First, unLineKernel_RGB_Interior}, {unLineKernel_RGB_HS_First, unLineKernel_RGB_HS_Interior}},
+	{{unLineKernel_R_First, unLineKernel_R_Interior}, {unLineKernel_R_HS_First, unLineKernel_R_HS_Interior}},
+	{{unLineKernel_G_First, unLineKernel_G_Interior}, {unLineKernel_G_HS_First, unLineKernel_G_HS_Interior}},
+	{{unLineKernel_B_First, unLineKernel_B_Interior}, {unLineKernel_B_HS_First, unLineKernel_B_HS_Interior}}};
+
+/// Register the pixel attributes needed by an image processing task, unAttributes is a combination 
+/// of the _CAMERA_ATT_XXX flags, 0 to cancel the subscription.  The camera driver combines the 
+/// subscriptions of all tasks at the start of each frame and skips the pre-processing stages which
+/// are not needed by any task.  The luminance is always computed.
+void CameraSubscribe(TASK_ATTRIBUTE *ptrTask, unsigned int unAttributes)
+{
+	if ((ptrTask->nID > 0) && (ptrTask->nID <= __MAXTASK))
+	{
+		gunCameraSubscription[ptrTask->nID] = unAttributes;
+	}
+}
+
+/// Combine the subscriptions of all tasks.
+unsigned int unGetFrameAttributes(void)
+{
+	int nIndex;
+	unsigned int unAttributes = _CAMERA_ATT_LUMINANCE;
+	
+	for (nIndex = 0; nIndex <= __MAXTASK; nIndex++)
+	{
+		unAttributes = unAttributes | gunCameraSubscription[nIndex];
+	}
+	if (unAttributes & _CAMERA_ATT_GRAD_DIR)		// The orientation is computed with the gradient.
+	{
+		unAttributes = unAttributes | _CAMERA_ATT_GRADIENT;
+	}
+	return unAttributes;
+}
+
+/// Set the analysis window of an image processing task, covering columns nStartx to nStartx+nWidth-1
+/// and rows nStarty to nStarty+nHeight-1.  Set nWidth or nHeight to 0 to remove the window.  The camera 
+/// driver only pre-processes the lines covered by the union of the windows of all tasks, the other
+/// lines of the frame buffer are not updated.  Within these lines only the luminance is computed outside
+/// the windows.  If no window is set, the whole frame is pre-processed.  The change takes effect at the
+/// next frame.
+void CameraSetWindow(TASK_ATTRIBUTE *ptrTask, int nStartx, int nStarty, int nWidth, int nHeight)
+{
+	CAMERA_WINDOW strcWindow = {0, 0, 0, 0};
+	CAMERA_WINDOW *ptrWindow;
+	
+	if ((ptrTask->nID > 0) && (ptrTask->nID <= __MAXTASK))
+	{
+		if ((nWidth > 0) && (nHeight > 0))
+		{
+			strcWindow.nStartx = Max(nStartx, 0);
+			strcWindow.nStarty = Max(nStarty, 0);
+			strcWindow.nStopx = Min(nStartx + nWidth, _IMAGE_HRESOLUTION);
+			strcWindow.nStopy = Min(nStarty + nHeight, _IMAGE_VRESOLUTION);
+		}
+		ptrWindow = &gstrcCameraWindow[ptrTask->nID];
+		if ((ptrWindow->nStartx != strcWindow.nStartx) || (ptrWindow->nStarty != strcWindow.nStarty) ||
+			(ptrWindow->nStopx != strcWindow.nStopx) || (ptrWindow->nStopy != strcWindow.nStopy))
+		{
+			*ptrWindow = strcWindow;
+			gnCameraWindowChanged = 1;				// Only rebuild the line table if the window is changed.
+		}
+	}
+}
+
+/// Build the line table from the union of the analysis windows.  The line above and below each window 
+/// is also pre-processed (luminance only) so that the Sobel gradient is valid for all lines of the window.
+/// With the luminance pyramid, these border lines are extended to multiples of 4 lines so that the
+/// pyramid lines covering the window are valid.
+/// The column range of each line is the span of all windows covering the line, rounded to even columns
+/// for the packed SIMD decoder: the start column is rounded down and the stop column up (limited to
+/// gnImageWidth, which is even).  unDecodeSegment() relies on this to read the pixel pairs from word
+/// aligned addresses.
+void BuildLineTable(void)
+{
+	int nIndex;
+	int nLine;
+	int nWindowCount = 0;
+	int nBorderStart, nBorderStop;
+	CAMERA_WINDOW *ptrWindow;
+	
+	for (nLine = 0; nLine < gnImageHeight; nLine++)
+	{
+		gun8LineType[nLine] = _LINE_SKIP;
+		gun16LineStartx[nLine] = gnImageWidth;
+		gun16LineStopx[nLine] = 0;
+	}
+	for (nIndex = 0; nIndex <= __MAXTASK; nIndex++)
+	{
+		ptrWindow = &gstrcCameraWindow[nIndex];
+		if ((ptrWindow->nStopx > ptrWindow->nStartx) && (ptrWindow->nStopy > ptrWindow->nStarty))
+		{
+			nWindowCount++;
+			nBorderStart = ptrWindow->nStarty - 1;
+			nBorderStop = ptrWindow->nStopy + 1;
+			#ifdef		__LUM_PYRAMID
+			nBorderStart = nBorderStart & ~0x3;		// Round down and up to multiples of 4 lines.
+			nBorderStop = (nBorderStop + 3) & ~0x3;
+			#endif
+			for (nLine = Max(nBorderStart, 0); nLine < Min(nBorderStop, gnImageHeight); nLine++)
+			{
+				if ((nLine >= ptrWindow->nStarty) && (nLine < ptrWindow->nStopy))
+				{
+					gun8LineType[nLine] = _LINE_WINDOW;
+					gun16LineStartx[nLine] = Min(gun16LineStartx[nLine], ptrWindow->nStartx & 0xFFFE);
+					gun16LineStopx[nLine] = Max(gun16LineStopx[nLine], Min((ptrWindow->nStopx + 1) & 0xFFFE, gnImageWidth));
+				}
+				else if (gun8LineType[nLine] == _LINE_SKIP)
+				{
+					gun8LineType[nLine] = _LINE_BORDER;
+				}
+			}
+		}
+	}
+	for (nLine = 0; nLine < gnImageHeight; nLine++)
+	{
+		if (nWindowCount == 0)						// No window, pre-process the whole frame.
+		{
+			gun8LineType[nLine] = _LINE_WINDOW;
+			gun16LineStartx[nLine] = 0;
+			gun16LineStopx[nLine] = gnImageWidth;
+		}
+		else if (gun8LineType[nLine] != _LINE_WINDOW)
+		{
+			gun16LineStartx[nLine] = 0;
+			gun16LineStopx[nLine] = 0;
+		}
+	}
+}
+
+/// Compute the luminance statistics of the frame from the histogram gunIHisto[] built by the line 
+/// kernels, unLumSum is the sum of luminance and unPixels the no. of pixels in the histogram.  All
+/// statistics are obtained in a single pass through the 128 histogram bins, the Otsu threshold uses
+/// the frame mean from unLumSum so that the between-class variance can be evaluated in the same pass.
+void ComputeFrameStatistics(unsigned int unLumSum, unsigned int unPixels)
+{
+	int nIndex;
+	unsigned int unCount;
+	unsigned int unCumulative = 0;				// No. of pixels with luminance <= nIndex.
+	unsigned int unLumCumulative = 0;			// Sum of luminance of these pixels.
+	uint64_t	ulnSquareSum = 0;				// Sum of luminance^2.
+	int64_t		lnDiff;
+	uint64_t	ulnVarBetween;
+	uint64_t	ulnVarBetweenMax = 0;
+	unsigned int unP05Count, unP50Count, unP95Count;
+	FRAME_STATISTICS *ptrStat = &gstrcFrameStat;
+	
+	ptrStat->unPixels = unPixels;
+	ptrStat->nMin = 0;
+	ptrStat->nMax = _STAT_NO_OF_BINS - 1;
+	ptrStat->nP05 = -1;
+	ptrStat->nP50 = -1;
+	ptrStat->nP95 = -1;
+	ptrStat->nOtsuThreshold = 0;
+	if (unPixels == 0)
+	{
+		ptrStat->unMean = 0;
+		ptrStat->unVariance = 0;
+		return;
+	}
+	unP05Count = (unPixels * 5 + 99) / 100;		// No. of pixels at or below each percentile.
+	unP50Count = (unPixels + 1) / 2;
+	unP95Count = (unPixels * 95 + 99) / 100;
+	nIndex = _STAT_NO_OF_BINS - 1;
+	while ((nIndex > 0) && (gunIHisto[nIndex] <= _STAT_NOISE_FLOOR))	// Maximum luminance, ignoring the 
+	{																	// levels with a few (noise) pixels only.
+		nIndex--;
+	}
+	ptrStat->nMax = nIndex;
+	ptrStat->nMin = -1;
+	for (nIndex = 0; nIndex < _STAT_NO_OF_BINS; nIndex++)
+	{
+		unCount = gunIHisto[nIndex];
+		if ((ptrStat->nMin < 0) && (unCount > _STAT_NOISE_FLOOR))		// Minimum luminance, ignoring noise.
+		{
+			ptrStat->nMin = nIndex;
+		}
+		unCumulative = unCumulative + unCount;
+		unLumCumulative = unLumCumulative + unCount * nIndex;
+		ulnSquareSum = ulnSquareSum + unCount * nIndex * nIndex;
+		ptrStat->un16CumHisto[nIndex] = unCumulative;
+		if ((ptrStat->nP05 < 0) && (unCumulative >= unP05Count))
+		{
+			ptrStat->nP05 = nIndex;
+		}
+		if ((ptrStat->nP50 < 0) && (unCumulative >= unP50Count))
+		{
+			ptrStat->nP50 = nIndex;
+		}
+		if ((ptrStat->nP95 < 0) && (unCumulative >= unP95Count))
+		{
+			ptrStat->nP95 = nIndex;
+		}
+		
+		// Otsu's method, threshold which maximizes the between-class variance:
+		// VarBetween = (Mean*w0 - Sum0)^2 / (w0*w1), where w0 and w1 are the no. of pixels in each class, 
+		// Sum0 is the sum of luminance of class 0 and Mean the frame mean.  Here Mean*w0 is scaled by 
+		// unPixels to keep the computation in integer.
+		if ((unCumulative > 0) && (unCumulative < unPixels))
+		{
+			lnDiff = ((int64_t) unLumSum * unCumulative - (int64_t) unPixels * unLumCumulative) / (int64_t) unPixels;
+			ulnVarBetween = (uint64_t) (lnDiff * lnDiff) / ((uint64_t) unCumulative * (unPixels - unCumulative));
+			if (ulnVarBetween > ulnVarBetweenMax)
+			{
+				ulnVarBetweenMax = ulnVarBetween;
+				ptrStat->nOtsuThreshold = nIndex;
+			}
+		}
+	}
+	if (ptrStat->nMin < 0)
+	{
+		ptrStat->nMin = 0;
+	}
+	ptrStat->unMean = unLumSum / unPixels;
+	ptrStat->unVariance = (unsigned int) ((ulnSquareSum * unPixels - (uint64_t) unLumSum * unLumSum) / ((uint64_t) unPixels * unPixels));
+}
+
+/// Return the slot of the frame pool to store the next frame, this is the oldest slot which is not 
+/// held by any image processing task and is not the newest complete frame.  Return -1 if all slots 
+/// are in use.
+int nGetFreeFrameSlot(void)
+{
+	int nSlot;
+	int nFreeSlot = -1;
+	
+	for (nSlot = 0; nSlot < _FRAME_POOL_SIZE; nSlot++)
+	{
+		if ((gnFrameSlotHold[nSlot] == 0) && (nSlot != gnFrameNewest))
+		{
+			if ((nFreeSlot < 0) || ((int)(gunFrameSlotSeq[nSlot] - gunFrameSlotSeq[nFreeSlot]) < 0))
+			{
+				nFreeSlot = nSlot;
+			}
+		}
+	}
+	return nFreeSlot;
+}
+
+/// Get the newest complete frame from the frame pool.  The frame is held, e.g. it will not be 
+/// overwritten by the camera driver, until CameraReleaseFrame() is called.  The sequence number 
+/// of the frame (value of gnFrameCounter when the frame is completed) is returned in *ptrunSeq if 
+/// ptrunSeq is not NULL.
+/// Return: Pointer to the frame buffer, or NULL if no frame has been captured yet.
+FRAME_BUFFER *ptrCameraAcquireFrame(unsigned int *ptrunSeq)
+{
+	if (gnFrameNewest < 0)
+	{
+		return NULL;
+	}
+	gnFrameSlotHold[gnFrameNewest]++;
+	if (ptrunSeq != NULL)
+	{
+		*ptrunSeq = gunFrameSlotSeq[gnFrameNewest];
+	}
+	return &gstrcFrameBuffer[gnFrameNewest];
+}
+
+#ifdef		__LUM_HISTORY
+/// Get the luminance plane of frame t-nAge from the luminance history ring, nAge = 0 is the newest 
+/// frame.  The tasks using this should subscribe to _CAMERA_ATT_HISTORY.  The plane is overwritten 
+/// after _LUM_HISTORY_SIZE-1-nAge new frames, check unFrame of the plane if it is kept for longer.
+/// Only the lines pre-processed by the camera driver are updated, see CameraSetWindow().
+/// Return: Pointer to the luminance plane, or NULL if nAge is out of range or the frame is not 
+/// captured yet.
+LUM_PLANE *ptrCameraGetLumHistory(int nAge)
+{
+	if ((nAge < 0) || (nAge > _LUM_HISTORY_SIZE - 2) || (nAge >= gnLumHistoryCount))
+	{
+		return NULL;
+	}
+	return &gstrcLumHistory[(gnLumHistoryNewest - nAge + _LUM_HISTORY_SIZE) % _LUM_HISTORY_SIZE];
+}
+#endif
+
+/// Return a frame obtained with ptrCameraAcquireFrame() to the frame pool.
+void CameraReleaseFrame(FRAME_BUFFER *ptrFrame)
+{
+	int nSlot;
+	
+	nSlot = ptrFrame - gstrcFrameBuffer;
+	if ((nSlot >= 0) && (nSlot < _FRAME_POOL_SIZE) && (gnFrameSlotHold[nSlot] > 0))
+	{
+		gnFrameSlotHold[nSlot]--;
+	}
+}
+
+/// Record the current system tick and cycle counter in a time stamp.
+void CameraTimestamp(FRAME_TIMESTAMP *ptrTime)
+{
+	ptrTime->unTick = gunClockTick;
+	ptrTime->unCycle = DWT->CYCCNT;
+}
+
+/// Return the time since a time stamp in microseconds.  The cycle counter is used for intervals
+/// shorter than 10 seconds, the system tick for longer intervals.
+unsigned int unCameraElapsedUS(const FRAME_TIMESTAMP *ptrTime)
+{
+	unsigned int unTicks = gunClockTick - ptrTime->unTick;
+	
+	if (unTicks < 10000000/__SYSTEMTICK_US)
+	{
+		return (DWT->CYCCNT - ptrTime->unCycle) / __FOSC_MHz;
+	}
+	return unTicks * __SYSTEMTICK_US;
+}
+
+
 
 ///
 /// Function name		: Proce_TCM8230_Driver
@@ -123,7 +1183,7 @@ __STATIC_FORCEINLINE uint16_t _REV16 (uint16_t op1)
 ///
 /// RTOS				: Ver 1 or above, round-robin scheduling.
 ///
-/// Global Variables    : gnFrameCounter
+/// Global Variables    : gnFrameCounter, gstrcFrameBuffer[], gunFrameDropped
 
 #ifdef __OS_VER			// Check RTOS version compatibility.
 #if __OS_VER < 1
@@ -145,20 +1205,39 @@ __STATIC_FORCEINLINE uint16_t _REV16 (uint16_t op1)
 /// PIOA peripheral.
 /// 3. DMA (Direct memory access) transfer is used to transfer the camera pixel data in the 
 /// SRAM of the micro-controller via SAMS70 extended DMA controller (XDMAC).  
-/// Here each pixel data is represented by unsigned 32 bits integer,
-/// in the 2D array gunImgAtt[][] or gunImgAtt2[][].  The global variables gnImageWidth and 
-/// gnImageHeight keep tracks of the width and height of each image frame.  The 2D arrays
-/// gunImgAtt[][] and gunImgAtt2[][] are the so-called Frame Buffers.  We have two frame buffers
-/// so that when one buffer is being filled up with new data, the data in the other buffer can
-/// by accessed by image processing algorithm. Thus this driver will fill up gunImgAtt[][]
-/// and gunImgAtt2[][] in an alternate fashion.
+/// The DMA transfers one line of pixels at a time into _CAMERA_LINE_BUFFERS line buffers used in
+/// rotation.  Once a line is received the DMA is re-started on the next line buffer before the line
+/// is pre-processed, so the next line never overwrites the line being pre-processed.  If the line
+/// pre-processing and the other tasks take longer than one line period, the start of the next line 
+/// is missed, gunLineOverrun is incremented and the frame is dropped.  gunCameraLineCyclesMax gives 
+/// the longest line pre-processing time of the last frame.  The parallel capture and DMA are accessed
+/// through the functions in Driver_Capture_HAL.h, there is also an implementation for the computer 
+/// which plays back BMP files, see MVM_Miscellaneous/Host.
+/// Here the attributes of each pixel are stored in the planes of the frame buffers gstrcFrameBuffer[],
+/// which form a frame pool of _FRAME_POOL_SIZE slots, see Driver_TCM8230.h.  The global variables 
+/// gnImageWidth and gnImageHeight keep tracks of the width and height of each image frame.  
+/// The image processing tasks get the newest complete frame with ptrCameraAcquireFrame() and return
+/// it with CameraReleaseFrame(), a slot is held (gnFrameSlotHold[]) in between.  At the start of each
+/// frame (state 9) this driver picks the oldest slot which is neither held nor the newest complete 
+/// frame with nGetFreeFrameSlot(), so a frame is never overwritten while it is in use.  State 10 fills
+/// up this slot (gnFrameWrite) line by line, and at the end of the frame state 11 stamps it with the frame 
+/// counter (gunFrameSlotSeq[]) and publishes it as the newest complete frame.  If there is no free slot
+/// (gnFrameWrite = -1) or a line is missed, the frame is dropped and gunFrameDropped is incremented.
 /// 4. The global variable gnFrameCounter keeps track of the number of frame captured since
 /// power on.  Other process can use this information to compare difference between frames.  
-/// While the flag gnValidFrameBuffer tells us which frame buffer can be access for image
-/// processing tasks.
+/// The image processing tasks register the pixel attributes they need with CameraSubscribe(), and 
+/// only these attributes are computed.  The processor cycles spent on pre-processing each frame is
+/// kept in gunCameraFrameCycles.
+/// The image processing tasks can also restrict the pre-processing to the region of the image they
+/// analyze with CameraSetWindow(), the lines outside all windows are skipped.
+/// When the histogram is subscribed, the luminance statistics of each frame (min, max, percentiles,
+/// Otsu threshold and variance) are published in gstrcFrameStat at the end of the frame.
+/// When __LUM_HISTORY is enabled and _CAMERA_ATT_HISTORY is subscribed, the luminance of each line is
+/// also copied to a ring of _LUM_HISTORY_SIZE planes, so that the tasks can look back at earlier 
+/// frames with ptrCameraGetLumHistory().
 /// 5. Pre-processing of the pixels color output to extract the Luminance, Contrast, Hue and 
-/// Saturation is performed here, and the result for each pixel is stored in gunImgAtt[x][y].
-/// Where the x and y index denotes the pixel's location in the frame.
+/// Saturation is performed here, and the result for each pixel is stored in the frame buffer planes,
+/// e.g. un8Lum[y][x].  Where the x and y index denotes the pixel's location in the frame.
 
 // User to edit these:
 #define     _CAMERA_I2C2_ADD        60      // Camera I2C slave address.
@@ -181,23 +1260,20 @@ void Proce_TCM8230_Driver(TASK_ATTRIBUTE *ptrTask)
 {
 	int nTemp; 
 	int nTemp2;
-	unsigned int unTemp;
 	static int nLineCounter = 0;
 	static int nCount = 0;
 	
 	// Variables associated with image pre-processing.
-	//int nR5, nB5;
-	int nR6, nG6, nB6;
-	int nLuminance;
-	int ncolindex;
-	int nHue;
-	unsigned int unSat;
-	unsigned int unMaxRGB, unMinRGB;
-	int nDeltaRGB;
-	int	nLuminance1, nLuminance2, nLuminance3, nLuminance4, nLuminance5, nLuminance6;
-	int nLuminance7, nLuminance8;
-	int	nLumGradx, nLumGrady, nLumGrad;
+	FRAME_BUFFER *ptrFrame;						// Frame buffer to update.
 	static unsigned int unLumCumulative; 
+	static unsigned int unLumPixels;			// No. of pixels in unLumCumulative.
+	static unsigned int unFrameAttributes;		// Pixel attributes to compute for current frame.
+	static unsigned int unFrameCycles;			// Processor cycles spent on pre-processing current frame.
+	static unsigned int unLineCyclesMax;		// Max. processor cycles spent on pre-processing a line in current frame.
+	unsigned int unCycleStart;
+	static int nLineBuffer;						// Line buffer being filled by the DMA.
+	static int nFrameOverrun;					// No. of line overruns in current frame.
+	uint16_t *ptrPixel;							// Line buffer to pre-process.
 
 
 	if (ptrTask->nTimer == 0)
@@ -224,66 +1300,17 @@ void Proce_TCM8230_Driver(TASK_ATTRIBUTE *ptrTask)
 				
 				PIN_CAMRESET_CLEAR;							// Assert camera RESET.	
 				
-				// --- The following initialization sequence for PIOA with DMA follows the recommendation of the datasheet ---
-				// Parallel Capture mode interrupt settings.
-				 PIOA->PIO_PCIDR = PIOA->PIO_PCIDR | PIO_PCISR_DRDY | PIO_PCIDR_ENDRX | PIO_PCIDR_DRDY | PIO_PCIDR_RXBUFF | PIO_PCIDR_OVRE; // Disable all PCM interrupts.
-				
-				// Setup XDMAC Channel to handle transfer of data from parallel capture buffer to memory.
-				// Channel allocation: 0.
-				// Source: PIOA (XDMAC_CC.PERID = 34).
-				// Destination: SRAM.
-				// Transfer mode (TYPE): Single block with single microblock. (BLEN = 0)
-				// Chunk size (CSIZE): 1 chunks
-				// Memory burst size (MBSIZE): 4
-				// Channel data width (DWIDTH): halfword.
-				// Source address mode (SAM): fixed.
-				// Destination addres mode (DAM): increment.
-				//
-				// For peripheral to memory transfer, each microblock transfer is further divided into 'Chunks'.
-				// The datasheet did not explain clearly the size of each chunk, I would understand it as the smallest unit of data transfer 
-				// from the peripheral as set in DWIDTH in XDMAC_CC register i.e. if the smallest data unit for the peripheral is byte, 
-				// then 1 chunk = 1 byte.  If the smallest data unit from the peripheral is a 16-bits half word, then 1 chunk = 1 half word. 
-				// Here we will use maximum of 16 chunks per burst.  Note that the
-				// number of burst should be an integral number of the microblock length.
-				// 
-				
-				nTemp = XDMAC->XDMAC_CHID[0].XDMAC_CIS;			// Clear channel 0 interrupt status register.  This is a read-only register, reading it will clear all
-																// interrupt flags.
-				XDMAC->XDMAC_CHID[0].XDMAC_CSA = (uint32_t)&(PIOA->PIO_PCRHR);	// Set source start address.
-				XDMAC->XDMAC_CHID[0].XDMAC_CDA = (uint32_t) gun16Pixel;	// Set destination start address.
-				XDMAC->XDMAC_CHID[0].XDMAC_CUBC = XDMAC_CUBC_UBLEN(gnImageWidth); // Set the number of data chunks in a microblock.
-				XDMAC->XDMAC_CHID[0].XDMAC_CC = XDMAC_CC_TYPE_PER_TRAN| 
-												XDMAC_CC_CSIZE_CHK_1| 
-												XDMAC_CC_MBSIZE_FOUR| 
-												XDMAC_CC_DWIDTH_HALFWORD|
-												XDMAC_CC_SAM_FIXED_AM| 
-												XDMAC_CC_DAM_INCREMENTED_AM|
-												XDMAC_CC_SIF_AHB_IF1|		// IF1 is Master AHB 5, connected to peripheral bus.
-												XDMAC_CC_DIF_AHB_IF0|		// IF0 is Master AHB 4, connected to internal SRAM.
-												XDMAC_CC_DSYNC_PER2MEM|
-												XDMAC_CC_SWREQ_HWR_CONNECTED|
-												XDMAC_CC_PERID(34); 
-				
-				XDMAC->XDMAC_CHID[0].XDMAC_CNDC = 0;		// Next descriptor control register.
-				XDMAC->XDMAC_CHID[0].XDMAC_CBC = 0;			// Block control register.
-				XDMAC->XDMAC_CHID[0].XDMAC_CDS_MSP = 0;		// Data stride memory set pattern register.
-				XDMAC->XDMAC_CHID[0].XDMAC_CSUS = 0;		// Source microblock stride register.
-				XDMAC->XDMAC_CHID[0].XDMAC_CDUS = 0;		// Destination microblock stride register.		
-							
-				// Enable parallel Capture mode of PIOA.
-				// Note: 26 Nov 2015, the following sequence needs to be followed (from datasheet), setting of PCEN flag
-				// should be the last.  Once PCEN is set, all the associated pins will automatically become input pins.
-				// Note that upon power up, by default all pins are set to output, so momentarily there can be a high current
-				// drawn from the chip.
-				
-				PIOA->PIO_PCMR = PIOA->PIO_PCMR | PIO_PCMR_DSIZE_HALFWORD;				// Data size is half word (16 bits).
-				PIOA->PIO_PCMR = PIOA->PIO_PCMR & ~PIO_PCMR_ALWYS & ~PIO_PCMR_HALFS;	// Sample all data, sample the data only when both
-																						// PIODCEN1 or PIODCEN2 are HIGH.	
-				PIOA->PIO_PCMR = PIOA->PIO_PCMR | PIO_PCMR_PCEN;						// Enable Parallel Capture module.  All related pins
-																						// will be automatically set to input.
-																									
+				CaptureHALInit(gun16PixelLine[0], gnImageWidth);							// Setup parallel capture and DMA, see Driver_Capture_SAMS70.c.
+				gunLineOverrun = 0;
 				gnFrameCounter = 0;														// Clear frame counter.	
-				gnValidFrameBuffer = 0;													// Initially set to 2.		
+				for (nTemp = 0; nTemp < _FRAME_POOL_SIZE; nTemp++)						// Empty the frame pool.
+				{
+					gnFrameSlotHold[nTemp] = 0;
+				}
+				gnFrameNewest = -1;
+				CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;							// Enable the DWT cycle counter to measure the
+				DWT->LAR = 0xC5ACCE55;													// pre-processing time of each frame.
+				DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 				OSSetTaskContext(ptrTask, 1, 500*__NUM_SYSTEMTICK_MSEC);				// Next state = 1, timer = 500 msec.	A long delay for the voltage in
 																						// the circuit to settle down.													
 			break;
@@ -346,82 +1373,37 @@ void Proce_TCM8230_Driver(TASK_ATTRIBUTE *ptrTask)
 				}
 				break;
 						
-			case 5: // State 5 - Set synchronization code, vertical and horizontal timing format, and picture mode.
-			//nWriteSCCB(0x1E, 0x6C);                 // DMASK = 0x01.
-			// HSYNCSEL = 1.
-			// CODESW = 1 (Output synchronization code).
-			// CODESEL = 0 (Original synchronization code format).
-			// TESPIC = 1 (Enable test picture mode).
-			// PICSEL = 0x00 (Test picture output is color bar).
-			
-			//nWriteSCCB(0x1E, 0x68);                 // DMASK = 0x01.
-			// HSYNCSEL = 1.
-			// CODESW = 1 (Output synchronization code).
-			// CODESEL = 0 (Original synchronization code format).
-			// TESPIC = 0 (Disable test picture mode).
-			// PICSEL = 0x00 (Test picture output is color bar).
-			//OSSetTaskContext(ptrTask, 3, 20);
-				if (gI2CStat.bI2CBusy == 0)				// Make sure I2C module is not being used.
-				{
-					gbytI2CByteCount = 1;				// Indicate no. of bytes to transmit.
-					gbytI2CRegAdd = 0x1E;				// Start address of register.
-					//gbytI2CTXbuf[0] = 0x68;				// Data, normal operation.
-					gbytI2CTXbuf[0] = 0x6C;				// Data, test mode, output color bar.
-					//gbytI2CTXbuf[0] = 0x6D;				// Data, test mode, output color ramp 1.
-					//gbytI2CTXbuf[0] = 0x6E;				// Data, test mode, output color ramp 2.
-					gbytI2CSlaveAdd =  _CAMERA_I2C2_ADD;	// Camera I2C slave address.
-					gI2CStat.bSend = 1;
-					OSSetTaskContext(ptrTask, 6, 5*__NUM_SYSTEMTICK_MSEC);      // Next state = 6, timer = 5 msec.
-				}
-				else
-				{
-					OSSetTaskContext(ptrTask, 5, 1);		// Next state = 5, timer = 1.
-				}
+			case 5: // State 5 - Load the camera initialization table (synchronization code, picture mode, frame rate,
+					//           output format and frame resolution) into the register write list, see
+					//           Driver_TCM8230_Regs.c.  The camera is turned on by the last entry.
+				CameraLoadInitTable();
+				OSSetTaskContext(ptrTask, 6, 1);			// Next state = 6, timer = 1.
 			break;
 			
-			case 6: // State 6 - Set AC frequency (ACF) of fluorescent light to 50 Hz for Malaysia.  Actually this is not important if the
-					// ACFDET bit is set to AUTO (0).
-					// Also maximum frame rate is set to 30 fps.
-					// DCLK polarity = Normal.
-				if (gI2CStat.bI2CBusy == 0)				// Make sure I2C module is not being used.
+			case 6: // State 6 - Send the register write list to the camera, back to back.  Writes to consecutive
+					//           registers are combined into one I2C transaction as the camera auto-increments the
+					//           register address.  This state is also entered at the end of a frame when 
+					//           nCameraWriteReg() has queued new register values.
+				if ((gI2CStat.bI2CBusy == 0) && (gI2CStat.bSend == 0))	// Make sure I2C module is not being used.
 				{
-					gbytI2CByteCount = 1;				// Indicate no. of bytes to transmit.
-					gbytI2CRegAdd = 0x02;				// Start address of register.
-					gbytI2CTXbuf[0] = 0x00;				// Data.  Max frame rate is 30 fps.
-					//gbytI2CTXbuf[0] = 0x80;				// Data.  Max frame rate is 15 fps.
-					gbytI2CSlaveAdd =  _CAMERA_I2C2_ADD;	// Camera I2C slave address.
-					gI2CStat.bSend = 1;
-					OSSetTaskContext(ptrTask, 7, 5*__NUM_SYSTEMTICK_MSEC);      // Next state = 7, timer = 5 msec.
+					nTemp = nCameraNextBurst(&gbytI2CRegAdd, gbytI2CTXbuf);
+					if (nTemp > 0)
+					{
+						gbytI2CByteCount = nTemp;			// Indicate no. of bytes to transmit.
+						gbytI2CSlaveAdd =  _CAMERA_I2C2_ADD;	// Camera I2C slave address.
+						gI2CStat.bSend = 1;
+						OSSetTaskContext(ptrTask, 6, 1);	// Next state = 6, timer = 1.
+					}
+					else									// Write list is empty and the last transaction is complete.
+					{
+						OSSetTaskContext(ptrTask, 8, 1);	// Next state = 8, timer = 1.
+					}
 				}
 				else
 				{
 					OSSetTaskContext(ptrTask, 6, 1);		// Next state = 6, timer = 1.
 				}
 			break;
-
-			case 7: // State 7 - Turn on camera and set output format and frame resolution.	
-					// 28 Jan 2016: This step should be done last.  After the camera is turned ON, the signal lines
-					// DCLK, HSYNC, VSYNC will become active.	
-				// Turn on camera.
-				// Enable D0-D7 outputs.
-				// RGB565 format, color.
-				if (gI2CStat.bI2CBusy == 0)				// Make sure I2C module is not being used.
-				{
-				     gbytI2CByteCount = 1;				// Indicate no. of bytes to transmit.
-				     gbytI2CRegAdd = 0x03;				// Start address of register.
-				     gbytI2CTXbuf[0] = 0x0E;			// Data, QQVGA(f).
-					 //gbytI2CTXbuf[0] = 0x12;			// Data, QQVGA(z).
-					 //gbytI2CTXbuf[0] = 0x22;			// Data, subQCIF(f).
-					 //gbytI2CTXbuf[0] = 0x26;			// Data, subQCIF(z).
-				     gbytI2CSlaveAdd =  _CAMERA_I2C2_ADD;	// Camera I2C slave address.
-				     gI2CStat.bSend = 1;
-					 OSSetTaskContext(ptrTask, 8, 5*__NUM_SYSTEMTICK_MSEC);      // Yes, next state = 8, timer = 5 msec. 
-				}		
-				else                                         // I2C still busy.     
-				{
-					OSSetTaskContext(ptrTask, 7, 1);		// Next state = 7, timer = 1.
-				}
-			break;
 			
 			case 8: // State 8 - Wait for idle condition, this is signified by:
 					//           VSync (or VD) = 'H' (PA14)
@@ -430,9 +1412,13 @@ void Proce_TCM8230_Driver(TASK_ATTRIBUTE *ptrTask)
 					//			 we enable the PDC.
 				// Check pin PA14 (PIODCEN1) and PA21 (PIODCEN2) status.
 				
-				gnCameraReady = _CAMERA_READY;				// Indicates camera module is ready.
+				if (gnCameraReady != _CAMERA_READY)
+				{
+					gnCameraReady = _CAMERA_READY;			// Indicates camera module is ready.
+					OSSignalEvent(__EVENT_CAMERA_READY);	// Wake up the tasks waiting for the camera.
+				}
 				
-				if (((PIOA->PIO_PDSR & PIO_PDSR_P14) > 0) && ((PIOA->PIO_PDSR & PIO_PDSR_P21) == 0))
+				if (nCaptureHALIdle() == 1)
 				{	// Idle condition
 					
 					//nTemp = XDMAC->XDMAC_CHID[0].XDMAC_CIS;			// Clear channel 0 interrupt status register.  This is a read-only register, reading it will clear all
@@ -454,18 +1440,39 @@ void Proce_TCM8230_Driver(TASK_ATTRIBUTE *ptrTask)
 					// transfer Parallel Capture data to memory.
 				
 				// Check pin PA14 status (PIODCEN1), Vsync.
-				if ((PIOA->PIO_PDSR & PIO_PDSR_P14) == 0) 
+				if (nCaptureHALStartOfFrame() == 1) 
 				{	// Low.			
 
 					//PIN_FLAG1_SET;									// Set indicator flag.
 					
 					// Initialize XDMAC for PIOA receive operation.	
-					// Note: Since this is the 1st pixel line, no need to concern about DCache coherency with SRAM data.
-					nTemp = XDMAC->XDMAC_CHID[0].XDMAC_CIS;			// Clear channel 0 interrupt status register.  This is a read-only register, reading it will clear all
-					XDMAC->XDMAC_CHID[0].XDMAC_CDA = (uint32_t) gun16Pixel;	// Set destination start address.	
-					XDMAC->XDMAC_GE = XDMAC_GE_EN0;					// Enable XDMAC Channel 0 (Flag ST0 in XDMAC_GS will be set by hardware).							
+					nLineBuffer = 0;
+					CaptureHALArmLine(gun16PixelLine[0]);
+					nTemp = nCaptureHALOverrun();					// Clear overrun flag from previous frame.
+					nFrameOverrun = 0;
+					unLineCyclesMax = 0;
 
 					nLineCounter = 0;								// Reset line counter.
+					gnFrameWrite = nGetFreeFrameSlot();				// Select the slot for the new frame.
+					if (gnFrameWrite >= 0)
+					{
+						CameraTimestamp(&gstrcFrameBuffer[gnFrameWrite].strcCaptureStart);
+					}
+					unFrameAttributes = unGetFrameAttributes();		// Pixel attributes needed by the image processing tasks.
+					#ifdef		__LUM_HISTORY
+					gnLumHistoryWrite = (gnLumHistoryNewest + 1) % _LUM_HISTORY_SIZE;	// Oldest plane of the history ring.
+					#endif
+					unFrameCycles = 0;
+					gunMaskThresholdFrame = gunMaskThreshold;
+					if (gunMaskThresholdFrame == 0)
+					{
+						gunMaskThresholdFrame = gunAverageLuminance;
+					}
+					if (gnCameraWindowChanged == 1)					// Update the line table if the analysis windows are changed.
+					{
+						BuildLineTable();
+						gnCameraWindowChanged = 0;
+					}
 					for (nTemp = 0; nTemp < 128; nTemp++)			// Clear the luminance histogram array
 					{												// at the start of each new frame.
 						gunIHisto[nTemp] = 0;
@@ -480,282 +1487,77 @@ void Proce_TCM8230_Driver(TASK_ATTRIBUTE *ptrTask)
 
 			case 10: // State 10 - Wait until DMA transfer of 1 line of pixel data is complete.	
 				//PIN_FLAG4_SET;									
-				if ((XDMAC->XDMAC_GS & XDMAC_GS_ST0_Msk) == 0)		// The flag ST0 in XDMAC_GS is cleared when the transfer is complete,
-																	// indicating the pixel line buffer is full.
+				if (nCaptureHALLineDone() == 1)						// DMA transfer is complete, indicating the pixel line buffer
+																	// is full.
 				{	
 					//PIOA->PIO_ODSR |= PIO_ODSR_P27;					// Set task indicator flag.
 																	// Pixel line buffer is full.											
 					nLineCounter++;									// Increment row counter.
+					#ifdef		__LINE_TIMESTAMP
+					if (gnFrameWrite >= 0)
+					{
+						ptrFrame = &gstrcFrameBuffer[gnFrameWrite];
+						ptrFrame->unLineCycle[nLineCounter - 1] = DWT->CYCCNT - ptrFrame->strcCaptureStart.unCycle;
+					}
+					#endif
 					
-					// Initialize XDMAC PIOA receive operation.
-					SCB_CleanDCache();								// According to Atmel's AT17417 (Usage of XDMAC on SAMS/SAME/SAMV), to
-																	// prevent memory coherency issue, we should clean data cache first before
-																	// enabling DMA, then we should invalidate data cache after DMA is enabled.
-																	// This is especially true when more than 1 masters is accessing the SRAM, here
-																	// it is the XDMAC master and Cortex M7 master accessing SRAM simultaneously.
-																	// Assuming Write-Back with Read and Write-Allocate (WB-RWA) cache policy:
-																	// Cleaning the DCache writes the cache line back to SRAM.
-																	// Invalidating the DCache forces subsequent read to copy the data from SRAM
-																	// to the cache.
-																	// Reference: TB3195, "Managing cache coherency on Cortex M7 based MCUs", Microchip Technology 2018.
-																	
-					nTemp = XDMAC->XDMAC_CHID[0].XDMAC_CIS;			// Clear channel 0 interrupt status register.  This is a read-only register, reading it will clear all
-																	// interrupt flags.
-					XDMAC->XDMAC_CHID[0].XDMAC_CDA = (uint32_t) gun16Pixel;	// Set destination start address.
-					XDMAC->XDMAC_GE = XDMAC_GE_EN0;					// Enable XDMAC Channel 0 (Flag ST0 in XDMAC_GS will be set by hardware).
-					SCB_InvalidateDCache();							// Mark the data cache as invalid. Subsequent read from DCache forces data to be copied from SRAM to
-																	// the cache.  This is to be used after XDMAC updates the SRAM without the knowledge of the CPU's cache
-																	// controller.
+					nTemp = nLineBuffer;							// Line buffer just filled up.
+					nLineBuffer++;									// Start the DMA transfer of the next line into the next
+					if (nLineBuffer == _CAMERA_LINE_BUFFERS)		// line buffer before pre-processing this line.
+					{
+						nLineBuffer = 0;
+					}
+					CaptureHALArmLine(gun16PixelLine[nLineBuffer]);
+					ptrPixel = gun16PixelLine[nTemp];
+					if (nCaptureHALOverrun() == 1)					// Check if pixel data is lost, e.g. the next line started
+					{												// before the DMA is enabled.
+						gunLineOverrun++;
+						nFrameOverrun++;
+					}
 					
 					// --- Pre-processing one line of image data here ---
-					// Extract intensity.					
-					for (ncolindex = 0; ncolindex < gnImageWidth; ncolindex++)
-					{				
-						// --- Compute the 8-bits grey scale or intensity value of each pixel and
-						// update grey scale histogram ---
-						//nTemp2 = gun16Pixel[ncolindex];		// First get the 16-bits pixel word from line buffer.
-						
-						// Assume data read into parallel bus by ARM Cortex M7 is: [Byte0][Byte1]
-						// nTemp = (nTemp2 << 8) & 0xFF00;		// Swap the position of lower and upper 8 bits!
-						// nTemp2 = (nTemp2 >> 8) & 0xFF;		// This is due to the way the PDC store the pixel data.  
-															    // 14 Jan 2016: The upper 16 bits may not be 0! Thus need
-															    // to mask off. 
-						// nTemp = nTemp + nTemp2;				// Reform the 16-bits pixel data, in RGB565 format.
-
-						// The data read into parallel bus by ARM Cortex M7 is: [Byte0][Byte1], e.g. in big endian format.
-						// However, the correct order should be small endian, so we need to swap the bytes order to obtain
-						// [Byte1][Byte0].
-						unTemp = __REV16(gun16Pixel[ncolindex]);	// Swap the position of lower and upper 8 bits!
-																	// The original method achieve this using C routines as
-																	// shown above, but using inline assembly instruction 
-																	// is more efficient.
-
-						nR6 = (unTemp >> 10) & 0x3E;				// Form the 6 bits R component.
-						nG6 = (unTemp >> 5) & 0x3F;					// Get the 6 bits G component.															
-						nB6 = (unTemp & 0x01F)<<1;					// For the 6 bits B component. 
-																							
-						// --- 6 Jan 2015 ---
-						// Here we approximate the luminance I (or Y) as:
-						// I = 0.250R + 0.625G + 0.125B = (2R + 5G + B)/8
-						// where R, G and B ranges from 0 to 255.
-						// or I = (2*R + 5*G + B)>>3 for integer variables R, G, B.
-						// This avoids multiplication with real number, hence speeding up the
-						// computation, though with the increase in blue and decrease
-						// in green components intensities, we would get a slightly darker
-						// gray scale image.
-						
-						//	nLuminance = (2*(nR5<<3) + 5*(nG6<<2) + (nB5<<3))>>3;
-						
-						// Alternatively since actual values for R, G and B are 5, 6 and 5 bits respectively,
-						// we can normalize R and B to 6 bits by shifting, then convert to gray scale as:
-						//	nLuminance = (2*(nR5<<1) + 5*(nG6) + (nB5<<1))>>2;
-						
-						// Or more efficient alternative, with no multiplication:
-						//	nLuminance = ((nR5<<2) + (nG6<<2) + (nB5<<1) + nG6)>>2;
-						// This will result in gray scale value from 0 to 127, occupying 7 bits.
-						
-						if (gnLuminanceMode == 0)
-						{	
-							//nLuminance = ((nR5<<2) + (nG6<<2) + (nB5<<1) + nG6)>>2; // 7-bits luminance from RGB components.
-							nLuminance = ((nR6<<1) + (nG6<<2) + nB6 + nG6)>>2; // 7-bits luminance from RGB components.
-						}
-						else if (gnLuminanceMode == 1) 
+					// Select the line kernel once for the whole line.
+					if ((gnFrameWrite >= 0) && (gun8LineType[nLineCounter - 1] != _LINE_SKIP))	// Skip if the frame is dropped or the 
+					{																			// line is not in any analysis window.
+						unCycleStart = DWT->CYCCNT;
+						PROFILE_BEGIN(_PROF_CAM_LINE);
+						ptrFrame = &gstrcFrameBuffer[gnFrameWrite];
+						nTemp2 = gnLuminanceMode;					// Luminance mode 3 and above uses B component.
+						if ((nTemp2 < 0) || (nTemp2 > 3))
 						{
-							//nLuminance = nR5<<2;	// 7-bits luminance from only 5-bits Red component.
-							nLuminance = nR6<<1;	// 7-bits luminance from only 6-bits Red component.
+							nTemp2 = 3;
 						}
-						else if (gnLuminanceMode == 2)
-						{
-							nLuminance = nG6<<1;	// 7-bits luminance from only 6-bits Green component.					
+						if ((nLineCounter > 2) && (unFrameAttributes & _CAMERA_ATT_GRADIENT) && (gun8LineType[nLineCounter - 2] == _LINE_WINDOW))
+						{											// Sobel window filled up and previous line needs the gradient, see the line kernels.
+							nTemp = _LINE_INTERIOR;
 						}
 						else
 						{
-							//nLuminance = nB5<<2;	// 7-bits luminance from only 5-bits Blue component.
-							nLuminance = nB6<<1;	// 7-bits luminance from only 6-bits Blue component.
-						}				
-						
-						unLumCumulative = unLumCumulative + nLuminance;							// Update the sum of luminance for all pixels in the frame.
-						
-						gunIHisto[nLuminance]++;												// Update the intensity histogram.
-						
-						
-						// Optional - Reduce the luminance to black and white.					
-						//nLumReference = 100;									// Agreed luminance for White.
-						//if (nLuminance < (gunAverageLuminance))
-						//{
-						//	nLuminance = 0;
-						//}
-						//else 
-						//{
-						//	nLuminance = 100;
-						//}
-						//											
-
-
-						// --- Compute the saturation level ---
-						unMaxRGB = Max(nR6, Max(nG6, nB6));     // Find the maximum of R, G or B component
-						unMinRGB = Min(nR6, Min(nG6, nB6));     // Find the minimum of R, G or B components.
-						nDeltaRGB = unMaxRGB - unMinRGB;
-						unSat = nDeltaRGB;                         
-						// Note: Here we define the saturation as the difference between the maximum and minimum RGB values.
-						// A more proper term is called Chroma (as per Wikipedia article).
-						// In normal usage this value needs to be normalized with respect to maximum RGB value so that
-						// saturation is between 0.0 to 1.0.  Here to speed up computation we avoid using floating point
-						// variables. Thus the saturation is 6 bits since the color components are 6 bits, from 0 to 63.
-
-						// --- Compute the hue ---
-						// When saturation is too low, the color is near gray scale, and hue value is not accurate.
-						// Similarly when the light is too bright, the difference between color components may not be large
-						// enough to work out the hue, and hue is also not accurate.  
-						// From color theory (e.g. see Digital Image Processing by Gonzales and Woods, 2018), the minimum 
-						// RGB component intensity corresponds to the white level intensity.  Thus the difference
-						// between maximum RGB component and white level is an indication of the saturation level.
-						// This difference needs to be sufficiently large for reliable hue computation.
-						// For 6 bits RGB components, the maximum value of recognition, we arbitrary sets this to at least 
-						// 10% of the maximum RGB component. For 6 bits RGB color (as in RGB565 format) components, max = 63
-						// and min = 0.  Thus maximum difference is 63.  10% of this is 6.30. We then experiment with
-						// thresholds of 2 to 7 and select the best in terms of sensitivity and accuracy for the camera.
-						// Once we identified the condition where hue calculation is no valid, we need to distinguish 
-						// between too bright and too dark/grayscale conditions.  For these two scenarios, we analyze the maximum
-						// RGB value.  From experiment, we set the threshold at 30% or roughly 20.  Thus if 
-						// saturation level is too low, we check the maximum RGB level.  If this is <= 20, then it is
-						// 'No hue' due to low light condition.  Else it is 'No hue' due to too bright condition.
-						
-						if (nDeltaRGB < 2)              // Check if it is possible to make out the hue. 
-						{	
-														
-							//if (unMaxRGB < 12)			// Distinguish between too bright or too dark/grayscale conditions.	Using
-							//{							// maximum RGB criteria.
-							//	nHue = _NO_HUE_DARK; 
-							//} 
-							//else
-							//{
-							//	nHue = _NO_HUE_BRIGHT;	
-							//} 
-							
-							if(nLuminance < 60)			// Using luminance criteria.
-							{
-								nHue = _NO_HUE_DARK;
-							}
-							else
-							{
-								nHue = _NO_HUE_BRIGHT;
-							}
+							nTemp = _LINE_FIRST;
 						}
-						else   // Computation of hue, here I am using the hexagonal projection method for HSV color space, 
-								// as described in Wikipedia. https://en.wikipedia.org/wiki/HSL_and_HSV
-							   // This is easier than circular projection which require arc cosine function.
+						unLumCumulative = unLumCumulative + (*gfptrLineKernel[nTemp2][(unFrameAttributes & _CAMERA_ATT_HUESAT) ? 1 : 0][nTemp])(ptrFrame, ptrPixel, nLineCounter - 1, unFrameAttributes);	// Row 0 to row gnImageHeight-1.
+						unLumPixels = unLumPixels + gnImageWidth;
+						PROFILE_END(_PROF_CAM_LINE);
+						unCycleStart = DWT->CYCCNT - unCycleStart;
+						unFrameCycles = unFrameCycles + unCycleStart;
+						if (unCycleStart > unLineCyclesMax)
 						{
-							if (nR6 == unMaxRGB)          // nR6 is maximum. Note: since we are working with integers,
-							{                                          // be aware that when we perform integer division,
-								nHue = (60*(nG6 - nB6))/nDeltaRGB;   // the remainder will be discarded.
-							}
-							else if (nG6 == unMaxRGB)     // nG6 is maximum.
-							{
-								nHue = 120 + (60*(nB6 - nR6))/nDeltaRGB;
-							}
-							else if (nB6 == unMaxRGB)     // nB6 is maximum.
-							{
-								nHue = 240 + (60*(nR6 - nG6))/nDeltaRGB;
-							}
-		                 
-							if (nHue < 0)
-							{
-								nHue = nHue + 360;
-							}
+							unLineCyclesMax = unCycleStart;
 						}
-						
-						/* Temporay disable the Sobel Kernel operation.
-						// Computing the luminance gradient using Sobel's Kernel.
-						if ((ncolindex > 1) && (nLineCounter > 1))						// See notes on the derivation of this range.
-						{
-							// See notes. For 1st column of interest we need to read all 8 adjacent pixel luminance to compute the 
-							// gradients along vertical and horizontal axis.  For subsequent columns we only need to read in the 
-							// luminance values for 4 adjacent pixels.
-							//  |  L1 L7 L2  ---> Columns
-							//  |  L3 G  L4
-							// \|/ L5 L8 L6   Where L6 = Current pixel under process, G = pixel whose gradient we are computing.
-							//  Rows
-							if (ncolindex == 2)
-							{
-								nLuminance1 = gunImgAtt[ncolindex-2][nLineCounter-2] & _LUMINANCE_MASK;
-								nLuminance5 = gunImgAtt[ncolindex-2][nLineCounter] & _LUMINANCE_MASK;
-								nLuminance7 = gunImgAtt[ncolindex-1][nLineCounter-2] & _LUMINANCE_MASK;
-								nLuminance8 = gunImgAtt[ncolindex-1][nLineCounter] & _LUMINANCE_MASK;								
-							}
-															
-							nLuminance2 = gunImgAtt[ncolindex][nLineCounter-2] & _LUMINANCE_MASK;	
-							nLuminance3 = gunImgAtt[ncolindex-2][nLineCounter-1] & _LUMINANCE_MASK;
-							nLuminance4 = gunImgAtt[ncolindex][nLineCounter-1] & _LUMINANCE_MASK;							
-							//nLuminance6 = gunImgAtt[ncolindex][nLineCounter] & _LUMINANCE_MASK;	// This is the same as nLuminance.					
-							nLuminance6 = nLuminance;	
-					
-							
-							// Calculate x gradient											
-							nLumGradx = nLuminance2  + nLuminance6 - nLuminance1 - nLuminance5;
-							nLumGradx = nLumGradx + ((nLuminance4 - nLuminance3) << 1);
-							// Calculate y gradient
-							nLumGrady = nLuminance5  + nLuminance6 - nLuminance1 - nLuminance2;
-							nLumGrady = nLumGradx + ((nLuminance8 - nLuminance7) << 1);
-
-							// Shift samples to obtain current adjacent luminance values.  This is faster than reading the values from 
-							// a 2D array and apply masking to extract the luminance.
-							nLuminance1 = nLuminance7;
-							nLuminance5 = nLuminance8;
-							nLuminance7 = nLuminance2;
-							nLuminance8 = nLuminance6;
-							
-							if (nLumGradx < 0)		// Only magnitude is required.
-							{
-								nLumGradx = -nLumGradx;
-							}
-							if (nLumGrady < 0)		// Only magnitude is required.
-							{
-								nLumGrady = -nLumGrady;
-							}
-																// Calculate the magnitude of the luminance gradient.
-							nLumGrad = nLumGradx + nLumGrady;	// It should be nLumGrad = sqrt(nLumGradx^2 + nLumGrady^2)
-																// Here we the approximation nLumGrad = |nLumGradx| + |nLumGrady|
-
-							if (nLumGrad > 127)		// Limit the maximum value to 127 (7 bits only).  Bit8 is not used for
-							{						// luminance indication.
-								nLumGrad = 127;
-							}
-							if (nLumGrad < 20)		// To remove gradient noise.  Can reduce to 10 if the camera quality is good.
-							{
-								nLumGrad = 0;
-							}
-						}
-						else
-						{
-							nLumGrad = 0;
-						} 
-						*/
-						
-						// Update the pixel attributes.
-														
-						// Consolidate all the pixel attribute into the attribute array.
-						if ((gnFrameCounter & 0x00000001) == 1)			// If frame number is odd.
-						{												// processes.  So we should update gunImgAtt2[].
-							gunImgAtt2[ncolindex][nLineCounter] = nLuminance | (unSat << _SAT_SHIFT) | (nHue << _HUE_SHIFT);
-							gunImgAtt2[ncolindex-1][nLineCounter-1] = gunImgAtt2[ncolindex-1][nLineCounter-1] | (nLumGrad << _GRAD_SHIFT);					
-						}
-						else                                            // Frame number is even.
-						{	
-																		// Data in gunImgAtt2[] is being accessed by other processes.																		
-							gunImgAtt[ncolindex][nLineCounter] = nLuminance | (unSat << _SAT_SHIFT) | (nHue << _HUE_SHIFT);
-							gunImgAtt[ncolindex-1][nLineCounter-1] = gunImgAtt[ncolindex-1][nLineCounter-1] | (nLumGrad << _GRAD_SHIFT);
-						}
-
-					} // for (ncolindex = 0; ncolindex < gnImageWidth; ncolindex++)				
-					
+					}
+					#if defined(__INTEGRAL_IMAGE) || defined(__INTEGRAL_MASK)
+					else if ((gnFrameWrite >= 0) && (unFrameAttributes & (_CAMERA_ATT_INTEGRAL | _CAMERA_ATT_INTEGRAL_MASK)))
+					{												// The integral images still need to be propagated through the 
+						IntegralImageLine(&gstrcFrameBuffer[gnFrameWrite], nLineCounter - 1, unFrameAttributes, 1);	// skipped line.
+					}
+					#endif
 					// --- End of pre-processing one line of image data here ---
 											
 				}
 				else
 				{
 					
-				}  // if ((XDMAC->XDMAC_GS & XDMAC_GS_ST0_Msk) == 0)
+				}  // if (nCaptureHALLineDone() == 1)
 								
 				
 				if (nLineCounter == gnImageHeight)				// Check for end of frame.
@@ -773,22 +1575,60 @@ void Proce_TCM8230_Driver(TASK_ATTRIBUTE *ptrTask)
 				//PIN_FLAG4_CLEAR;				
 			break;
 
-			case 11: // State 11 - End, do some tidy-up chores, update frame counter and valid frame buffer flag.
-				if ((gnFrameCounter & 0x00000001) == 1)			// If frame number is odd.
+			case 11: // State 11 - End, do some tidy-up chores, update frame counter and publish the new frame.
+				gunCameraLineCyclesMax = unLineCyclesMax;
+				if ((gnFrameWrite >= 0) && (nFrameOverrun > 0))	// Do not publish a frame with missing lines, the
+				{												// slot is reused for the next frame.
+					gnFrameWrite = -1;
+					gunFrameDropped++;
+				}
+				else if (gnFrameWrite >= 0)
 				{
-					gnValidFrameBuffer = 1;					    // Indicating odd frame number has been updated.  Thus image processing
-																// algorithm should get the pixel attributes from Frame Buffer 2.					
+					gnFrameCounter++;							// Update frame counter.
+					gunFrameSlotSeq[gnFrameWrite] = gnFrameCounter;
+					ptrFrame = &gstrcFrameBuffer[gnFrameWrite];
+					ptrFrame->unAttributes = unFrameAttributes;
+					CameraTimestamp(&ptrFrame->strcCaptureEnd);
+					gnFrameNewest = gnFrameWrite;				// The new frame is now available to image processing tasks.
+					gunCameraFrameCycles = unFrameCycles;
+					gnFrameWrite = -1;
+					if (unLumPixels > 0)
+					{
+						gunAverageLuminance = unLumCumulative/unLumPixels;	// Update the average Luminance for current frame.
+					}
+					#ifdef		__LUM_HISTORY
+					if (unFrameAttributes & _CAMERA_ATT_HISTORY)
+					{
+						gstrcLumHistory[gnLumHistoryWrite].unFrame = gnFrameCounter;
+						gnLumHistoryNewest = gnLumHistoryWrite;	// Frame t-0 of the history ring.
+						if (gnLumHistoryCount < _LUM_HISTORY_SIZE - 1)
+						{
+							gnLumHistoryCount++;
+						}
+					}
+					#endif
+					if (unFrameAttributes & _CAMERA_ATT_HISTOGRAM)
+					{
+						ComputeFrameStatistics(unLumCumulative, unLumPixels);	// Publish the luminance statistics.
+						gstrcFrameStat.unFrame = gnFrameCounter;
+					}
+					OSSignalEvent(__EVENT_FRAME_COMPLETE);		// Wake up the tasks waiting for a new frame.
 				}
 				else
 				{
-					gnValidFrameBuffer = 0;						// Indicating even frame number has been updated.  Thus image processing
-																// algorithm should get the pixel attributes from Frame Buffer 1.					
+					gunFrameDropped++;							// Frame is dropped, no free slot in the frame pool.
 				}
-				gnFrameCounter++;								// Update frame counter.
-				gunAverageLuminance = unLumCumulative/_NOPIXELSINFRAME;	// Update the average Luminance for current frame.
 				//PIN_FLAG1_CLEAR;								// Clear indicator flag.
 				unLumCumulative = 0;							// Reset the sum of cumulative Luminance.
-				OSSetTaskContext(ptrTask, 8, 1);				// Next state = 8, timer = 1.
+				unLumPixels = 0;
+				if (nCameraWritePending() > 0)					// Send new register values between frames.
+				{
+					OSSetTaskContext(ptrTask, 6, 1);			// Next state = 6, timer = 1.
+				}
+				else
+				{
+					OSSetTaskContext(ptrTask, 8, 1);			// Next state = 8, timer = 1.
+				}
 			break;
 			/*
 			case 12: // State 12 - Power down sequence, disable camera clock.
@@ -13,6 +13,8 @@
 // Include common header to all drivers and sources.  Here absolute path is used.
 // To edit if one change folder
 #include "osmain.h"
+#include <stddef.h>						// For NULL.
+#include "Driver_TCM8230_Regs.h"		// Camera register write list, nCameraWriteReg().
 
 //
 // --- PUBLIC CONSTANTS ---
@@ -21,6 +23,45 @@
 #define _IMAGE_VRESOLUTION   120
 #define _NOPIXELSINFRAME	 19200
 
+//#define _IMAGE_HRESOLUTION   128		// For 128x96 pixels subQCIF resolution.
+//#define _IMAGE_VRESOLUTION   96
+//#define _NOPIXELSINFRAME	 12288
+
+// Optional pixel attribute planes in the frame buffer.  The luminance plane is always present.  Each
+// optional plane costs _NOPIXELSINFRAME bytes (2x for the hue plane) per frame buffer, so only enable 
+// the planes used by the image processing algorithms.  
+//#define		__FRAME_HUE_PLANE			// Hue plane, needed by the image streamer 'H' command (ignored without it).
+//#define		__FRAME_SAT_PLANE			// Saturation plane.
+//#define		__SOBEL_GRADIENT			// Luminance gradient plane, computed with Sobel kernel in the camera driver,
+											// needed by the image streamer 'D' command (ignored without it).
+											// This was disabled to free up processor bandwidth for the user tasks
+											// (the CNN in User_Task.c uses the cycles left in each system tick).
+//#define		__GRADIENT_ORIENTATION		// Gradient orientation plane, requires __SOBEL_GRADIENT.
+//#define		__GRADIENT_L2				// Gradient magnitude is sqrt(Gx^2 + Gy^2) instead of |Gx| + |Gy|.
+#define		_GRAD_DIR_BINS			16		// No. of orientation bins over 360 degrees, 8 or 16.
+//#define		__FRAME_RGB_PLANE			// RGB565 plane, the raw pixel data from the camera (after byte swap).
+//#define		__INTEGRAL_IMAGE			// Luminance integral image (summed-area table), 4x_NOPIXELSINFRAME bytes.
+//#define		__INTEGRAL_MASK				// Integral image of the binarized luminance (dark pixels), 2x_NOPIXELSINFRAME bytes.
+//#define		__LUM_PYRAMID				// Luminance pyramid, 1/2 and 1/4 resolution levels, 0.3125x_NOPIXELSINFRAME bytes.
+//#define		__LUM_HISTORY				// Ring of the luminance planes of the last _LUM_HISTORY_SIZE frames, 
+											// _LUM_HISTORY_SIZE x _NOPIXELSINFRAME bytes.  Not part of the frame buffer.
+#define		_LUM_HISTORY_SIZE		5		// No. of luminance planes in the ring, 3 or more.  Frames t-0 to 
+											// t-(_LUM_HISTORY_SIZE-2) are available, the last plane is being filled.
+//#define		__LINE_TIMESTAMP			// Time of the DMA completion of each line, 4x_IMAGE_VRESOLUTION bytes per frame buffer.
+
+// Pixel attributes which an image processing task can subscribe to with CameraSubscribe().
+#define		_CAMERA_ATT_LUMINANCE		0x01	// Luminance plane, always computed.
+#define		_CAMERA_ATT_HISTOGRAM		0x02	// Luminance histogram gunIHisto[].
+#define		_CAMERA_ATT_HUESAT			0x04	// Hue and saturation planes.
+#define		_CAMERA_ATT_GRADIENT		0x08	// Luminance gradient plane, requires __SOBEL_GRADIENT.
+#define		_CAMERA_ATT_RGB				0x10	// RGB565 plane, requires __FRAME_RGB_PLANE.
+#define		_CAMERA_ATT_INTEGRAL		0x20	// Luminance integral image, requires __INTEGRAL_IMAGE.
+#define		_CAMERA_ATT_INTEGRAL_MASK	0x40	// Binarized mask integral image, requires __INTEGRAL_MASK.
+#define		_CAMERA_ATT_PYRAMID			0x80	// Luminance pyramid, requires __LUM_PYRAMID.
+#define		_CAMERA_ATT_HISTORY			0x100	// Luminance history ring, requires __LUM_HISTORY.
+#define		_CAMERA_ATT_GRAD_DIR		0x200	// Gradient orientation plane, requires __GRADIENT_ORIENTATION.  This
+												// implies _CAMERA_ATT_GRADIENT.
+
 //
 // --- PUBLIC VARIABLES ---
 //
@@ -37,14 +78,132 @@ extern	int		gnLuminanceMode;	// Option to set how luminance value for each pixel
 									// 2 - I = 2G
 									// Else - I = 4B
 
-extern	unsigned int gunImgAtt[_IMAGE_HRESOLUTION][_IMAGE_VRESOLUTION];
-extern	unsigned int gunImgAtt2[_IMAGE_HRESOLUTION][_IMAGE_VRESOLUTION];
-extern	int		gnValidFrameBuffer;		// If equals 1, it means gunImgAtt[] data can be used for image processing.
-// If equals 2, then gunImgAtt2[] data can be used instead for image processing.
-// Under normal operation, the value of gnValidFrameBuffer will alternate
-// between 1 and 2 as raw pixel data captured from the camera is store in
-// gunImgAtt[] and gunImgAtt2[] alternately.
+// Time stamp of the camera driver events.  The cycle counter wraps around every 14.3 seconds at 300 MHz,
+// use unCameraElapsedUS() to get the time since a time stamp.
+typedef struct StructFRAME_TIMESTAMP
+{
+	unsigned int	unTick;			// Value of gunClockTick.
+	unsigned int	unCycle;		// Value of the DWT cycle counter, DWT->CYCCNT.
+} FRAME_TIMESTAMP;
 
+// Frame buffer, the pixel attributes are stored in separate planes, each plane is a row-major 2D array
+// indexed by [y][x], so pixels along a row are adjacent in memory.
+// un8Lum:   bit6 - bit0 = Luminance information, 7-bits.
+//           bit7 - Marker flag, set to 1 if we wish the external/remote display to highlight this pixel.
+// un16Hue:  Hue information, 9-bits, 0 to 360, _NO_HUE_BRIGHT or _NO_HUE_DARK for gray scale.
+// un8Sat:   Saturation, 6-bits, 0-63 (63 = pure spectral).
+// un8Grad:  Luminance gradient, 7-bits.
+// un8GradDir: Orientation of the luminance gradient, 0 to _GRAD_DIR_BINS-1.  Bin n is centred at 
+//           n x 360/_GRAD_DIR_BINS degrees, measured from the +x axis towards the +y axis (downward).
+//           Use (bin % (_GRAD_DIR_BINS/2)) for the unsigned orientation, e.g. for HOG.
+// un16RGB:  RGB565 pixel data.
+// unLumIntegral: Luminance integral image, entry [y][x] is the sum of luminance of all pixels in rows 0 
+//           to y-1 and columns 0 to x-1, thus the array has one more row and column than the image.
+// un16MaskIntegral: Integral image of the binarized luminance, entry [y][x] is the no. of pixels with 
+//           luminance below gunMaskThreshold in rows 0 to y-1 and columns 0 to x-1.
+// un8Lum1, un8Lum2: Luminance pyramid, level 1 and 2 are the 2x2 and 4x4 averages of un8Lum (e.g. 80x60
+//           and 40x30 pixels for QQVGA).
+// unAttributes: The pixel attributes computed for this frame, combination of _CAMERA_ATT_XXX flags.
+// strcCaptureStart: Time when the start of frame (VSync = 'L') is detected by the camera driver.
+// strcCaptureEnd: Time when the last line is pre-processed, just before the frame is published.
+// unLineCycle: Processor cycles from strcCaptureStart to the detection of the DMA completion of each line.
+// A QQVGA frame buffer occupies 19.2 KBytes with the luminance plane only, and 96.0 KBytes with all
+// planes, as compared to 76.8 KBytes for the previous packed 32-bits pixel attributes.
+typedef struct StructFRAME_BUFFER
+{
+	uint8_t		un8Lum[_IMAGE_VRESOLUTION][_IMAGE_HRESOLUTION];
+#ifdef		__FRAME_HUE_PLANE
+	uint16_t	un16Hue[_IMAGE_VRESOLUTION][_IMAGE_HRESOLUTION];
+#endif
+#ifdef		__FRAME_SAT_PLANE
+	uint8_t		un8Sat[_IMAGE_VRESOLUTION][_IMAGE_HRESOLUTION];
+#endif
+#ifdef		__SOBEL_GRADIENT
+	uint8_t		un8Grad[_IMAGE_VRESOLUTION][_IMAGE_HRESOLUTION];
+#endif
+#ifdef		__GRADIENT_ORIENTATION
+	uint8_t		un8GradDir[_IMAGE_VRESOLUTION][_IMAGE_HRESOLUTION];
+#endif
+#ifdef		__FRAME_RGB_PLANE
+	uint16_t	un16RGB[_IMAGE_VRESOLUTION][_IMAGE_HRESOLUTION];
+#endif
+#ifdef		__LUM_PYRAMID
+	uint8_t		un8Lum1[_IMAGE_VRESOLUTION/2][_IMAGE_HRESOLUTION/2];
+	uint8_t		un8Lum2[_IMAGE_VRESOLUTION/4][_IMAGE_HRESOLUTION/4];
+#endif
+#ifdef		__INTEGRAL_IMAGE
+	uint32_t	unLumIntegral[_IMAGE_VRESOLUTION+1][_IMAGE_HRESOLUTION+1];
+#endif
+#ifdef		__INTEGRAL_MASK
+	uint16_t	un16MaskIntegral[_IMAGE_VRESOLUTION+1][_IMAGE_HRESOLUTION+1];
+#endif
+	unsigned int	unAttributes;
+	FRAME_TIMESTAMP	strcCaptureStart;
+	FRAME_TIMESTAMP	strcCaptureEnd;
+#ifdef		__LINE_TIMESTAMP
+	unsigned int	unLineCycle[_IMAGE_VRESOLUTION];
+#endif
+} FRAME_BUFFER;
+
+// Accessor macros for the pixel attributes at column x and row y of a frame buffer.  A plane which
+// is not enabled reads as a constant, so the image processing algorithms need not check the planes.
+#define		_FRAME_LUM(ptrFrame, x, y)		((ptrFrame)->un8Lum[(y)][(x)])
+#define		_FRAME_LUM1(ptrFrame, x, y)		((ptrFrame)->un8Lum1[(y)][(x)])		// Pyramid level 1, x and y at 1/2 resolution.
+#define		_FRAME_LUM2(ptrFrame, x, y)		((ptrFrame)->un8Lum2[(y)][(x)])		// Pyramid level 2, x and y at 1/4 resolution.
+#ifdef		__FRAME_HUE_PLANE
+#define		_FRAME_HUE(ptrFrame, x, y)		((ptrFrame)->un16Hue[(y)][(x)])
+#else
+#define		_FRAME_HUE(ptrFrame, x, y)		(_NO_HUE_BRIGHT)
+#endif
+#ifdef		__FRAME_SAT_PLANE
+#define		_FRAME_SAT(ptrFrame, x, y)		((ptrFrame)->un8Sat[(y)][(x)])
+#else
+#define		_FRAME_SAT(ptrFrame, x, y)		(0)
+#endif
+#ifdef		__SOBEL_GRADIENT
+#define		_FRAME_GRAD(ptrFrame, x, y)		((ptrFrame)->un8Grad[(y)][(x)])
+#else
+#define		_FRAME_GRAD(ptrFrame, x, y)		(0)
+#endif
+#ifdef		__GRADIENT_ORIENTATION
+#define		_FRAME_GRAD_DIR(ptrFrame, x, y)	((ptrFrame)->un8GradDir[(y)][(x)])
+#else
+#define		_FRAME_GRAD_DIR(ptrFrame, x, y)	(0)
+#endif
+// Sum of luminance and no. of dark pixels in the rectangular region with top left corner at column x
+// and row y, and size w x h pixels, from the integral images with four look-ups.  The no. of pixels 
+// in a frame is less than 65536, so the 16-bits mask integral image gives the exact count with modulo
+// arithmetic.
+#define		_FRAME_LUM_SUM(ptrFrame, x, y, w, h)	((ptrFrame)->unLumIntegral[(y)+(h)][(x)+(w)] - (ptrFrame)->unLumIntegral[(y)][(x)+(w)] - \
+												(ptrFrame)->unLumIntegral[(y)+(h)][(x)] + (ptrFrame)->unLumIntegral[(y)][(x)])
+#define		_FRAME_MASK_COUNT(ptrFrame, x, y, w, h)	((uint16_t) ((ptrFrame)->un16MaskIntegral[(y)+(h)][(x)+(w)] - (ptrFrame)->un16MaskIntegral[(y)][(x)+(w)] - \
+												(ptrFrame)->un16MaskIntegral[(y)+(h)][(x)] + (ptrFrame)->un16MaskIntegral[(y)][(x)]))
+// Packed 32-bits pixel attributes, in the format of the previous gunImgAtt[][], for algorithms that 
+// are not migrated to the planes yet.
+#define		_FRAME_ATT(ptrFrame, x, y)		(_FRAME_LUM(ptrFrame, x, y) | (_FRAME_HUE(ptrFrame, x, y) << _HUE_SHIFT) | \
+											(_FRAME_SAT(ptrFrame, x, y) << _SAT_SHIFT) | (_FRAME_GRAD(ptrFrame, x, y) << _GRAD_SHIFT))
+
+#define		_FRAME_POOL_SIZE	3			// No. of frame buffers in the frame pool, 2 to 4.  With 2 slots the camera
+											// driver drops frames whenever an image processing task holds a frame.
+extern	FRAME_BUFFER	gstrcFrameBuffer[_FRAME_POOL_SIZE];
+extern	unsigned int	gunFrameDropped;	// No. of frames dropped as there is no free slot in the frame pool, or
+											// with line overrun.
+extern	unsigned int	gunCameraFrameCycles;	// No. of processor cycles spent on pre-processing the last frame.
+extern	unsigned int	gunCameraLineCyclesMax;	// Max. no. of processor cycles spent on pre-processing one line in the last frame.
+extern	unsigned int	gunLineOverrun;		// No. of line overruns since power on.
+
+// Luminance plane of a past frame, see ptrCameraGetLumHistory().  _FRAME_LUM() can be used to read
+// the pixels.  unFrame is the frame counter value of the frame.
+#ifdef		__LUM_HISTORY
+typedef struct StructLUM_PLANE
+{
+	uint8_t		un8Lum[_IMAGE_VRESOLUTION][_IMAGE_HRESOLUTION];
+	unsigned int	unFrame;
+} LUM_PLANE;
+#endif
+
+// Bit fields of the packed 32-bits pixel attributes, as returned by the pixel decoder in the camera
+// driver and _FRAME_ATT().
 // bit6 - bit0 = Luminance information, 7-bits.
 // bit7 - Marker flag, set to 1 if we wish the external/remote display to highlight
 //        this pixel.
@@ -53,7 +212,7 @@ extern	int		gnValidFrameBuffer;		// If equals 1, it means gunImgAtt[] data can b
 // bit30 - bit23 = Luminance gradient, 8 - bits.
 // bit31 - Special flag.
 #define     _LUMINANCE_MASK     0x0000007F  // luminance mask, bit6-0.
-#define     _CLUMINANCE_MASK    0xFFFFFF00  // One's complement of luminance mask.
+#define     _CLUMINANCE_MASK    0xFFFFFF80  // One's complement of luminance mask.
 #define     _LUMINANCE_SHIFT    0
 #define     _HUE_MASK           0x0001FF00  // bit16-8
 #define     _HUE_SHIFT          8
@@ -70,6 +229,29 @@ extern	int		gnValidFrameBuffer;		// If equals 1, it means gunImgAtt[] data can b
 
 extern	int16_t gunIHisto[255];
 extern	unsigned int	gunAverageLuminance;
+
+// Luminance statistics of a frame, computed by the camera driver from the histogram at the end of each 
+// frame when any task subscribes to _CAMERA_ATT_HISTOGRAM.  Only the lines pre-processed by the camera
+// driver are included, see CameraSetWindow().
+#define		_STAT_NO_OF_BINS		128		// 7-bits luminance.
+#define		_STAT_NOISE_FLOOR		3		// Luminance levels with this no. of pixels or less are ignored
+											// for the minimum and maximum luminance.
+typedef struct StructFRAME_STATISTICS
+{
+	unsigned int	unFrame;				// Frame counter value of the frame.
+	unsigned int	unPixels;				// No. of pixels in the histogram.
+	unsigned int	unMean;					// Average luminance.
+	unsigned int	unVariance;				// Variance of luminance.
+	int		nMin;							// Minimum luminance, ignoring noise.
+	int		nMax;							// Maximum luminance, ignoring noise.
+	int		nP05;							// 5th percentile of luminance.
+	int		nP50;							// Median of luminance.
+	int		nP95;							// 95th percentile of luminance.
+	int		nOtsuThreshold;					// Binarization threshold using Otsu's method, class 0 is <= threshold.
+	uint16_t	un16CumHisto[_STAT_NO_OF_BINS];	// Cumulative histogram, no. of pixels with luminance <= index.
+} FRAME_STATISTICS;
+extern	FRAME_STATISTICS	gstrcFrameStat;
+extern	unsigned int	gunMaskThreshold;
 #define		_CAMERA_READY			1
 #define		_CAMERA_NOT_READY		0
 extern int				gnCameraReady;	
@@ -80,5 +262,14 @@ extern int				gnCameraReady;
 //
 void Proce_TCM8230_Driver(TASK_ATTRIBUTE *);
 void Proce_Camera_LED_Driver(TASK_ATTRIBUTE *);
+FRAME_BUFFER *ptrCameraAcquireFrame(unsigned int *);
+void CameraReleaseFrame(FRAME_BUFFER *);
+void CameraTimestamp(FRAME_TIMESTAMP *);
+unsigned int unCameraElapsedUS(const FRAME_TIMESTAMP *);
+void CameraSubscribe(TASK_ATTRIBUTE *, unsigned int);
+void CameraSetWindow(TASK_ATTRIBUTE *, int, int, int, int);
+#ifdef		__LUM_HISTORY
+LUM_PLANE *ptrCameraGetLumHistory(int);
+#endif
 
 #endif
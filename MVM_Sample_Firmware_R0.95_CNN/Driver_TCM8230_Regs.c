@@ -0,0 +1,224 @@
+//////////////////////////////////////////////////////////////////////////////////////////////
+//
+// File				: Driver_TCM8230_Regs.c
+// Author(s)		: Fabian Kung
+// Last modified	: 16 Oct 2026
+// Tool-suites		: Atmel Studio 7.0 or later
+//                    GCC C-Compiler
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+// Register table, write list and shadow registers of the TCM8230 camera module, see 
+// Driver_TCM8230_Regs.h.  No hardware is accessed here, the I2C transactions are issued by
+// Proce_TCM8230_Driver().
+
+#include "Driver_TCM8230_Regs.h"
+
+//
+// --- PRIVATE CONSTANTS ---
+//
+
+// Camera initialization table, the registers are written in this order.  Entries with 
+// consecutive register addresses are sent in one I2C burst.
+// 28 Jan 2016: Register 0x03 should be written last.  After the camera is turned ON, the 
+// signal lines DCLK, HSYNC, VSYNC will become active.
+const CAMERA_REG gstrcCameraInitTable[] = {
+	{0x1E, 0x6C},			// DMASK = 0x01, HSYNCSEL = 1, CODESW = 1 (Output synchronization code),
+							// CODESEL = 0 (Original synchronization code format).
+							// TESPIC = 1 (Enable test picture mode), PICSEL = 0x00 (Color bar).
+							// 0x68 - Normal operation.
+							// 0x6D - Test mode, output color ramp 1.
+							// 0x6E - Test mode, output color ramp 2.
+	{0x02, 0x00},			// Max. frame rate is 30 fps, ACF = 50 Hz (not important if ACFDET = AUTO),
+							// DCLK polarity = Normal.  0x80 - Max frame rate is 15 fps.
+	{0x03, 0x0E}			// Turn on camera, enable D0-D7 outputs, RGB565 color, QQVGA(f).
+							// 0x12 - QQVGA(z), 0x22 - subQCIF(f), 0x26 - subQCIF(z).
+};
+
+#define		_CAMERA_INIT_TABLE_SIZE		(int)(sizeof(gstrcCameraInitTable)/sizeof(CAMERA_REG))
+
+//
+// --- PUBLIC VARIABLES ---
+//
+uint8_t		gbytCameraShadowReg[_CAMERA_NO_OF_REGS];
+unsigned int	gunCameraRegWrites = 0;
+unsigned int	gunCameraRegBursts = 0;
+
+//
+// --- PRIVATE VARIABLES ---
+//
+uint8_t		gbytCameraShadowValid[_CAMERA_NO_OF_REGS];	// 1 = shadow register holds the camera register value.
+CAMERA_REG	gstrcCameraWriteList[_CAMERA_MAX_WRITES];	// Register writes waiting to be sent, in order.
+int			gnCameraWriteCount = 0;						// No. of entries in the write list.
+int			gnCameraWriteIndex = 0;						// Next entry to send.
+
+///
+/// Function name	: CameraLoadInitTable
+///
+/// Author			: Fabian Kung
+///
+/// Last modified	: 16 Oct 2026
+///
+/// Code Version	: 1.00
+///
+/// Processor		: Generic
+///
+/// Description		: Invalidate all shadow registers, e.g. after camera reset, and 
+///                   replace the write list with the camera initialization table.
+///
+/// Arguments		: None.
+///
+/// Return			: None.
+///
+/// Global variable	: gstrcCameraInitTable[], gbytCameraShadowValid[], gstrcCameraWriteList[]
+///
+void CameraLoadInitTable(void)
+{
+	int nIndex;
+	
+	for (nIndex = 0; nIndex < _CAMERA_NO_OF_REGS; nIndex++)
+	{
+		gbytCameraShadowValid[nIndex] = 0;
+	}
+	gnCameraWriteCount = 0;
+	gnCameraWriteIndex = 0;
+	for (nIndex = 0; nIndex < _CAMERA_INIT_TABLE_SIZE; nIndex++)
+	{
+		gstrcCameraWriteList[gnCameraWriteCount++] = gstrcCameraInitTable[nIndex];
+	}
+}
+
+///
+/// Function name	: nCameraWriteReg
+///
+/// Author			: Fabian Kung
+///
+/// Last modified	: 16 Oct 2026
+///
+/// Code Version	: 1.00
+///
+/// Processor		: Generic
+///
+/// Description		: Queue a write to a camera register.  Nothing is queued if the shadow
+///                   register already holds the value.  If the register is waiting in the
+///                   write list, the queued value is replaced.  The camera driver sends
+///                   the write list at the end of the current frame.
+///
+/// Arguments		: nReg - Register address.
+///                   nValue - Register value.
+///
+/// Return			: 1 - Write queued.
+///                   0 - No change, nothing to send.
+///                   -1 - Invalid register or write list is full.
+///
+/// Global variable	: gbytCameraShadowReg[], gbytCameraShadowValid[], gstrcCameraWriteList[]
+///
+int nCameraWriteReg(int nReg, int nValue)
+{
+	int nIndex;
+	
+	if ((nReg < 0) || (nReg >= _CAMERA_NO_OF_REGS))
+	{
+		return -1;
+	}
+	for (nIndex = gnCameraWriteIndex; nIndex < gnCameraWriteCount; nIndex++)	// Register already waiting in the list?
+	{
+		if (gstrcCameraWriteList[nIndex].bytReg == nReg)
+		{
+			gstrcCameraWriteList[nIndex].bytValue = nValue;
+			return 1;
+		}
+	}
+	if ((gbytCameraShadowValid[nReg] == 1) && (gbytCameraShadowReg[nReg] == (uint8_t) nValue))
+	{
+		return 0;
+	}
+	if (gnCameraWriteCount == gnCameraWriteIndex)		// Write list is empty, start from the beginning.
+	{
+		gnCameraWriteCount = 0;
+		gnCameraWriteIndex = 0;
+	}
+	if (gnCameraWriteCount == _CAMERA_MAX_WRITES)
+	{
+		return -1;
+	}
+	gstrcCameraWriteList[gnCameraWriteCount].bytReg = nReg;
+	gstrcCameraWriteList[gnCameraWriteCount].bytValue = nValue;
+	gnCameraWriteCount++;
+	return 1;
+}
+
+///
+/// Function name	: nCameraWritePending
+///
+/// Author			: Fabian Kung
+///
+/// Last modified	: 16 Oct 2026
+///
+/// Code Version	: 1.00
+///
+/// Processor		: Generic
+///
+/// Description		: Return the no. of register writes waiting to be sent.
+///
+/// Arguments		: None.
+///
+/// Return			: No. of entries in the write list.
+///
+/// Global variable	: gnCameraWriteCount, gnCameraWriteIndex
+///
+int nCameraWritePending(void)
+{
+	return gnCameraWriteCount - gnCameraWriteIndex;
+}
+
+///
+/// Function name	: nCameraNextBurst
+///
+/// Author			: Fabian Kung
+///
+/// Last modified	: 16 Oct 2026
+///
+/// Code Version	: 1.00
+///
+/// Processor		: Generic
+///
+/// Description		: Take the next burst from the write list.  Consecutive entries with
+///                   consecutive register addresses are combined, up to _CAMERA_MAX_BURST
+///                   bytes.  The shadow registers are updated with the values taken.
+///
+/// Arguments		: ptrReg - Start register address of the burst.
+///                   ptrData - Data bytes of the burst, at least _CAMERA_MAX_BURST bytes.
+///
+/// Return			: No. of data bytes in the burst, 0 if the write list is empty.
+///
+/// Global variable	: gstrcCameraWriteList[], gbytCameraShadowReg[], gbytCameraShadowValid[]
+///
+int nCameraNextBurst(uint8_t *ptrReg, uint8_t *ptrData)
+{
+	int nCount = 0;
+	int nReg;
+	
+	if (gnCameraWriteIndex >= gnCameraWriteCount)
+	{
+		gnCameraWriteCount = 0;
+		gnCameraWriteIndex = 0;
+		return 0;
+	}
+	*ptrReg = gstrcCameraWriteList[gnCameraWriteIndex].bytReg;
+	while ((gnCameraWriteIndex < gnCameraWriteCount) && (nCount < _CAMERA_MAX_BURST))
+	{
+		nReg = gstrcCameraWriteList[gnCameraWriteIndex].bytReg;
+		if (nReg != *ptrReg + nCount)			// End of consecutive register addresses.
+		{
+			break;
+		}
+		ptrData[nCount] = gstrcCameraWriteList[gnCameraWriteIndex].bytValue;
+		gbytCameraShadowReg[nReg] = ptrData[nCount];
+		gbytCameraShadowValid[nReg] = 1;
+		nCount++;
+		gnCameraWriteIndex++;
+	}
+	gunCameraRegWrites = gunCameraRegWrites + nCount;
+	gunCameraRegBursts++;
+	return nCount;
+}
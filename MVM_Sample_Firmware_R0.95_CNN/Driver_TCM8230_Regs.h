@@ -0,0 +1,52 @@
+//////////////////////////////////////////////////////////////////////////////////////////////
+//
+// File				: Driver_TCM8230_Regs.h
+// Author(s)		: Fabian Kung
+// Last modified	: 16 Oct 2026
+// Tool-suites		: Atmel Studio 7.0 or later
+//                    GCC C-Compiler
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _DRIVER_TCM8230_REGS_H
+#define _DRIVER_TCM8230_REGS_H
+
+// Register table, write list and shadow registers of the TCM8230 camera module.  
+// Proce_TCM8230_Driver() loads the initialization table after the camera reset, then sends
+// the write list to the camera with nCameraNextBurst(), one I2C transaction per burst.  
+// Writes with consecutive register addresses are combined into one burst as the camera
+// auto-increments the register address.  The shadow registers hold the last value sent to 
+// each register, so CameraWriteReg() only queues a write when the value changes.
+// This header does not include osmain.h so that it can be compiled on the computer, see 
+// MVM_Miscellaneous/Host/Camera_Host_I2C.c.
+#include <stdint.h>
+
+//
+// --- PUBLIC CONSTANTS ---
+//
+#define		_CAMERA_NO_OF_REGS		0x50	// Register address 0x00 to 0x4F.
+#define		_CAMERA_MAX_WRITES		16		// Size of the register write list.
+#define		_CAMERA_MAX_BURST		16		// Max. no. of data bytes in one I2C transaction, same as
+											// __MAX_I2C_DATA_BYTE in Driver_I2C1_V100.h.
+
+typedef struct StructCAMERA_REG
+{
+	uint8_t		bytReg;						// Register address.
+	uint8_t		bytValue;					// Register value.
+} CAMERA_REG;
+
+//
+// --- PUBLIC VARIABLES ---
+//
+extern	uint8_t		gbytCameraShadowReg[_CAMERA_NO_OF_REGS];	// Last value sent to each register.
+extern	unsigned int	gunCameraRegWrites;		// No. of register bytes sent to the camera since power on.
+extern	unsigned int	gunCameraRegBursts;		// No. of I2C transactions sent to the camera since power on.
+
+//
+// --- PUBLIC FUNCTION PROTOTYPE ---
+//
+void CameraLoadInitTable(void);
+int nCameraWriteReg(int, int);
+int nCameraWritePending(void);
+int nCameraNextBurst(uint8_t *, uint8_t *);
+
+#endif
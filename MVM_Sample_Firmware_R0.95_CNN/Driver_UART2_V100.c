@@ -116,7 +116,7 @@ uint8_t gbytRXbufptr;                             // Receive buffer length point
 ///			 via UART with DMA assistance.  It is assumed the required data has been stored
 ///          in the transmit buffer gbytTXbuffer[0] to gbytTXbuffer[99] already.
 ///
-/// 		SCB_CleanDCache();		// If we are using data cache (D-Cache), we should clean the data cache
+/// 		CacheCleanRange(gbytTXbuffer, 100);	// If we are using data cache (D-Cache), we should clean the data cache
 ///                                 // (D-Cache) before enabling the DMA. Otherwise when XDMAC access data
 ///                                 // from the cache, it may not contains the correct and up-to-date data.
 ///			XDMAC->XDMAC_CHID[1].XDMAC_CSA = (uint32_t) gbytTXbuffer;	// Set source start address.
@@ -274,6 +274,7 @@ void Proce_UART2_Driver(TASK_ATTRIBUTE *ptrTask)
 								gbytTXbufptr = 0;                   // Reset TX buffer pointer.
 								gbytTXbuflen = 0;                   // Reset TX buffer length.
 								gSCIstatus.bTXRDY = 0;              // Reset transmit flag.
+								OSSignalEvent(__EVENT_UART_TXDONE);	// Wake up the tasks waiting for UART.
 								PIN_LED2_CLEAR;                     // Off indicator LED2.
 								break;
 							}
@@ -284,6 +285,7 @@ void Proce_UART2_Driver(TASK_ATTRIBUTE *ptrTask)
 						if ((XDMAC->XDMAC_GS & XDMAC_GS_ST1_Msk) == 0)	// Check if DMA UART transmit is completed.
 						{
 							gSCIstatus.bTXRDY = 0;					// Reset transmit flag.
+							OSSignalEvent(__EVENT_UART_TXDONE);		// Wake up the tasks waiting for UART.
 							PIN_LED2_CLEAR;							// Off indicator LED2.
 							break;							
 						}
@@ -308,6 +310,7 @@ void Proce_UART2_Driver(TASK_ATTRIBUTE *ptrTask)
                             gbytRXbuffer[gbytRXbufptr] = UART2->UART_RHR;	// Get received data byte.
                             gbytRXbufptr++;									// Pointer to next byte in RX buffer.
                             gSCIstatus.bRXRDY = 1;							// Set valid data flag.
+                            OSSignalEvent(__EVENT_UART_RXRDY);				// Wake up the tasks waiting for UART.
                         }
                         else 												// data overflow.
                         {
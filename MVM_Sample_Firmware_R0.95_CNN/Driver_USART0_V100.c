@@ -213,6 +213,7 @@ void Proce_USART0_Driver(TASK_ATTRIBUTE *ptrTask)
 							gbytTXbufptr2 = 0;                  // Reset TX buffer pointer.
 							gbytTXbuflen2 = 0;                  // Reset TX buffer length.
 							gSCIstatus2.bTXRDY = 0;             // Reset transmit flag.
+							OSSignalEvent(__EVENT_USART0_TXDONE);	// Wake up the tasks waiting for USART0.
 							PIN_LED2_CLEAR;                     // Off indicator LED2.
 							break;
 						}
@@ -237,6 +238,7 @@ void Proce_USART0_Driver(TASK_ATTRIBUTE *ptrTask)
                             gbytRXbuffer2[gbytRXbufptr2] = USART0->US_RHR;	// Get received data byte.
                             gbytRXbufptr2++;								// Pointer to next byte in RX buffer.
                             gSCIstatus2.bRXRDY = 1;							// Set valid data flag.
+                            OSSignalEvent(__EVENT_USART0_RXRDY);			// Wake up the tasks waiting for USART0.
                         }
                         else 												// data overflow.
                         {
@@ -16,6 +16,10 @@
 #include "./SAMS70_Drivers_BSP/Driver_UART2_V100.h"
 #include "./SAMS70_Drivers_BSP/Driver_USART0_V100.h"
 #include "./SAMS70_Drivers_BSP/Driver_TCM8230.h"
+#include "./SAMS70_Drivers_BSP/Driver_Cache_HAL.h"
+#include "./SAMS70_Drivers_BSP/os_Profile.h"
+#include "./SAMS70_Drivers_BSP/os_Coroutine.h"
+#include "User_Task.h"
 
 #include "CNN.h"
 
@@ -66,13 +70,20 @@ int		gnSendSecondaryInfo = 0;		// Set to 1 (in Image Processing Tasks) to transm
 int		gnImageProcessingAlgorithm = 1;	// Current active image processing algorithm ID. 
 										
 unsigned int	gunIPResult[_IMAGE_HRESOLUTION/4][_IMAGE_VRESOLUTION];
+IPA_RESULT		gstrcIPA4Result;		// Result of Proce_Image4(), see User_Task.h.
+
+#ifdef		__OS_COROUTINE
+uint32_t		gunCNNDenseStack[_CNN_DENSE_STACK_WORDS];	// Stack of CoTask_CNNDense().
+int				*gptrnCNNFlat;			// Input of the dense layers, the flatten nodes of Layer 0.
+int				*gptrnCNNOut;			// Output of the dense layers.
+#endif
 
 int gnDebug;
 int gnDebug2;
 
 // --- Local function prototype ---
 void	SetIPResultBuffer(int , int , unsigned int);	// Function to update the bytes in gunIPResult.
-int		nConv2D(int, int, int *, int);
+int		nConv2D(FRAME_BUFFER *, int, int, int *, int);
 int     nMaxPool2D(int, int, int, int);
 
 #define     _DEVICE_RESET               0x00
@@ -91,6 +102,8 @@ int     nMaxPool2D(int, int, int, int);
 #define PIN_FLAG4_SET			PIOA->PIO_ODSR |= PIO_ODSR_P8;					// Set flag 4.
 #define PIN_FLAG4_CLEAR			PIOA->PIO_ODSR &= ~PIO_ODSR_P8;					// Clear flag 4.
 
+#include "CNN_Dense.h"										// Dense layers of the CNN, uses PIN_FLAG4_SET and PIN_FLAG4_CLEAR.
+
 
 
 /// Author			: Fabian Kung
@@ -185,8 +198,15 @@ void	SetIPResultBuffer(int nx, int ny, unsigned int unResult)
 ///    The characters determine how the luminance is computed from the RGB components of each pixel.
 ///    See the codes for the camera driver for details.
 /// 2. If the command is 'D', then luminance gradient data will be streamed to the remote processor.
+///    Only available if __SOBEL_GRADIENT is defined in Driver_TCM8230.h, else the command is ignored.
 /// 3. If the command is 'H', then hue data will be streamed to the remote processor.  Here we
 ///    compress the Hue range from 0-360 to 0-90 (e.g. divide by 4) so that it will fit into 7 bits.
+///    Only available if __FRAME_HUE_PLANE is defined in Driver_TCM8230.h, else the command is ignored
+///    (without the plane _FRAME_HUE() is a constant).
+/// 4. If the command is 'T', the profile statistics and trace ring are sent, see os_Profile.c.  The 
+///    statistics are cleared after each dump.
+/// 5. If the command is 'U', the CPU usage and overrun statistics of each task are sent, see 
+///    nTaskStatPacket() in os_Profile.c.  The statistics are cleared after each dump.
 ///
 /// The image data is send to the remote display line-by-line, using a simple RLE (Run-Length
 /// Encoding) compression format. The data format:
@@ -196,6 +216,8 @@ void	SetIPResultBuffer(int nx, int ny, unsigned int unResult)
 ///        If Byte1 = 254, it indicate the subsequent bytes are secondary info such
 ///        as ROI location and size and any other info the user wish to transmit to the host.
 ///        At present auxiliary info is only 10 bytes.
+///        If Byte1 = 252, the subsequent bytes are profile data, see nProfilePacket() in os_Profile.c.
+///        If Byte1 = 251, the subsequent bytes are task statistics, see nTaskStatPacket() in os_Profile.c.
 /// Byte2: The length of the data payload, excluding Byte0-2.
 /// Byte3-ByteN: Data payload.
 /// The data payload only accepts 7 bits value, from bit0-bit6.  Bit7 is used to indicate
@@ -249,6 +271,10 @@ void Proce_MessageLoop_StreamImage(TASK_ATTRIBUTE *ptrTask)
 {
 	static unsigned char bytData;
 	static int nLineCounter;
+	static FRAME_BUFFER *ptrFrame = NULL;		// Frame being sent to remote host.
+	static int nStreamIdle = 0;					// Set when the remote host stops streaming for 1 sec.
+	static unsigned int unStreamIdleStart = 0;	// Value of gunClockTick at the last command from remote host.
+	static int nPacketCounter;					// Packet no. of the profile dump.
 	int nXposCounter;
 	int nCurrentPixelData;
 	int nRefPixelData;
@@ -281,6 +307,8 @@ void Proce_MessageLoop_StreamImage(TASK_ATTRIBUTE *ptrTask)
 					// 'G' (for gradient data).
 					// 'H' (for hue data)
 					// 'P' (for image processing buffer result, if available)
+					// 'T' (for profile statistics and trace)
+					// 'U' (for task CPU usage and overrun statistics)
 			
 			// --- Message clearing for USART0 ---
 			
@@ -329,29 +357,39 @@ void Proce_MessageLoop_StreamImage(TASK_ATTRIBUTE *ptrTask)
 						case 'L':								// Send luminance data computed from RGB components.  The camera driver
 																// will use all R,G and B components to compute the luminance.	
 							gnLuminanceMode = 0;			
+							CameraSubscribe(ptrTask, _CAMERA_ATT_LUMINANCE);
 							OSSetTaskContext(ptrTask, 2, 1);    // Next state = 2, timer = 1.
 						break;
 						
+						#ifdef		__SOBEL_GRADIENT				// Not accepted if the gradient plane is not built.
 						case 'D':								// Luminance gradient data.
+							CameraSubscribe(ptrTask, _CAMERA_ATT_GRADIENT);
 							OSSetTaskContext(ptrTask, 2, 1);    // Next state = 2, timer = 1.
 						break;
+						#endif
 						
+						#ifdef		__FRAME_HUE_PLANE				// Not accepted if the hue plane is not built.
 						case 'H':								// Hue data.
+							CameraSubscribe(ptrTask, _CAMERA_ATT_HUESAT);
 							OSSetTaskContext(ptrTask, 2, 1);    // Next state = 2, timer = 1.
 						break;
+						#endif
 						
 						case 'R':								// Send luminance data computed from R component.  The camera driver 
 							gnLuminanceMode = 1;				// pre-processing will compute the luminance using R component.
+							CameraSubscribe(ptrTask, _CAMERA_ATT_LUMINANCE);
 							OSSetTaskContext(ptrTask, 2, 1);    // Next state = 2, timer = 1.						
 						break;
 						
 						case 'G':								// Send luminance data computed from G component. The camera driver
 							gnLuminanceMode = 2;				// pre-processing will compute the luminance using G component.
+							CameraSubscribe(ptrTask, _CAMERA_ATT_LUMINANCE);
 							OSSetTaskContext(ptrTask, 2, 1);    // Next state = 2, timer = 1.						
 						break;
 						
 						case 'B':								// Send luminance data computed from B component. The camera driver
 							gnLuminanceMode = 3;				// pre-processing will compute the luminance using B component.	
+							CameraSubscribe(ptrTask, _CAMERA_ATT_LUMINANCE);
 							OSSetTaskContext(ptrTask, 2, 1);    // Next state = 2, timer = 1.						
 						break;
 						
@@ -360,6 +398,16 @@ void Proce_MessageLoop_StreamImage(TASK_ATTRIBUTE *ptrTask)
 							OSSetTaskContext(ptrTask, 3, 1);    // Next state = 3, timer = 1.
 						break;
 						
+						case 'T':								// Send the profile statistics and trace ring.
+							nPacketCounter = 0;
+							OSSetTaskContext(ptrTask, 12, 1);   // Next state = 12, timer = 1.
+						break;
+						
+						case 'U':								// Send the task CPU usage and overrun statistics.
+							nPacketCounter = 0;
+							OSSetTaskContext(ptrTask, 13, 1);   // Next state = 13, timer = 1.
+						break;
+						
 						default:
 							OSSetTaskContext(ptrTask, 1, 1);     // Next state = 1, timer = 1.
 						break;
@@ -373,21 +421,48 @@ void Proce_MessageLoop_StreamImage(TASK_ATTRIBUTE *ptrTask)
 				gSCIstatus.bRXRDY = 0;	// Reset valid data flag.
 				gbytRXbufptr = 0; 		// Reset pointer.
 				PIN_LED2_CLEAR;			// Turn off indicator LED2.
+				nStreamIdle = 0;
+				unStreamIdleStart = gunClockTick;
 			}
 			else
 			{
-				OSSetTaskContext(ptrTask, 1, 1);     // Next state = 1, timer = 1.
+				nTemp = gunClockTick - unStreamIdleStart;			// System ticks since the last command.
+				if ((nStreamIdle == 0) && (nTemp >= 1000*__NUM_SYSTEMTICK_MSEC))	// Remote host stops streaming for 1 sec, 
+				{																	// the whole frame is no longer needed.
+					CameraSetWindow(ptrTask, 0, 0, 0, 0);
+					CameraSubscribe(ptrTask, 0);			// Cancel the attributes of the last command, e.g. hue/saturation
+															// for 'H', the next command subscribes again.
+					nStreamIdle = 1;
+				}
+				if (nStreamIdle == 0)								// Sleep until the next command, or until 1 sec 
+				{													// after the last command.
+					OSWaitEvent(ptrTask, __EVENT_UART_RXRDY | __EVENT_USART0_RXRDY, 1000*__NUM_SYSTEMTICK_MSEC - nTemp);
+				}
+				else
+				{
+					OSWaitEvent(ptrTask, __EVENT_UART_RXRDY | __EVENT_USART0_RXRDY, 0);
+				}
 			}
 			break;
 			
 			case 2: // State 2 - Send a line of pixel data to remote host, with RLE data compression.
 			
-			if (gSCIstatus.bTXRDY == 0)					// Check if  UART port is not busy.
+			if (ptrFrame == NULL)						// Start of a new frame, get the newest complete frame from
+			{											// the camera driver.  The frame is held until all lines are sent.
+				ptrFrame = ptrCameraAcquireFrame(NULL);
+				CameraSetWindow(ptrTask, 0, 0, gnImageWidth, gnImageHeight);	// The remote host displays the whole frame.
+			}
+			if (ptrFrame == NULL)						// No frame captured yet.
+			{
+				OSWaitEvent(ptrTask, __EVENT_FRAME_COMPLETE, 0);	// Sleep until the first frame.
+			}
+			else if (gSCIstatus.bTXRDY == 0)			// Check if  UART port is not busy.
 			{
 				gbytTXbuffer[0] = 0xFF;					// Start of line code.
 				gbytTXbuffer[1] = nLineCounter;			// Line number.
 				// gbytTXbuffer[2] stores the payload length.
 				// --- Implement simple RLE algorithm ---
+				PROFILE_BEGIN(_PROF_RLE_LINE);
 				nRepetition = 0;						// Initialize repetition counter.
 				nXposCounter = 1;						// Initialize x-position along a line of pixels.
 				// Initialize the first data byte.
@@ -401,22 +476,20 @@ void Proce_MessageLoop_StreamImage(TASK_ATTRIBUTE *ptrTask)
 					}
 					else if (bytData != 'H')					// 'L', 'R', 'G', 'B', send luminance data.
 					{					
-						nCurrentPixelData = gunImgAtt[0][nLineCounter] & _LUMINANCE_MASK; // Get pixel luminance data from frame buffer 1.
+						nCurrentPixelData = _FRAME_LUM(ptrFrame, 0, nLineCounter) & _LUMINANCE_MASK; // Get pixel luminance data from frame buffer 1.
 						nCurrentPixelData = nCurrentPixelData>>1;		// Note: Only 7-bits data is allowed
 					}
 					else                                // 'H', send scaled hue info.  Here we rescale the hue (0-360)
 					{									// to between 0-120, e.g. Hue/3, or between 0-90, e.g. Hue/4
 														// so that the value can fit into 7-bits byte.
-						//nTemp = gunImgAtt[0][nLineCounter] & _HUE_MASK;
-						//nCurrentPixelData = nTemp >> (_HUE_SHIFT + 2);						
-						nTemp = gunImgAtt[0][nLineCounter] & _HUE_MASK;		// Divide by 3.
-						nCurrentPixelData = nTemp >> (_HUE_SHIFT);		
+						//nCurrentPixelData = _FRAME_HUE(ptrFrame, 0, nLineCounter) >> 2;						
+						nCurrentPixelData = _FRAME_HUE(ptrFrame, 0, nLineCounter);		// Divide by 3.
 						nCurrentPixelData = nCurrentPixelData/3;					
 					}
 				}
 				else     // bytData == 'D'.
 				{
-					nCurrentPixelData = gunImgAtt[0][nLineCounter] >> (_GRAD_SHIFT + 1); // Get pixel gradient data and divide
+					nCurrentPixelData = _FRAME_GRAD(ptrFrame, 0, nLineCounter) >> 1; // Get pixel gradient data and divide
 					// by 2, as gradient value can hit 255.
 					nCurrentPixelData = 0x000000FF & nCurrentPixelData; // Mask out all except lower 8 bits.
 				}
@@ -460,21 +533,19 @@ void Proce_MessageLoop_StreamImage(TASK_ATTRIBUTE *ptrTask)
 					else if (bytData == 'H')							// 'H', send scaled hue info.  Here we rescale the hue (0-360)
 					{													// to between 0-120, e.g. Hue/3, or between 0-90, e.g. Hue/4
 						//so that the value can fit into 7-bits byte.
-						//nTemp = gunImgAtt[nIndex][nLineCounter] & _HUE_MASK;	// Divide by 4.
-						//nCurrentPixelData = nTemp >> (_HUE_SHIFT + 2);
-						nTemp = gunImgAtt[nIndex][nLineCounter] & _HUE_MASK;	// Divide by 3.
-						nCurrentPixelData = nTemp >> _HUE_SHIFT;
+						//nCurrentPixelData = _FRAME_HUE(ptrFrame, nIndex, nLineCounter) >> 2;	// Divide by 4.
+						nCurrentPixelData = _FRAME_HUE(ptrFrame, nIndex, nLineCounter);	// Divide by 3.
 						nCurrentPixelData = nCurrentPixelData/3;
 					}
 					else if (bytData == 'D')
 					{
-						nCurrentPixelData = gunImgAtt[nIndex][nLineCounter] >> (_GRAD_SHIFT + 1);	// Get pixel gradient data and divide
+						nCurrentPixelData = _FRAME_GRAD(ptrFrame, nIndex, nLineCounter) >> 1;	// Get pixel gradient data and divide
 																									// by 2, as the gradient value can hit 255.
 						nCurrentPixelData = 0x0000007F & nCurrentPixelData; // Mask out all except lower 7 bits.						
 					}
 					else                                
 					{													// 'L', 'R', 'G', 'B', send luminance data.
-						nCurrentPixelData = gunImgAtt[nIndex][nLineCounter] & _LUMINANCE_MASK; // Get pixel luminance data from frame buffer 1.				
+						nCurrentPixelData = _FRAME_LUM(ptrFrame, nIndex, nLineCounter) & _LUMINANCE_MASK; // Get pixel luminance data from frame buffer 1.				
 					}	
 					
 					if (nCurrentPixelData == nRefPixelData) // Current and previous pixels share similar value.
@@ -514,8 +585,9 @@ void Proce_MessageLoop_StreamImage(TASK_ATTRIBUTE *ptrTask)
 				}  // Loop index
 
 				gbytTXbuffer[2] = nXposCounter;   // No. of bytes in the data packet, excluding start-of-line code, line number and payload length.
+				PROFILE_END(_PROF_RLE_LINE);
 
- 				SCB_CleanDCache();		// If we are using data cache (D-Cache), we should clean the data cache
+ 				CacheCleanRange(gbytTXbuffer, nXposCounter+3);	// If we are using data cache (D-Cache), we should clean the data cache
  										// (D-Cache) before enabling the DMA. Otherwise when XDMAC access data
  										// from the cache, it may not contains the correct and up-to-date data.  
  				XDMAC->XDMAC_CHID[1].XDMAC_CSA = (uint32_t) gbytTXbuffer;	// Set source start address.
@@ -530,6 +602,8 @@ void Proce_MessageLoop_StreamImage(TASK_ATTRIBUTE *ptrTask)
 				{
 					gnSendSecondaryInfo = 1;		// Set flag to transmit secondary info to host at the end of each frame.
 					nLineCounter = 0;				// Reset line counter.
+					CameraReleaseFrame(ptrFrame);	// Return the frame to the camera driver.
+					ptrFrame = NULL;
 				}
 
 				OSSetTaskContext(ptrTask, 4, 1);    // Next state = 4, timer = 1.
@@ -585,7 +659,7 @@ void Proce_MessageLoop_StreamImage(TASK_ATTRIBUTE *ptrTask)
 
 				gbytTXbuffer[2] = nXposCounter;   // No. of bytes in the data packet, excluding start-of-line code, line number and payload length.
 
-				SCB_CleanDCache();		// If we are using data cache (D-Cache), we should clean the data cache
+				CacheCleanRange(gbytTXbuffer, nXposCounter+3);	// If we are using data cache (D-Cache), we should clean the data cache
 				// (D-Cache) before enabling the DMA. Otherwise when XDMAC access data
 				// from the cache, it may not contains the correct and up-to-date data.
 				XDMAC->XDMAC_CHID[1].XDMAC_CSA = (uint32_t) gbytTXbuffer;	// Set source start address.
@@ -624,7 +698,7 @@ void Proce_MessageLoop_StreamImage(TASK_ATTRIBUTE *ptrTask)
 			}
 			else  // Yes, still has pending data to send via UART.
 			{
-				OSSetTaskContext(ptrTask, 4, 1);     // Next state = 4, timer = 1.
+				OSWaitEvent(ptrTask, __EVENT_UART_TXDONE, 0);	// Sleep until the transmission ends.
 			}
 			break;
 
@@ -654,7 +728,7 @@ void Proce_MessageLoop_StreamImage(TASK_ATTRIBUTE *ptrTask)
 			}
 			else
 			{
-				OSSetTaskContext(ptrTask, 5, 1);			// Next state = 5, timer = 1.
+				OSWaitEvent(ptrTask, __EVENT_UART_RXRDY, 0);	// Sleep until the start signal.
 			}
 			break;
 
@@ -689,7 +763,7 @@ void Proce_MessageLoop_StreamImage(TASK_ATTRIBUTE *ptrTask)
 			gbytTXbuffer[21] = gnDebug2>>16;		// Debug byte2 3.
 			gbytTXbuffer[22] = gnDebug2>>24;		// Debug byte2 4.
 
- 			SCB_CleanDCache();		// If we are using data cache (D-Cache), we should clean the data cache
+ 			CacheCleanRange(gbytTXbuffer, 23);	// If we are using data cache (D-Cache), we should clean the data cache
  									// (D-Cache) before enabling the DMA. Otherwise when XDMAC access data
  									// from the cache, it may not contains the up-to-date and correct data.  
  			XDMAC->XDMAC_CHID[1].XDMAC_CSA = (uint32_t) gbytTXbuffer;	// Set source start address.
@@ -710,7 +784,7 @@ void Proce_MessageLoop_StreamImage(TASK_ATTRIBUTE *ptrTask)
 			}
 			else  // Yes, still has pending data to send via UART.
 			{
-				OSSetTaskContext(ptrTask, 7, 1);    // Next state = 7, timer = 1.
+				OSWaitEvent(ptrTask, __EVENT_UART_TXDONE, 0);	// Sleep until the transmission ends.
 			}
 			break;
 			
@@ -726,6 +800,62 @@ void Proce_MessageLoop_StreamImage(TASK_ATTRIBUTE *ptrTask)
 			OSSetTaskContext(ptrTask, 1, 10*__NUM_SYSTEMTICK_MSEC);     // Next state = 1, timer = 10 msec.
 			break;
 			
+			case 12: // State 12 - Send the profile dump one packet at a time, see nProfilePacket() in os_Profile.c.
+			if (gSCIstatus.bTXRDY == 0)				// Check if UART port is not busy.
+			{
+				nTemp = nProfilePacket(gbytTXbuffer, nPacketCounter);
+				if (nTemp > 0)
+				{
+					CacheCleanRange(gbytTXbuffer, nTemp);						// Clean the D-Cache before enabling the DMA.
+					XDMAC->XDMAC_CHID[1].XDMAC_CSA = (uint32_t) gbytTXbuffer;	// Set source start address.
+					XDMAC->XDMAC_CHID[1].XDMAC_CUBC = XDMAC_CUBC_UBLEN(nTemp);	// Set number of bytes to transmit.
+					XDMAC->XDMAC_GE = XDMAC_GE_EN1;								// Enable channel 1 of XDMAC.
+					gSCIstatus.bTXDMAEN = 1;									// Indicate UART transmit with DMA.
+					gSCIstatus.bTXRDY = 1;										// Initiate TX.
+					PIN_LED2_SET;												// Lights up indicator LED2.
+					nPacketCounter++;
+					OSSetTaskContext(ptrTask, 12, 1);	// Next state = 12, timer = 1.
+				}
+				else								// All packets sent, start a new profiling interval.
+				{
+					ProfileReset();
+					OSSetTaskContext(ptrTask, 1, 1);	// Next state = 1, timer = 1.
+				}
+			}
+			else
+			{
+				OSWaitEvent(ptrTask, __EVENT_UART_TXDONE, 0);	// Sleep until the transmission ends.
+			}
+			break;
+			
+			case 13: // State 13 - Send the task statistics one packet at a time, see nTaskStatPacket() in os_Profile.c.
+			if (gSCIstatus.bTXRDY == 0)				// Check if UART port is not busy.
+			{
+				nTemp = nTaskStatPacket(gbytTXbuffer, nPacketCounter);
+				if (nTemp > 0)
+				{
+					CacheCleanRange(gbytTXbuffer, nTemp);						// Clean the D-Cache before enabling the DMA.
+					XDMAC->XDMAC_CHID[1].XDMAC_CSA = (uint32_t) gbytTXbuffer;	// Set source start address.
+					XDMAC->XDMAC_CHID[1].XDMAC_CUBC = XDMAC_CUBC_UBLEN(nTemp);	// Set number of bytes to transmit.
+					XDMAC->XDMAC_GE = XDMAC_GE_EN1;								// Enable channel 1 of XDMAC.
+					gSCIstatus.bTXDMAEN = 1;									// Indicate UART transmit with DMA.
+					gSCIstatus.bTXRDY = 1;										// Initiate TX.
+					PIN_LED2_SET;												// Lights up indicator LED2.
+					nPacketCounter++;
+					OSSetTaskContext(ptrTask, 13, 1);	// Next state = 13, timer = 1.
+				}
+				else								// All packets sent, start a new accounting interval.
+				{
+					TaskStatReset();
+					OSSetTaskContext(ptrTask, 1, 1);	// Next state = 1, timer = 1.
+				}
+			}
+			else
+			{
+				OSWaitEvent(ptrTask, __EVENT_UART_TXDONE, 0);	// Sleep until the transmission ends.
+			}
+			break;
+			
 			default:
 			OSSetTaskContext(ptrTask, 0, 1); // Back to state = 0, timer = 1.
 			break;
@@ -793,34 +923,11 @@ tf.keras.layers.Dense(_DNN2_node, activation='softmax')
 void Proce_Image4(TASK_ATTRIBUTE *ptrTask)
 {
 	static	int	nCurrentFrame;
+	static	FRAME_BUFFER *ptrFrame;			// Frame being processed, held until Layer 0 is completed.
+	static	FRAME_TIMESTAMP strcSourceStart;	// Start of capture of the frame being processed.
+	unsigned int unFrameSeq;
 	
 	
-	// Number of nodes in dense neural network (DNN) layer 1
-	#define		__FLATTENNODE			__LAYER0_CHANNEL*(__LAYER0_X/2)*(__LAYER0_Y/2)
-											
-	#define		__LIMIT_CNN_FLATTEN		544	// Integer coefficients for DNN1 layer,  no Sobel pre-processing of luminance data in driver.
-											// Frame rate (fps)        ROI Area (pixels)
-											// 20.83                    50x70       	
-											 
-											// This value sets the max number of path or weight to compute for a node
-											// in a DNN layer. It depends on the bandwidth of the MCU and other tasks  
-											// and is determined experimentally. At present this is the only user task,
-											// apart from the streaming routine. If more than user tasks are added, 
-											// then this limit needs to be reduced further. As an example, suppose
-											// we have Layer N with 1000 nodes map to Layer N+1 with 25 nodes in a
-											// DNN structure.  To compute the value in node k in Layer N+1, we need
-											// to: 
-											// (1) Multiply the output of 1000 nodes in Layer N with the respective
-											// weights, 
-											// (2) Accumulate the results and add a bias, then
-											// (3) Apply an activation function in node k in Layer N+1.  
-											// Step (1) is the most time consuming and to limit this operating within
-											// one Systick, we cap the maximum number of multiply-and-accumulate
-											// operation.  Thus for this example, in the 1st cycle the system will
-											// perform multiply-and-accumulate for 1st 864 outputs from Layer N, then
-											// the 2nd cycle will perform subsequent 126 multiply-and-accumulate 
-											// operations.  In other words Step (1) will require 2 Systicks to complete.
-											// A smaller __LIMIT_CNN_FLATTEN would entails more Systicks cycle.
 	static	int ni, nj;
 	static	int ni2, nj2, nfilter;
 	static	int	nFilA[9];
@@ -833,19 +940,27 @@ void Proce_Image4(TASK_ATTRIBUTE *ptrTask)
 	static  int	nResFlat[__FLATTENNODE];	// 1D array to store the flatten nodes for Fully Connected Network.
 	static  int nResFlatOffset;
    
-	static	int nNode;
 	static  int nStartIndex;
 	static  int nStopIndex;
-	static	int64_t lnsTemp;
-	int64_t	lnTemp2;
-	int64_t	lnBias;
+	#ifndef		__OS_COROUTINE
+	static	CNN_DENSE1 strcDense;			// Progress of DNN1 between the Systicks.
+	#endif
 	static  int nDNN1Out[__DNN1NODE];		// Nodes for dense layer 1.
 	static  int nDNN2Out[__DNN2NODE];		// Nodes for dense layer 2.
 	static  int nObjectPresent;
-    static  int nCompCount;
+	#ifdef		__OS_PROFILE
+	int		nProfileID = -1;				// Marker of the current state.
+	#endif
 	
 	if (ptrTask->nTimer == 0)
 	{
+		#ifdef		__OS_PROFILE
+		if ((ptrTask->nState >= 0) && (ptrTask->nState < _PROF_IPA4_STATES))
+		{
+			nProfileID = _PROF_IPA4_STATE + ptrTask->nState;
+			PROFILE_BEGIN(nProfileID);
+		}
+		#endif
 		switch (ptrTask->nState)
 		{
 			case 0: // State 0 - Initialization and check if camera is ready.
@@ -854,30 +969,31 @@ void Proce_Image4(TASK_ATTRIBUTE *ptrTask)
 				gnCameraLED = 1;					// Set camera LED intensity to low.
 				nObjectPresent = 0;
 				nCurrentFrame = gnFrameCounter;		// Set frame counter to be same as current frame.
+				CameraSubscribe(ptrTask, _CAMERA_ATT_LUMINANCE);	// Only the luminance is needed by the CNN.
+				CameraSetWindow(ptrTask, __ROI_STARTX, __ROI_STARTY, __ROI_WIDTH, __ROI_HEIGHT);	// Only the ROI is analyzed.
 				OSSetTaskContext(ptrTask, 1, 10*__NUM_SYSTEMTICK_MSEC);     // Next state = 1, timer = 10 msec.
 			}
 			else
 			{
-				OSSetTaskContext(ptrTask, 0, 1*__NUM_SYSTEMTICK_MSEC);     // Next state = 0, timer = 1 msec.
+				OSWaitEvent(ptrTask, __EVENT_CAMERA_READY, 0);	// Sleep until the camera driver is ready.
 			}
 			break;
 
 			case 1: // State 1 - Wait until a new frame is acquired in the image buffer before start processing.
-			if (gnFrameCounter != nCurrentFrame)			// Check if new image frame has been captured.
+			ptrFrame = ptrCameraAcquireFrame(&unFrameSeq);	// Get the newest frame.
+			if ((ptrFrame != NULL) && ((int) unFrameSeq != nCurrentFrame))	// Check if new image frame has been captured.
 			{
 				PIN_FLAG4_SET;								// Set debug flag.	
-				nCurrentFrame = gnFrameCounter;				// Update current frame counter.
+				nCurrentFrame = unFrameSeq;					// Update current frame counter.
+				strcSourceStart = ptrFrame->strcCaptureStart;	// Kept as the frame is released after Layer 0.
 				// Set up the variables controlling the region of the image to analyze.
 				nROI_Startx = __ROI_STARTX;
 				nROI_Stopx = __ROI_STARTX + __ROI_WIDTH;
 				nROI_Starty = __ROI_STARTY;
 				nROI_Stopy = __ROI_STARTY + __ROI_HEIGHT;	
 				nfilter = 0;								// Index to filter. Start with filter 0.
-				nNode = 0;									// Index to DNN node. Start with node 0.	
 				//OSSetTaskContext(ptrTask, 2, 1);			// Next state = 2, timer = 1.
 				
-				nCompCount = 0;
-				
 				nFilA[0] = gnL1f[nfilter][0][0];			// Get the coefficients of the filter matrix and bias.
 				nFilA[1] = gnL1f[nfilter][0][1];			// Note that the coefficients are normalized to integer
 				nFilA[2] = gnL1f[nfilter][0][2];			// between -1,000,000 to +1,000,000.
@@ -895,7 +1011,11 @@ void Proce_Image4(TASK_ATTRIBUTE *ptrTask)
 			}
 			else
 			{
-				OSSetTaskContext(ptrTask, 1, 1);			// Next state = 1, timer = 1.
+				if (ptrFrame != NULL)
+				{
+					CameraReleaseFrame(ptrFrame);			// Same frame as before, release it.
+				}
+				OSWaitEvent(ptrTask, __EVENT_FRAME_COMPLETE, 0);	// Sleep until the next frame.
 			}
 			break;
 			
@@ -926,10 +1046,11 @@ void Proce_Image4(TASK_ATTRIBUTE *ptrTask)
 			ni2 = 0;										// Reset index to store temporary results from
 															// 2D convolution operation.
 			// --- Conv2D operation on two consecutive rows ---
+			PROFILE_BEGIN(_PROF_CNN_CONV);
 			for (ni = nROI_Startx; ni < nROI_Stopx - (__FILTER_SIZE-1); ni = ni + __FILTER_STRIDE)
 			{				
-				nConvRes1[ni2] = nConv2D(ni,nj, nFilA, nBias);						// Row 1.
-				nConvRes2[ni2] = nConv2D(ni,nj + __FILTER_STRIDE, nFilA, nBias);	// Row 2.
+				nConvRes1[ni2] = nConv2D(ptrFrame, ni,nj, nFilA, nBias);						// Row 1.
+				nConvRes2[ni2] = nConv2D(ptrFrame, ni,nj + __FILTER_STRIDE, nFilA, nBias);	// Row 2.
 				ni2++;
 			}	
 			
@@ -941,6 +1062,7 @@ void Proce_Image4(TASK_ATTRIBUTE *ptrTask)
 				nj2++;									// Next element in the flatten array.
 			}
 			nResFlatOffset = nResFlatOffset + nj2;		// Update offset index for result of flatten array.					
+			PROFILE_END(_PROF_CNN_CONV);
 			nj = nj + __FILTER_STRIDE;					// Advance the vertical index 2x the stride.
 			nj = nj + __FILTER_STRIDE;					// distance.
 										
@@ -955,8 +1077,10 @@ void Proce_Image4(TASK_ATTRIBUTE *ptrTask)
 				nfilter++;									// Next filter.
 				if (nfilter == __LAYER0_CHANNEL)			// Check if all convolution filters are attended to.
 				{
-					lnsTemp = 0;							// Clear the 64-bits accumulator register first.
-					ni = 0;									// Initialize index to point to 1st output of Flatten layer. 
+					CameraReleaseFrame(ptrFrame);			// Layer 0 completed, the frame is no longer needed.
+					#ifndef		__OS_COROUTINE
+					CNNDense1Init(&strcDense);				// Start DNN1 from the 1st output of Flatten layer.
+					#endif
 					OSSetTaskContext(ptrTask, 4, 1);		// Next state = 4, timer = 1.
 				}
 				else
@@ -984,10 +1108,11 @@ void Proce_Image4(TASK_ATTRIBUTE *ptrTask)
 			ni2 = 0;										// Reset index to store temporary results from
 															// 2D convolution operation.
 			// --- Conv2D operation on two consecutive rows ---
+			PROFILE_BEGIN(_PROF_CNN_CONV);
 			for (ni = nROI_Startx; ni < nROI_Stopx - (__FILTER_SIZE-1); ni = ni + __FILTER_STRIDE)
 			{
-				nConvRes1[ni2] = nConv2D(ni,nj, nFilA, nBias);						// Row 1.
-				nConvRes2[ni2] = nConv2D(ni,nj + __FILTER_STRIDE, nFilA, nBias);	// Row 2.
+				nConvRes1[ni2] = nConv2D(ptrFrame, ni,nj, nFilA, nBias);						// Row 1.
+				nConvRes2[ni2] = nConv2D(ptrFrame, ni,nj + __FILTER_STRIDE, nFilA, nBias);	// Row 2.
 				ni2++;
 			}
 			
@@ -999,6 +1124,7 @@ void Proce_Image4(TASK_ATTRIBUTE *ptrTask)
 				nj2++;									// Next element in the flatten array.
 			}
 			nResFlatOffset = nResFlatOffset + nj2;		// Update offset index for result of flatten array.		
+			PROFILE_END(_PROF_CNN_CONV);
 			nj = nj + __FILTER_STRIDE;					// Advance the vertical index 2x the stride.
 			nj = nj + __FILTER_STRIDE;					// distance.
 			
@@ -1013,8 +1139,10 @@ void Proce_Image4(TASK_ATTRIBUTE *ptrTask)
 				nfilter++;									// Next filter.
 				if (nfilter == __LAYER0_CHANNEL)			// Check if all convolution filters are attended to.
 				{
-					lnsTemp = 0;							// Clear the 64-bits accumulator register first.
-					ni = 0;									// Initialize index to point to 1st output of Flatten layer. 
+					CameraReleaseFrame(ptrFrame);			// Layer 0 completed, the frame is no longer needed.
+					#ifndef		__OS_COROUTINE
+					CNNDense1Init(&strcDense);				// Start DNN1 from the 1st output of Flatten layer.
+					#endif
 					OSSetTaskContext(ptrTask, 4, 1);		// Next state = 4, timer = 1.
 				}
 				else
@@ -1042,10 +1170,11 @@ void Proce_Image4(TASK_ATTRIBUTE *ptrTask)
 			ni2 = 0;										// Reset index to store temporary results from
 			// 2D convolution operation.
 			// --- Conv2D operation on two consecutive rows ---
+			PROFILE_BEGIN(_PROF_CNN_CONV);
 			for (ni = nROI_Startx; ni < nROI_Stopx - (__FILTER_SIZE-1); ni = ni + __FILTER_STRIDE)
 			{
-				nConvRes1[ni2] = nConv2D(ni,nj, nFilA, nBias);						// Row 1.
-				nConvRes2[ni2] = nConv2D(ni,nj + __FILTER_STRIDE, nFilA, nBias);	// Row 2.
+				nConvRes1[ni2] = nConv2D(ptrFrame, ni,nj, nFilA, nBias);						// Row 1.
+				nConvRes2[ni2] = nConv2D(ptrFrame, ni,nj + __FILTER_STRIDE, nFilA, nBias);	// Row 2.
 				ni2++;
 			}
 			
@@ -1057,6 +1186,7 @@ void Proce_Image4(TASK_ATTRIBUTE *ptrTask)
 				nj2++;									// Next element in the flatten array.
 			}
 			nResFlatOffset = nResFlatOffset + nj2;		// Update offset index for result of flatten array.
+			PROFILE_END(_PROF_CNN_CONV);
 			nj = nj + __FILTER_STRIDE;					// Advance the vertical index 2x the stride.
 			nj = nj + __FILTER_STRIDE;					// distance.
 			
@@ -1071,8 +1201,10 @@ void Proce_Image4(TASK_ATTRIBUTE *ptrTask)
 				nfilter++;									// Next filter.
 				if (nfilter == __LAYER0_CHANNEL)			// Check if all convolution filters are attended to.
 				{
-					lnsTemp = 0;							// Clear the 64-bits accumulator register first.
-					ni = 0;									// Initialize index to point to 1st output of Flatten layer.
+					CameraReleaseFrame(ptrFrame);			// Layer 0 completed, the frame is no longer needed.
+					#ifndef		__OS_COROUTINE
+					CNNDense1Init(&strcDense);				// Start DNN1 from the 1st output of Flatten layer.
+					#endif
 					OSSetTaskContext(ptrTask, 4, 1);		// Next state = 4, timer = 1.
 				}
 				else
@@ -1100,10 +1232,11 @@ void Proce_Image4(TASK_ATTRIBUTE *ptrTask)
 			ni2 = 0;										// Reset index to store temporary results from
 															// 2D convolution operation.
 			// --- Conv2D operation on two consecutive rows ---
+			PROFILE_BEGIN(_PROF_CNN_CONV);
 			for (ni = nROI_Startx; ni < nROI_Stopx - (__FILTER_SIZE-1); ni = ni + __FILTER_STRIDE)
 			{
-				nConvRes1[ni2] = nConv2D(ni,nj, nFilA, nBias);						// Row 1.
-				nConvRes2[ni2] = nConv2D(ni,nj + __FILTER_STRIDE, nFilA, nBias);	// Row 2.
+				nConvRes1[ni2] = nConv2D(ptrFrame, ni,nj, nFilA, nBias);						// Row 1.
+				nConvRes2[ni2] = nConv2D(ptrFrame, ni,nj + __FILTER_STRIDE, nFilA, nBias);	// Row 2.
 				ni2++;
 			}
 			
@@ -1115,6 +1248,7 @@ void Proce_Image4(TASK_ATTRIBUTE *ptrTask)
 				nj2++;									// Next element in the flatten array.
 			}
 			nResFlatOffset = nResFlatOffset + nj2;		// Update offset index for result of flatten array.		
+			PROFILE_END(_PROF_CNN_CONV);
 			nj = nj + __FILTER_STRIDE;					// Advance the vertical index 2x the stride.
 			nj = nj + __FILTER_STRIDE;					// distance.										
 										
@@ -1130,8 +1264,10 @@ void Proce_Image4(TASK_ATTRIBUTE *ptrTask)
 				nfilter++;									// Next filter.
 				if (nfilter == __LAYER0_CHANNEL)			// Check if all convolution filters are attended to.
 				{
-					lnsTemp = 0;							// Clear the 64-bits accumulator register first.
-					ni = 0;									// Initialize index to point to 1st output of Flatten layer. 
+					CameraReleaseFrame(ptrFrame);			// Layer 0 completed, the frame is no longer needed.
+					#ifndef		__OS_COROUTINE
+					CNNDense1Init(&strcDense);				// Start DNN1 from the 1st output of Flatten layer.
+					#endif
 					OSSetTaskContext(ptrTask, 4, 1);		// Next state = 4, timer = 1.
 				}
 				else
@@ -1156,46 +1292,16 @@ void Proce_Image4(TASK_ATTRIBUTE *ptrTask)
 			break;
 			
 			case 4: // State 4 - Compute the output of each nodes in Layer DNN1.
+			#ifdef		__OS_COROUTINE
+			gptrnCNNFlat = nResFlat;					// The dense layers are computed by CoTask_CNNDense().
+			gptrnCNNOut = nDNN2Out;
+			OSSignalEvent(__EVENT_CNN_START);
+			OSSetTaskContext(ptrTask, 5, 0);			// Next state = 5.
+			OSWaitEvent(ptrTask, __EVENT_CNN_DONE, 0);	// Sleep until the output of DNN2 is ready.
+			#else
 			PIN_FLAG4_SET;
-			while (nCompCount < __LIMIT_CNN_FLATTEN)	// Check if reach the BW if one Systick.
-			{
-				lnTemp2 = nResFlat[ni];					// Load and convert to 64 bits integer.
-				nTemp = gnDNN1w[ni][nNode];				// Load 32 bits integer coefficients.
-				lnsTemp = lnsTemp + (lnTemp2*nTemp);	// Multiply and accumulate.	
-														// 9 May 2020: Initially I use 64 bits integer to
-														// store both multiplicands.  I discovered that if
-														// one of the multiplicands is 32 bits integer, the
-														// execution time will be halved. If both multiplicands
-														// are 32-bits integer, then overflow occurs.							
-				ni++;									// Increment index.
-				nCompCount++;							// Increment computation counter.
-				if (ni >= __FLATTENNODE)				// Check if reach end of flatten input for current DNN1 node.
-				{
-					lnBias = gnDNN1bias[nNode];			// Note: 19 May 2020. I discovered that because gnDNN1bias[]
-														// is a 32-bits integer register, if we use
-														// gnDNN1bias[nNode]*1000000, overflow will occur. Somehow
-														// the processor stores the result in 32-bits register before
-														// converting to 64-bits long integer.  This causes overflow.
-					lnBias = lnBias*1000000;			// Thus we need to divide this into two steps.
-					lnsTemp = lnsTemp + lnBias;			// Add bias.
-					nDNN1Out[nNode] = lnsTemp/1000000;	// Scale back to 32 bits integer.
-					// ReLu activation function
-					if (nDNN1Out[nNode] < 0)
-					{
-						nDNN1Out[nNode] = 0;
-					}					
-					
-					ni = 0;								// Reset index.
-					lnsTemp = 0;						// Clear the 64-bits accumulator register first.					
-					nNode++;							// Point to next node in layer.
-					if (nNode >= __DNN1NODE)			// Check if output for all nodes in layer are computed.
-					{
-						break;
-					}
-				}
-			}
-			nCompCount = 0;								// Reset computation counter.
-			if (nNode < __DNN1NODE)						// Check for end of nodes in DNN1.
+			PROFILE_BEGIN(_PROF_CNN_DENSE1);
+			if (nCNNDense1(&strcDense, nResFlat, nDNN1Out) == 0)	// Stop when the cycles of the Systick are used up.
 			{		
 				OSSetTaskContext(ptrTask, 4, 1);		// Next state = 4, timer = 1.	
 			}
@@ -1203,7 +1309,9 @@ void Proce_Image4(TASK_ATTRIBUTE *ptrTask)
 			{
 				OSSetTaskContext(ptrTask, 5, 1);		// Next state = 5, timer = 1.
 			}
+			PROFILE_END(_PROF_CNN_DENSE1);
 			PIN_FLAG4_CLEAR;
+			#endif
 			break;
 			
 			/*
@@ -1276,25 +1384,13 @@ void Proce_Image4(TASK_ATTRIBUTE *ptrTask)
 			*/
 			
 			case 5: // State 5 - Compute the output of each nodes in Layer DNN2.
+			#ifndef		__OS_COROUTINE
 			PIN_FLAG4_SET;
-			
-			for (nNode = 0; nNode < __DNN2NODE; nNode++)
-			{
-				lnsTemp = 0;							// Clear temp 64-bits register first.
-				for (ni = 0; ni < __DNN1NODE; ni++)
-				{
-					lnTemp2 = nDNN1Out[ni];				// Load and convert to 64 bits integer.
-					//nTemp = 1000000*gfDNN2w[ni][nNode];	// Load and convert to 32 bits integer.
-					nTemp = gnDNN2w[ni][nNode];				// Load 32 bits integer coefficient.
-					lnsTemp = lnsTemp + (lnTemp2*nTemp);	// Multiply and accumulate.
-				}
-				//lnBias = gfDNN2bias[nNode]*1000000000000;
-				lnBias = gnDNN2bias[nNode];
-				lnBias = lnBias*1000000;
-				lnsTemp = lnsTemp + lnBias;				// Add bias.
-				nDNN2Out[nNode] = lnsTemp/1000000;		// Scale back to 32 bits integer.				
-			}
+			PROFILE_BEGIN(_PROF_CNN_DENSE2);
+			CNNDense2(nDNN1Out, nDNN2Out);
+			PROFILE_END(_PROF_CNN_DENSE2);
 			PIN_FLAG4_CLEAR;
+			#endif
 			
 			// Softmax output function
 			// In softmax, the output of each node is converted to probability.  As the output value of each
@@ -1364,6 +1460,10 @@ void Proce_Image4(TASK_ATTRIBUTE *ptrTask)
 				gobjRec1.nWidth = 0 ;			// software.
 			}
 			
+			gstrcIPA4Result.nResult = nObjectPresent;		// Publish the result with the source frame and
+			gstrcIPA4Result.unFrameSeq = nCurrentFrame;		// the capture-to-result latency.
+			gstrcIPA4Result.unLatencyUS = unCameraElapsedUS(&strcSourceStart);
+			
 			// --- Debug routines ---
 			//gnDebug = nDNN2Out[0];
 			gnDebug2 = nDNN2Out[1];
@@ -1391,19 +1491,25 @@ void Proce_Image4(TASK_ATTRIBUTE *ptrTask)
 			}				
 			break;
 			
-			case 6: // State 6 - Continue to transfer the last 2 bytes of data to host controller.
+			case 6: // State 6 - Continue to transfer the last 2 bytes of data to host controller, the capture-to-result
+					// latency in msec (255 = 255 msec or more) and the lowest 8 bits of the source frame sequence no.
 			PIN_FLAG4_SET;
 			if (gSCIstatus2.bTXRDY == 0)		// Check if any data to send via UART.
 			{
-				gbytTXbuffer2[0] = 0;			// 
-				gbytTXbuffer2[1] = 0;			// 
+				nTemp = gstrcIPA4Result.unLatencyUS / 1000;
+				if (nTemp > 255)
+				{
+					nTemp = 255;
+				}
+				gbytTXbuffer2[0] = nTemp;		// Latency in msec.
+				gbytTXbuffer2[1] = gstrcIPA4Result.unFrameSeq;	// Source frame.
 				gbytTXbuflen2 = 2;				// Set TX frame length.
 				gSCIstatus2.bTXRDY = 1;			// Initiate TX.
 				OSSetTaskContext(ptrTask, 1, 1);      // Next state = 1, timer = 1.
 			}
 			else
 			{
-				OSSetTaskContext(ptrTask, 6, 1);	// Next state = 6, timer = 1.
+				OSWaitEvent(ptrTask, __EVENT_USART0_TXDONE, 0);	// Sleep until the transmission ends.
 			}
 			PIN_FLAG4_CLEAR;
 			//OSSetTaskContext(ptrTask, 1, 1);	// Next state = 1, timer = 1.
@@ -1413,43 +1519,72 @@ void Proce_Image4(TASK_ATTRIBUTE *ptrTask)
 			OSSetTaskContext(ptrTask, 0, 1);		// Back to state = 0, timer = 1.
 			break;
 		}
+		#ifdef		__OS_PROFILE
+		if (nProfileID >= 0)
+		{
+			PROFILE_END(nProfileID);
+		}
+		#endif
 	}
 }
 
+#ifdef		__OS_COROUTINE
+///
+/// Function name	: CoTask_CNNDense
+///
+/// Author			: Fabian Kung
+///
+/// Last modified	: 16 Oct 2026
+///
+/// Code Version	: 1.00
+///
+/// Processor		: ARM Cortex-M7 family
+///
+/// Description		: Co-task to compute the dense layers DNN1 and DNN2 of the CNN in Proce_Image4(),
+///                   see os_Coroutine.h.  The computation starts when Proce_Image4() signals
+///                   __EVENT_CNN_START, and yields when the cycles of the Systick are used up.  The
+///                   indices and the accumulator of DNN1 are local variables of nested loops, so
+///                   there is no state to save and reload at each Systick as in Proce_Image4()
+///                   state 4, see CNNDenseCoTask() in CNN_Dense.h.
+///
+/// Arguments		: None.
+///
+/// Return			: None.
+///
+/// Global variable	: gptrnCNNFlat, gptrnCNNOut
+///
+void CoTask_CNNDense(void)
+{
+	while (1)
+	{
+		unOSCoWaitEvent(__EVENT_CNN_START, 0);	// Sleep until the flatten nodes are ready.
+		CNNDenseCoTask(gptrnCNNFlat, gptrnCNNOut);
+		OSSignalEvent(__EVENT_CNN_DONE);		// Wake up Proce_Image4().
+	}
+}
+#endif
+
 // Function to compute the 3x3 convolution operation on a small region 
 // of the image buffer.
+// ptrFrame = Frame buffer, obtained from ptrCameraAcquireFrame().
 // ni, nj = (x,y) coordinate of start pixel in 3x3 image patch.
 // nFilA = Address of array containing the 9 coefficients of the kernel or filter.
 // nBias = Bias value.
-__INLINE int	nConv2D(int ni, int nj, int * nFilA, int nBias)
+__INLINE int	nConv2D(FRAME_BUFFER *ptrFrame, int ni, int nj, int * nFilA, int nBias)
 {
 	int	nLuminance[9];
 	int nTemp;
 	
-	if (gnValidFrameBuffer == 1)					// Check frame buffer data valid flag.  If equals 1 means gunImgAtt2[] data
-	{
-		nLuminance[0] = gunImgAtt2[ni][nj] & _LUMINANCE_MASK; // Extract the 7-bits luminance value.
-		nLuminance[1] = gunImgAtt2[ni+1][nj] & _LUMINANCE_MASK;
-		nLuminance[2] = gunImgAtt2[ni+2][nj] & _LUMINANCE_MASK;
-		nLuminance[3] = gunImgAtt2[ni][nj+1] & _LUMINANCE_MASK;
-		nLuminance[4] = gunImgAtt2[ni+1][nj+1] & _LUMINANCE_MASK;
-		nLuminance[5] = gunImgAtt2[ni+2][nj+1] & _LUMINANCE_MASK;
-		nLuminance[6] = gunImgAtt2[ni][nj+2] & _LUMINANCE_MASK;
-		nLuminance[7] = gunImgAtt2[ni+1][nj+2] & _LUMINANCE_MASK;
-		nLuminance[8] = gunImgAtt2[ni+2][nj+2] & _LUMINANCE_MASK;
-	}
-	else
-	{
-		nLuminance[0] = gunImgAtt[ni][nj] & _LUMINANCE_MASK; // Extract the 7-bits luminance value.
-		nLuminance[1] = gunImgAtt[ni+1][nj] & _LUMINANCE_MASK;
-		nLuminance[2] = gunImgAtt[ni+2][nj] & _LUMINANCE_MASK;
-		nLuminance[3] = gunImgAtt[ni][nj+1] & _LUMINANCE_MASK;
-		nLuminance[4] = gunImgAtt[ni+1][nj+1] & _LUMINANCE_MASK;
-		nLuminance[5] = gunImgAtt[ni+2][nj+1] & _LUMINANCE_MASK;
-		nLuminance[6] = gunImgAtt[ni][nj+2] & _LUMINANCE_MASK;
-		nLuminance[7] = gunImgAtt[ni+1][nj+2] & _LUMINANCE_MASK;
-		nLuminance[8] = gunImgAtt[ni+2][nj+2] & _LUMINANCE_MASK;
-	}
+	// Each row of the 3x3 image patch is contiguous in the luminance plane.
+	nLuminance[0] = _FRAME_LUM(ptrFrame, ni, nj) & _LUMINANCE_MASK; // Extract the 7-bits luminance value.
+	nLuminance[1] = _FRAME_LUM(ptrFrame, ni+1, nj) & _LUMINANCE_MASK;
+	nLuminance[2] = _FRAME_LUM(ptrFrame, ni+2, nj) & _LUMINANCE_MASK;
+	nLuminance[3] = _FRAME_LUM(ptrFrame, ni, nj+1) & _LUMINANCE_MASK;
+	nLuminance[4] = _FRAME_LUM(ptrFrame, ni+1, nj+1) & _LUMINANCE_MASK;
+	nLuminance[5] = _FRAME_LUM(ptrFrame, ni+2, nj+1) & _LUMINANCE_MASK;
+	nLuminance[6] = _FRAME_LUM(ptrFrame, ni, nj+2) & _LUMINANCE_MASK;
+	nLuminance[7] = _FRAME_LUM(ptrFrame, ni+1, nj+2) & _LUMINANCE_MASK;
+	nLuminance[8] = _FRAME_LUM(ptrFrame, ni+2, nj+2) & _LUMINANCE_MASK;
 		
 	// Convolution or cross-correlation operation with 3x3 filter. We try to avoid using for-loop to speed up the computation.
 	// Note: 24 April 2020, I have tried a few approaches, using C codes without for-loop. Verified that this method is the
@@ -11,7 +11,15 @@
 //
 // --- PUBLIC VARIABLES ---
 //
+// Result of an image processing algorithm, stamped with the frame it is computed from.
+typedef struct StructIPA_RESULT
+{
+	int				nResult;		// Output of the algorithm.
+	unsigned int	unFrameSeq;		// Sequence no. of the source frame, see ptrCameraAcquireFrame().
+	unsigned int	unLatencyUS;	// Time from the start of capture of the source frame to the result, in usec.
+} IPA_RESULT;
 
+extern	IPA_RESULT	gstrcIPA4Result;	// Result of Proce_Image4().
 
 //
 // --- PUBLIC FUNCTION PROTOTYPE ---
@@ -19,3 +27,9 @@
 void Proce_MessageLoop_StreamImage(TASK_ATTRIBUTE *);
 //void Proce_Image1(TASK_ATTRIBUTE *);
 void Proce_Image4(TASK_ATTRIBUTE *);
+
+#ifdef		__OS_COROUTINE
+#define		_CNN_DENSE_STACK_WORDS	256		// Stack of CoTask_CNNDense(), in 32-bits words.
+extern	uint32_t	gunCNNDenseStack[_CNN_DENSE_STACK_WORDS];
+void CoTask_CNNDense(void);
+#endif
@@ -6,16 +6,26 @@
 #include "./SAMS70_Drivers_BSP\Driver_USART0_V100.h"
 #include "./SAMS70_Drivers_BSP\Driver_I2C1_V100.h"
 #include "./SAMS70_Drivers_BSP\Driver_TCM8230.h"
+#include "./SAMS70_Drivers_BSP\os_Profile.h"
+#include "./SAMS70_Drivers_BSP\os_Coroutine.h"
 
 #include "User_Task.h"
 
 int main(void)
 {
 	int ni = 0;
+	unsigned int unTickDeadline = 0;		// Value of the cycle counter at __OS_TICK_RESERVE_CYCLES before the
+	unsigned int unBudgetEnd;				// end of the current clock tick.
+	#ifdef		__OS_TASK_STAT
+	unsigned int unCycleStart;
+	#endif
 	
 	SAMS70_Init();				// Custom initialization, see file "os_SAMS70_APIs.c".  This will overwrites the
 								// initialization done in SystemInit();
 	OSInit();                   // Custom initialization: Initialize the RTOS.
+	#if defined(__OS_PROFILE) || defined(__OS_TASK_STAT)
+	ProfileInit();				// Enable the cycle counter for the profiling markers and task statistics, see "os_Profile.c".
+	#endif
 	gnTaskCount = 0; 			// Initialize task counter.
 	
 	// Initialize core OS processes.
@@ -32,6 +42,9 @@ int main(void)
 	// Initialize user processes.
 	OSCreateTask(&gstrcTaskContext[gnTaskCount], Proce_MessageLoop_StreamImage);	// Start stream image data via UART port process.
 	OSCreateTask(&gstrcTaskContext[gnTaskCount], Proce_Image4);						// Start Image Processing Algorithm 1.
+	#ifdef		__OS_COROUTINE
+	OSCreateCoTask(&gstrcTaskContext[gnTaskCount], CoTask_CNNDense, gunCNNDenseStack, _CNN_DENSE_STACK_WORDS);	// Dense layers of the CNN.
+	#endif
 
 	while (1)
 	{	
@@ -43,6 +56,8 @@ int main(void)
 			// Note: 17 May 2020 - The following codes are not effective to detect overflow condition
 			// as we are not using interrupt service routine.  Flag gnRunTask will always be cleared
 			// even if the time taken to run all tasks is longer than 1 Systick.
+			// 16 Oct 2026 - Overrun is now detected with the cycle counter when __OS_TASK_STAT is
+			// defined, see TaskStatTickEnd() in "os_Profile.c".
 			//if (gnRunTask == 1)						// If task overflow occur trap the controller
 			//{										// indefinitely and turn on indicator LED1.
 			//	while (1)
@@ -54,14 +69,12 @@ int main(void)
 
 			gnRunTask = 1;							// Assert gnRunTask.
 			gunClockTick++; 						// Increment RTOS clock tick counter.
-			for (ni = 0; ni < gnTaskCount; ni++)	// Using for-loop produce more efficient
-													// assembly codes.
-			{
-				if (gstrcTaskContext[ni].nTimer > 0) // Only decrement timer if it is greater than zero.
-				{
-					--(gstrcTaskContext[ni].nTimer); // Decrement timer for each process.
-				}
-			}
+			unTickDeadline = DWT->CYCCNT + __SYSTEMTICK_CYCLES - __OS_TICK_RESERVE_CYCLES;
+			#ifdef		__OS_TASK_STAT
+			TaskStatTick();							// Mark the start of the system tick.
+			#endif
+			OSUpdateTaskTimer();					// Move the tasks which timer expires in this tick to the
+													// ready list, the other tasks are not visited.
 
 			OSExitCritical();						// Enable processor interrupts.
 			ClearWatchDog();						// Clear the Watch Dog Timer regularly (at least once a second).
@@ -75,17 +88,34 @@ int main(void)
 		if (gnRunTask > 0) 		// Only execute tasks/processes when gnRunTask is not 0.
 		{
 			
-			for (ni = 0; ni < gnTaskCount; ni++)
+			// Only execute a process/task if it's timer = 0, e.g. in the ready list.  A task blocked 
+			// by OSWaitEvent() is skipped until the event is signalled or timeout.  The tasks are 
+			// executed in the order of gstrcTaskContext[].
+			for (ni = nOSNextReadyTask(0); ni >= 0; ni = nOSNextReadyTask(ni + 1))
 			{
-				// Only execute a process/task if it's timer = 0.
-				if (gstrcTaskContext[ni].nTimer == 0)
+				PIOD->PIO_ODSR |= PIO_ODSR_P22;					// Set flag 2.
+				gunOSBudgetEnd = unTickDeadline;				// Set the processor cycle budget of the task, 
+				if (gstrcTaskContext[ni].nBudget > 0)			// see OSBudgetExhausted().
 				{
-					PIOD->PIO_ODSR |= PIO_ODSR_P22;					// Set flag 2.
-					// Execute user task by dereferencing the function pointer.
-					(*((TASK_POINTER)gfptrTask[ni]))(&gstrcTaskContext[ni]);
-					PIOD->PIO_ODSR &= ~PIO_ODSR_P22;				// Clear flag 2.
+					unBudgetEnd = DWT->CYCCNT + gstrcTaskContext[ni].nBudget;
+					if (((int)(unBudgetEnd - unTickDeadline)) < 0)
+					{
+						gunOSBudgetEnd = unBudgetEnd;
+					}
 				}
+				// Execute user task by dereferencing the function pointer.
+				#ifdef		__OS_TASK_STAT
+				unCycleStart = DWT->CYCCNT;
+				#endif
+				(*((TASK_POINTER)gfptrTask[ni]))(&gstrcTaskContext[ni]);
+				#ifdef		__OS_TASK_STAT
+				TaskStatRecord(ni, DWT->CYCCNT - unCycleStart);	// Update the task cycle count statistics.
+				#endif
+				PIOD->PIO_ODSR &= ~PIO_ODSR_P22;				// Clear flag 2.
 			}		
+			#ifdef		__OS_TASK_STAT
+			TaskStatTickEnd();	// Check for overrun of the system tick.
+			#endif
 			gnRunTask = 0; 		// Reset gnRunTask.
 			
 		} // if (gnRunTask > 0)
@@ -19,53 +19,152 @@
 
 // Include common header to all drivers and sources.  Here absolute path is used.
 // To edit if one changes folder
+#include <stddef.h>					// For NULL.
 #include "osmain.h"
 
 // --- GLOBAL VARIABLES AND DATAYPES DECLARATION ---
 int gnRunTask;									// Flag to determine when to run tasks.
 int gnTaskCount;								// Task counter.
 unsigned int gunClockTick;                      // Processor clock tick.
-TASK_ATTRIBUTE gstrcTaskContext[__MAXTASK-1];   // Array to store task contexts.
-TASK_POINTER gfptrTask[__MAXTASK-1];            // Array to store task pointers.
+TASK_ATTRIBUTE gstrcTaskContext[__MAXTASK];     // Array to store task contexts.
+TASK_POINTER gfptrTask[__MAXTASK];              // Array to store task pointers, NULL for empty entry.
 
 SCI_STATUS gSCIstatus;				// Status for UART and RF serial communication interface.
+unsigned int gunOSBudgetEnd;		// Value of the cycle counter when the running task has used its budget.
+
+// Tasks are referred to by their position in gstrcTaskContext[], e.g. nID - 1.
+unsigned int gunOSReadyMap[__OS_MAP_WORDS];		// Bit n is set when task n is ready to run (nTimer = 0).
+unsigned int gunOSWaitMap[__OS_MAP_WORDS];		// Bit n is set when task n waits for events.
+int gnOSWheelHead[__OS_WHEEL_SLOTS];			// First task in each slot of the timer wheel, -1 if empty.
+int gnOSWheelNext[__MAXTASK];					// Next task in the same slot, -1 if last.
+int gnOSWheelPrev[__MAXTASK];					// Previous task in the same slot, -1 if first.
+int gnOSWheelSlot[__MAXTASK];					// Slot of the task, -1 if the task is not in the timer wheel.
+unsigned int gunOSWakeTick[__MAXTASK];			// Value of gunClockTick when the timer of the task expires.
+
+#define	_OS_MAP_SET(map, n)		(map)[(n) >> 5] |= (1U << ((n) & 0x1F))
+#define	_OS_MAP_CLEAR(map, n)	(map)[(n) >> 5] &= ~(1U << ((n) & 0x1F))
+
+// --- Local function prototype ---
+static void OSSetTaskTimer(int, int);
 
 // --- RTOS FUNCTIONS ---
 
 // Function name	: OSInit()
 // Author			: Fabian Kung
-// Last modified	: 20 Nov 2015
+// Last modified	: 16 Oct 2026
 // Purpose			: Initialize the variables and parameters of the RTOS.
 // Arguments		: None.
 // Return			: None.
 void OSInit()
 {
+	int ni;
+	
 	gunClockTick = 0; 		// Initialize 32-bits RTOS global timer.
+	gnTaskCount = 0;
+	for (ni = 0; ni < __MAXTASK; ni++)
+	{
+		gfptrTask[ni] = NULL;
+		gstrcTaskContext[ni].nID = 0;
+		gnOSWheelSlot[ni] = -1;
+	}
+	for (ni = 0; ni < __OS_WHEEL_SLOTS; ni++)
+	{
+		gnOSWheelHead[ni] = -1;
+	}
+	for (ni = 0; ni < __OS_MAP_WORDS; ni++)
+	{
+		gunOSReadyMap[ni] = 0;
+		gunOSWaitMap[ni] = 0;
+	}
+}
+
+/// Function name	: OSSetTaskTimer()
+/// Author			: Fabian Kung
+/// Last modified	: 16 Oct 2026
+/// Description		: Set the timer of a task, and move the task to the ready list (nTimer = 0) or
+///					  to the slot of the timer wheel where the timer expires (nTimer > 0).  A task
+///					  with nTimer < 0 is in neither, e.g. waiting for event without timeout.
+/// Arguments		: nTask = Position of the task in gstrcTaskContext[].
+///					  nTimer = No. of clock ticks before the task executes again.
+/// Return			: None.
+static void OSSetTaskTimer(int nTask, int nTimer)
+{
+	int nSlot;
+	
+	nSlot = gnOSWheelSlot[nTask];
+	if (nSlot >= 0)								// Remove from the timer wheel.
+	{
+		if (gnOSWheelPrev[nTask] >= 0)
+		{
+			gnOSWheelNext[gnOSWheelPrev[nTask]] = gnOSWheelNext[nTask];
+		}
+		else
+		{
+			gnOSWheelHead[nSlot] = gnOSWheelNext[nTask];
+		}
+		if (gnOSWheelNext[nTask] >= 0)
+		{
+			gnOSWheelPrev[gnOSWheelNext[nTask]] = gnOSWheelPrev[nTask];
+		}
+		gnOSWheelSlot[nTask] = -1;
+	}
+	
+	gstrcTaskContext[nTask].nTimer = nTimer;
+	if (nTimer == 0)
+	{
+		_OS_MAP_SET(gunOSReadyMap, nTask);
+	}
+	else
+	{
+		_OS_MAP_CLEAR(gunOSReadyMap, nTask);
+		if (nTimer > 0)							// Insert at the head of the slot where the timer
+		{										// expires.
+			gunOSWakeTick[nTask] = gunClockTick + nTimer;
+			nSlot = gunOSWakeTick[nTask] & (__OS_WHEEL_SLOTS - 1);
+			gnOSWheelSlot[nTask] = nSlot;
+			gnOSWheelPrev[nTask] = -1;
+			gnOSWheelNext[nTask] = gnOSWheelHead[nSlot];
+			if (gnOSWheelHead[nSlot] >= 0)
+			{
+				gnOSWheelPrev[gnOSWheelHead[nSlot]] = nTask;
+			}
+			gnOSWheelHead[nSlot] = nTask;
+		}
+	}
 }
 
 /// Function name	: OSTaskCreate()
 /// Author			: Fabian Kung
-/// Last modified	: 20 Nov 2015
+/// Last modified	: 16 Oct 2026
 /// Purpose			: Add a new task to the OS's scheduler.
-/// Arguments		: ptrTaskData = A pointer to the structure structTASK.
+/// Arguments		: ptrTaskData = A pointer to the structure structTASK, an empty entry in 
+///					  gstrcTaskContext[], usually &gstrcTaskContext[gnTaskCount].
 ///                   ptrTask = a valid pointer to a user routine.
 /// Return			: 0 if success, 1 or >0 if not successful.
-/// Others			: Increment global variable gnTaskCount.
+/// Others			: gnTaskCount is 1 + the last entry used in gstrcTaskContext[].
 int OSCreateTask(TASK_ATTRIBUTE *ptrTaskData, TASK_POINTER ptrTask)
 {
-	if (gnTaskCount> __MAXTASK) 
+	int nTask = ptrTaskData - gstrcTaskContext;
+	
+	if ((nTask < 0) || (nTask >= __MAXTASK) || (gfptrTask[nTask] != NULL)) 
 	{
-		return 1;                               // Maximum tasks exceeded.
+		return 1;                               // Maximum tasks exceeded or entry in use.
 	}
 	else
 	{
 		ptrTaskData->nState = 0;		// Initialize the task's state and timer variables.
-		ptrTaskData->nTimer = 1;
+		ptrTaskData->unEventWait = 0;
+		ptrTaskData->unEvent = 0;
+		ptrTaskData->nBudget = 0;
 											
-		gfptrTask[gnTaskCount] = ptrTask;	// Assign task's address to function pointer array.
-		gnTaskCount++; 				// Increment task counter.
+		gfptrTask[nTask] = ptrTask;		// Assign task's address to function pointer array.
+		if (nTask >= gnTaskCount)
+		{
+			gnTaskCount = nTask + 1; 	// Increment task counter.
+		}
 							// Initialize the task's ID
-		ptrTaskData->nID = gnTaskCount; 	// Task's ID = current Task Count + 1.
+		ptrTaskData->nID = nTask + 1; 	// Task's ID = position in gstrcTaskContext[] + 1.
+		OSSetTaskTimer(nTask, 1);		// Start in the next clock tick.
 
 		return 0;
 	}
@@ -73,9 +172,10 @@ int OSCreateTask(TASK_ATTRIBUTE *ptrTaskData, TASK_POINTER ptrTask)
 
 /// Function name	: OSSetTaskContext()
 /// Author			: Fabian Kung
-/// Last modified	: 20 Nov 2015
+/// Last modified	: 16 Oct 2026
 /// Purpose			: Set the task's State and Timer variables.
-/// Arguments		: ptrTaskData = A pointer to the structure structTASK.
+/// Arguments		: ptrTaskData = A pointer to the structure structTASK, an entry in 
+///					  gstrcTaskContext[].
 ///					  nState = Next state of the task.
 ///					  nTimer = Timer, the no. of clock ticks before the task
 ///					  executes again.
@@ -83,33 +183,31 @@ int OSCreateTask(TASK_ATTRIBUTE *ptrTaskData, TASK_POINTER ptrTask)
 void OSSetTaskContext(TASK_ATTRIBUTE *ptrTaskData, int nState, int nTimer)
 {
 	ptrTaskData->nState = nState;
-	ptrTaskData->nTimer = nTimer;
+	OSSetTaskTimer(ptrTaskData - gstrcTaskContext, nTimer);
 }
 
 /// Function name	: OSTaskDelete()
 /// Author			: Fabian Kung
-/// Last modified	: 20 Nov 2015
-/// Description		: Delete a task from the OS's scheduler.
+/// Last modified	: 16 Oct 2026
+/// Description		: Delete a task from the OS's scheduler.  The entry in gstrcTaskContext[] 
+///					  becomes empty and can be used again by OSCreateTask(), the other tasks keep
+///					  their position and ID.
 /// Arguments		: nTaskID = An integer indicating the task ID.
 /// Return			: 0 if success, 1 or >0 if not successful.
 int OSTaskDelete(int nTaskID)
 {
-	int ni;
+	int nTask = nTaskID - 1;
 
-	if (nTaskID < gnTaskCount) // nTaskID can be from 1 to (gnTaskCount-1)
+	if ((nTask >= 0) && (nTask < gnTaskCount) && (gfptrTask[nTask] != NULL))
 	{
-		if (nTaskID < (gnTaskCount - 1))	// Shift all the elements of the gstrcTaskContext
-		{					// array down 1 position.
-			ni = nTaskID - 1;
-			while (ni < (gnTaskCount - 1))
-			{
-				gstrcTaskContext[ni].nState = gstrcTaskContext[ni + 1].nState;
-				gstrcTaskContext[ni].nTimer = gstrcTaskContext[ni + 1].nTimer;
-				gstrcTaskContext[ni].nID = gstrcTaskContext[ni + 1].nID;
-				gfptrTask[ni] = gfptrTask[ni + 1];
-				ni++;
-			}
-			gnTaskCount--; 			// There is 1 less task to execute now.
+		OSSetTaskTimer(nTask, -1);			// Remove from the timer wheel and ready list.
+		_OS_MAP_CLEAR(gunOSWaitMap, nTask);
+		gstrcTaskContext[nTask].unEventWait = 0;
+		gstrcTaskContext[nTask].nID = 0;	// ID = 0 indicates empty task.
+		gfptrTask[nTask] = NULL;
+		while ((gnTaskCount > 0) && (gfptrTask[gnTaskCount - 1] == NULL))
+		{
+			gnTaskCount--; 					// There is 1 less task to execute now.
 		}
 		return 0;
 	}
@@ -119,21 +217,148 @@ int OSTaskDelete(int nTaskID)
 	}
 }
 
+/// Function name	: OSWaitEvent()
+/// Author			: Fabian Kung
+/// Last modified	: 16 Oct 2026
+/// Description		: Block a task until one of the events is signalled with OSSignalEvent(), or
+///					  until timeout.  The task stays in the current state, and is skipped by the
+///					  Scheduler while blocked.  On return to the task ptrTaskData->unEvent holds 
+///					  the events received, 0 if timeout.  The task should check the condition
+///					  (e.g. gSCIstatus.bTXRDY) before calling this routine, as events signalled 
+///					  while the task is not waiting are not kept.  As the tasks are not pre-empted 
+///					  no event is missed between the check and the call.
+/// Arguments		: ptrTaskData = A pointer to the structure structTASK.
+///					  unEventMask = Events to wait for, see __EVENT_XXX in osmain.h.
+///					  nTimeout = No. of clock ticks before the task executes again if no event 
+///					  is signalled.  0 to wait without timeout.
+/// Return			: None.
+void OSWaitEvent(TASK_ATTRIBUTE *ptrTaskData, unsigned int unEventMask, int nTimeout)
+{
+	int nTask = ptrTaskData - gstrcTaskContext;
+	
+	ptrTaskData->unEventWait = unEventMask;
+	ptrTaskData->unEvent = 0;
+	_OS_MAP_SET(gunOSWaitMap, nTask);
+	if (nTimeout > 0)
+	{
+		OSSetTaskTimer(nTask, nTimeout);
+	}
+	else
+	{
+		OSSetTaskTimer(nTask, -1);				// Not in the timer wheel.
+	}
+}
+
+/// Function name	: OSSignalEvent()
+/// Author			: Fabian Kung
+/// Last modified	: 16 Oct 2026
+/// Description		: Wake up all tasks waiting for the events.  A task after the caller in the
+///					  gstrcTaskContext[] array executes in the same clock tick, else in the next
+///					  clock tick.  Only the tasks in gunOSWaitMap[] are checked.  Call from
+///					  tasks only, not from interrupt service routines.
+/// Arguments		: unEvent = Events to signal, see __EVENT_XXX in osmain.h.
+/// Return			: None.
+void OSSignalEvent(unsigned int unEvent)
+{
+	int nWord;
+	int nTask;
+	unsigned int unMap;
+	
+	for (nWord = 0; nWord < __OS_MAP_WORDS; nWord++)
+	{
+		unMap = gunOSWaitMap[nWord];
+		while (unMap != 0)
+		{
+			nTask = (nWord << 5) + __builtin_ctz(unMap);	// Lowest bit set.
+			unMap = unMap & (unMap - 1);					// Clear lowest bit set.
+			if ((gstrcTaskContext[nTask].unEventWait & unEvent) > 0)
+			{
+				gstrcTaskContext[nTask].unEvent = gstrcTaskContext[nTask].unEventWait & unEvent;
+				gstrcTaskContext[nTask].unEventWait = 0;
+				OSSetTaskTimer(nTask, 0);				// Ready to run.
+			}
+			if (gstrcTaskContext[nTask].unEventWait == 0)
+			{
+				_OS_MAP_CLEAR(gunOSWaitMap, nTask);
+			}
+		}
+	}
+}
+
+/// Function name	: OSSetTaskBudget()
+/// Author			: Fabian Kung
+/// Last modified	: 16 Oct 2026
+/// Description		: Set the max. processor cycles a task uses in each dispatch.  The Scheduler
+///					  sets the end of the budget before running the task, OSBudgetExhausted() 
+///					  becomes true at the end of the budget, or at __OS_TICK_RESERVE_CYCLES 
+///					  before the end of the clock tick, whichever is earlier.  A task with 0 
+///					  budget (default) can use all the cycles left in the clock tick, this is
+///					  suitable for the last task in the gstrcTaskContext[] array.
+/// Arguments		: ptrTaskData = A pointer to the structure structTASK.
+///					  nBudget = Processor cycles, 0 for the rest of the clock tick.
+/// Return			: None.
+void OSSetTaskBudget(TASK_ATTRIBUTE *ptrTaskData, int nBudget)
+{
+	ptrTaskData->nBudget = nBudget;
+}
+
 /// Function name	: OSUpdateTaskTimer()
 /// Author			: Fabian Kung
-/// Last modified	: 20 Nov 2015
-/// Description		: Update the timer attribute of each task.
+/// Last modified	: 16 Oct 2026
+/// Description		: Update the timer attribute of the tasks which timer expires in the current
+///					  clock tick, and move them to the ready list.  Call once after gunClockTick
+///					  is incremented.  Only the tasks in the slot of the timer wheel for the
+///					  current clock tick are visited, a task with a delay longer than 
+///					  __OS_WHEEL_SLOTS clock ticks stays in the slot until its gunOSWakeTick[].
+///					  The wait for events of a task ends with timeout, see OSWaitEvent().
 /// Arguments		: None.
 /// Return			: None.
 void OSUpdateTaskTimer(void)
 {
-	int ni = 0;
+	int nTask;
+	int nNext;
 
-	ni = 0; 					// Reset index.
-	while (ni < gnTaskCount)
+	nTask = gnOSWheelHead[gunClockTick & (__OS_WHEEL_SLOTS - 1)];
+	while (nTask >= 0)
 	{	
-		--(gstrcTaskContext[ni].nTimer); 	// Decrement the timer of each task.
-		ni++; 					// Next task.
+		nNext = gnOSWheelNext[nTask];
+		if (gunOSWakeTick[nTask] == gunClockTick)
+		{
+			gstrcTaskContext[nTask].unEventWait = 0;	// Timeout, unEvent = 0.
+			_OS_MAP_CLEAR(gunOSWaitMap, nTask);
+			OSSetTaskTimer(nTask, 0);					// Ready to run.
+		}
+		nTask = nNext; 					// Next task.
+	}
+}
+
+/// Function name	: nOSNextReadyTask()
+/// Author			: Fabian Kung
+/// Last modified	: 16 Oct 2026
+/// Description		: Find the next task which is ready to run, in the order of gstrcTaskContext[].
+///					  The Scheduler calls this with nStart = 0, then with the position of the 
+///					  task just executed + 1, until -1 is returned.
+/// Arguments		: nStart = Position in gstrcTaskContext[] to start the search.
+/// Return			: Position of the task, -1 if there is no more task ready to run.
+int nOSNextReadyTask(int nStart)
+{
+	int nWord = nStart >> 5;
+	unsigned int unMap;
+
+	if (nWord >= __OS_MAP_WORDS)
+	{
+		return -1;
+	}
+	unMap = gunOSReadyMap[nWord] & (0xFFFFFFFF << (nStart & 0x1F));	// Skip the tasks before nStart.
+	while (unMap == 0)
+	{
+		nWord++;
+		if (nWord >= __OS_MAP_WORDS)
+		{
+			return -1;
+		}
+		unMap = gunOSReadyMap[nWord];
 	}
+	return (nWord << 5) + __builtin_ctz(unMap);
 }
 
@@ -0,0 +1,322 @@
+//////////////////////////////////////////////////////////////////////////////////////////////
+//
+// File				: os_Coroutine.c
+// Author(s)		: Fabian Kung
+// Last modified	: 16 Oct 2026
+// Tool-suites		: Atmel Studio 7.0 or later
+//                    GCC C-Compiler
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+// Stackful coroutine tasks, see os_Coroutine.h.
+
+#include <stddef.h>					// For NULL.
+#include "osmain.h"
+#include "os_Coroutine.h"
+
+//
+// --- PRIVATE VARIABLES ---
+//
+COTASK		gstrcCoTask[_OS_MAX_COTASK];
+COTASK		*gptrCoCurrent = NULL;			// Co-task which is running, NULL when the Scheduler is running.
+#ifdef		__OS_COROUTINE_HOST
+ucontext_t	gstrcSchedulerContext;
+#else
+uint32_t	*gptrSchedulerSP;				// Saved stack pointer of the Scheduler when a co-task is running.
+#endif
+
+static void CoTaskStart(void);
+
+#ifdef		__OS_COROUTINE_HOST
+
+static void CoStackInit(COTASK *ptrCo)
+{
+	getcontext(&ptrCo->strcContext);
+	ptrCo->strcContext.uc_stack.ss_sp = ptrCo->ptrStack;
+	ptrCo->strcContext.uc_stack.ss_size = ptrCo->nStackWords*sizeof(uint32_t);
+	ptrCo->strcContext.uc_link = NULL;
+	makecontext(&ptrCo->strcContext, CoTaskStart, 0);
+}
+
+static void CoSwitchToTask(COTASK *ptrCo)
+{
+	swapcontext(&gstrcSchedulerContext, &ptrCo->strcContext);
+}
+
+static void CoSwitchToScheduler(COTASK *ptrCo)
+{
+	swapcontext(&ptrCo->strcContext, &gstrcSchedulerContext);
+}
+
+#else
+
+/// Push r3-r11 and lr (r3 keeps the stack aligned to 8 bytes) and s16-s31 on the current stack,
+/// save the stack pointer in *ptrptrSaveSP, then load the stack pointer ptrNewSP and pop the
+/// registers of the other context.  The return goes to the caller of CoSwitch() in the other
+/// context, or to CoTaskStart() the first time a co-task runs.
+__attribute__((naked, noinline)) static void CoSwitch(uint32_t **ptrptrSaveSP, uint32_t *ptrNewSP)
+{
+	__asm volatile
+	(
+		"push	{r3-r11, lr}	\n"
+		#if (__FPU_USED == 1)
+		"vpush	{s16-s31}		\n"
+		#endif
+		"str	sp, [r0]		\n"
+		"mov	sp, r1			\n"
+		#if (__FPU_USED == 1)
+		"vpop	{s16-s31}		\n"
+		#endif
+		"pop	{r3-r11, pc}	\n"
+	);
+}
+
+/// Build the initial frame of CoSwitch() at the top of the stack, with CoTaskStart() as the
+/// return address.
+static void CoStackInit(COTASK *ptrCo)
+{
+	uint32_t *ptrSP;
+	int ni;
+
+	ptrSP = (uint32_t *) ((uint32_t) (ptrCo->ptrStack + ptrCo->nStackWords) & ~0x07);	// 8 bytes alignment.
+	*(--ptrSP) = (uint32_t) CoTaskStart;	// pc.
+	for (ni = 0; ni < 9; ni++)				// r11 to r3.
+	{
+		*(--ptrSP) = 0;
+	}
+	#if (__FPU_USED == 1)
+	for (ni = 0; ni < 16; ni++)				// s31 to s16.
+	{
+		*(--ptrSP) = 0;
+	}
+	#endif
+	ptrCo->ptrSP = ptrSP;
+}
+
+static void CoSwitchToTask(COTASK *ptrCo)
+{
+	CoSwitch(&gptrSchedulerSP, ptrCo->ptrSP);
+}
+
+static void CoSwitchToScheduler(COTASK *ptrCo)
+{
+	CoSwitch(&ptrCo->ptrSP, gptrSchedulerSP);
+}
+
+#endif
+
+/// First function to run on the stack of a co-task.  A co-task which returns is not dispatched
+/// again.
+static void CoTaskStart(void)
+{
+	gptrCoCurrent->fptrEntry();
+	while (1)
+	{
+		gptrCoCurrent->ptrTask->unEventWait = 0;
+		OSSetTaskContext(gptrCoCurrent->ptrTask, gptrCoCurrent->ptrTask->nState, -1);	// Never ready again.
+		CoSwitchToScheduler(gptrCoCurrent);
+	}
+}
+
+/// Task function of all co-tasks, called by the Scheduler.  Switch to the co-task and return when
+/// the co-task yields.
+static void OSCoTaskDispatch(TASK_ATTRIBUTE *ptrTask)
+{
+	int ni;
+
+	for (ni = 0; ni < _OS_MAX_COTASK; ni++)
+	{
+		if (gstrcCoTask[ni].nID == ptrTask->nID)
+		{
+			gstrcCoTask[ni].ptrTask = ptrTask;
+			gptrCoCurrent = &gstrcCoTask[ni];
+			CoSwitchToTask(gptrCoCurrent);
+			gptrCoCurrent = NULL;
+			return;
+		}
+	}
+}
+
+///
+/// Function name	: OSCreateCoTask
+///
+/// Author			: Fabian Kung
+///
+/// Last modified	: 16 Oct 2026
+///
+/// Code Version	: 1.00
+///
+/// Processor		: ARM Cortex-M7 family
+///
+/// Description		: Add a co-task to the Scheduler.  The co-task starts in the next system tick.
+///
+/// Arguments		: ptrTaskData - Task context, e.g. &gstrcTaskContext[gnTaskCount].
+///                   fptrEntry - Function of the co-task.
+///                   ptrStack - Stack of the co-task.
+///                   nStackWords - Size of the stack in 32-bits words.
+///
+/// Return			: 0 if success, 1 if not successful.
+///
+/// Global variable	: gstrcCoTask[]
+///
+int OSCreateCoTask(TASK_ATTRIBUTE *ptrTaskData, COTASK_ENTRY fptrEntry, uint32_t *ptrStack, int nStackWords)
+{
+	int ni;
+	int nj;
+
+	for (ni = 0; ni < _OS_MAX_COTASK; ni++)
+	{
+		if (gstrcCoTask[ni].nID == 0)
+		{
+			if (OSCreateTask(ptrTaskData, OSCoTaskDispatch) > 0)
+			{
+				return 1;
+			}
+			for (nj = 0; nj < nStackWords; nj++)
+			{
+				ptrStack[nj] = _COTASK_STACK_FILL;
+			}
+			gstrcCoTask[ni].nID = ptrTaskData->nID;
+			gstrcCoTask[ni].ptrTask = ptrTaskData;
+			gstrcCoTask[ni].fptrEntry = fptrEntry;
+			gstrcCoTask[ni].ptrStack = ptrStack;
+			gstrcCoTask[ni].nStackWords = nStackWords;
+			CoStackInit(&gstrcCoTask[ni]);
+			return 0;
+		}
+	}
+	return 1;										// Max. co-tasks exceeded.
+}
+
+///
+/// Function name	: OSYield
+///
+/// Author			: Fabian Kung
+///
+/// Last modified	: 16 Oct 2026
+///
+/// Code Version	: 1.00
+///
+/// Processor		: ARM Cortex-M7 family
+///
+/// Description		: Give the processor back to the Scheduler, the co-task continues in the next
+///                   system tick.  No effect if not called by a co-task.
+///
+/// Arguments		: None.
+///
+/// Return			: None.
+///
+/// Global variable	: gptrCoCurrent
+///
+void OSYield(void)
+{
+	OSSleep(1);
+}
+
+///
+/// Function name	: OSSleep
+///
+/// Author			: Fabian Kung
+///
+/// Last modified	: 16 Oct 2026
+///
+/// Code Version	: 1.00
+///
+/// Processor		: ARM Cortex-M7 family
+///
+/// Description		: Give the processor back to the Scheduler, the co-task continues after nTicks
+///                   system ticks.  No effect if not called by a co-task.
+///
+/// Arguments		: nTicks - No. of system ticks, at least 1.
+///
+/// Return			: None.
+///
+/// Global variable	: gptrCoCurrent
+///
+void OSSleep(int nTicks)
+{
+	COTASK *ptrCo = gptrCoCurrent;
+
+	if (ptrCo != NULL)
+	{
+		if (nTicks < 1)
+		{
+			nTicks = 1;
+		}
+		OSSetTaskContext(ptrCo->ptrTask, ptrCo->ptrTask->nState, nTicks);
+		CoSwitchToScheduler(ptrCo);
+	}
+}
+
+///
+/// Function name	: unOSCoWaitEvent
+///
+/// Author			: Fabian Kung
+///
+/// Last modified	: 16 Oct 2026
+///
+/// Code Version	: 1.00
+///
+/// Processor		: ARM Cortex-M7 family
+///
+/// Description		: Block the co-task until one of the events is signalled with OSSignalEvent(),
+///                   or until timeout, see OSWaitEvent().
+///
+/// Arguments		: unEventMask - Events to wait for, see __EVENT_XXX in osmain.h.
+///                   nTimeout - No. of system ticks, 0 to wait without timeout.
+///
+/// Return			: The events received, 0 if timeout or not called by a co-task.
+///
+/// Global variable	: gptrCoCurrent
+///
+unsigned int unOSCoWaitEvent(unsigned int unEventMask, int nTimeout)
+{
+	COTASK *ptrCo = gptrCoCurrent;
+
+	if (ptrCo == NULL)
+	{
+		return 0;
+	}
+	OSWaitEvent(ptrCo->ptrTask, unEventMask, nTimeout);
+	CoSwitchToScheduler(ptrCo);
+	return ptrCo->ptrTask->unEvent;			// ptrTask is updated by OSCoTaskDispatch().
+}
+
+///
+/// Function name	: nOSCoTaskStackFree
+///
+/// Author			: Fabian Kung
+///
+/// Last modified	: 16 Oct 2026
+///
+/// Code Version	: 1.00
+///
+/// Processor		: ARM Cortex-M7 family
+///
+/// Description		: Count the stack words of a co-task which still hold _COTASK_STACK_FILL,
+///                   e.g. never used since OSCreateCoTask().  Use this to size the stack.
+///
+/// Arguments		: ptrTask - Task context of the co-task.
+///
+/// Return			: No. of unused stack words, -1 if ptrTask is not a co-task.
+///
+/// Global variable	: gstrcCoTask[]
+///
+int nOSCoTaskStackFree(TASK_ATTRIBUTE *ptrTask)
+{
+	int ni;
+	int nFree;
+
+	for (ni = 0; ni < _OS_MAX_COTASK; ni++)
+	{
+		if ((gstrcCoTask[ni].nID != 0) && (gstrcCoTask[ni].nID == ptrTask->nID))
+		{
+			nFree = 0;
+			while ((nFree < gstrcCoTask[ni].nStackWords) && (gstrcCoTask[ni].ptrStack[nFree] == _COTASK_STACK_FILL))
+			{
+				nFree++;
+			}
+			return nFree;
+		}
+	}
+	return -1;
+}
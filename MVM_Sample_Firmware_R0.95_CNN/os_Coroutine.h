@@ -0,0 +1,73 @@
+//////////////////////////////////////////////////////////////////////////////////////////////
+//
+// File				: os_Coroutine.h
+// Author(s)		: Fabian Kung
+// Last modified	: 16 Oct 2026
+// Tool-suites		: Atmel Studio 7.0 or later
+//                    GCC C-Compiler
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _OS_COROUTINE_H
+#define _OS_COROUTINE_H
+
+// Stackful coroutine tasks (co-task).  A co-task is a plain C function with its own stack, it is
+// added to the Scheduler with OSCreateCoTask() and runs like the other tasks in gstrcTaskContext[].
+// Instead of returning at the end of each state, the co-task calls OSYield(), OSSleep() or
+// unOSCoWaitEvent() to give the processor back to the Scheduler, and continues after the call
+// when it is dispatched again.  The local variables stay on the stack of the co-task, so a long
+// computation can be written as nested loops which yield when OSBudgetExhausted() is true.
+// There are two implementations of the context switch:
+// 1. os_Coroutine.c - Cortex-M7, the callee-saved registers (and s16-s31 if the FPU is used) are
+//    pushed on the stack of the co-task.
+// 2. When __OS_COROUTINE_HOST is defined (computer build, see MVM_Miscellaneous/Host) the switch
+//    uses swapcontext() of ucontext.h.
+// The interrupt service routines run on the stack of the co-task if they occur while the co-task
+// is running, so the stack should have room for the exception frame (26 words) and the ISR.
+#include "osmain.h"
+
+//#define	__OS_COROUTINE						// Uncomment to compute the dense layers of the CNN in
+												// CoTask_CNNDense() instead of Proce_Image4() states 4 and 5.
+
+//
+// --- PUBLIC CONSTANTS ---
+//
+#define		_OS_MAX_COTASK			2		// Max. no. of co-tasks.
+#define		_COTASK_STACK_FILL		0xA5A5A5A5	// Initial value of the stack, for nOSCoTaskStackFree().
+
+#ifdef		__OS_COROUTINE_HOST
+#include <ucontext.h>
+#endif
+
+typedef void (*COTASK_ENTRY)(void);
+
+typedef struct StructCOTASK
+{
+	int				nID;				// ID of the task in gstrcTaskContext[], 0 if the slot is free.
+	TASK_ATTRIBUTE	*ptrTask;			// Task context of the current dispatch.
+	COTASK_ENTRY	fptrEntry;			// Function of the co-task.
+	uint32_t		*ptrStack;			// Lowest address of the stack.
+	int				nStackWords;		// Size of the stack in 32-bits words.
+	#ifdef		__OS_COROUTINE_HOST
+	ucontext_t		strcContext;
+	#else
+	uint32_t		*ptrSP;				// Saved stack pointer when the co-task is not running.
+	#endif
+} COTASK;
+
+//
+// --- PUBLIC FUNCTION PROTOTYPE ---
+//
+int OSCreateCoTask(TASK_ATTRIBUTE *, COTASK_ENTRY, uint32_t *, int);	// Task context, function, stack, stack
+																		// size in words.  Return 0 if success.
+void OSYield(void);							// Continue in the next system tick.
+void OSSleep(int);							// Continue after no. of system ticks.
+unsigned int unOSCoWaitEvent(unsigned int, int);	// Same as OSWaitEvent(), return the events received,
+													// 0 if timeout.
+int nOSCoTaskStackFree(TASK_ATTRIBUTE *);	// No. of stack words never used by the co-task.
+
+//
+// --- PUBLIC MACROS ---
+//
+#define		OSYieldIfExhausted()	do { if (OSBudgetExhausted()) { OSYield(); } } while (0)
+
+#endif
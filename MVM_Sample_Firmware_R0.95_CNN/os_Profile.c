@@ -0,0 +1,483 @@
+//////////////////////////////////////////////////////////////////////////////////////////////
+//
+// File				: os_Profile.c
+// Author(s)		: Fabian Kung
+// Last modified	: 16 Oct 2026
+// Tool-suites		: Atmel Studio 7.0 or later
+//                    GCC C-Compiler
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+// Cycle count profiling with the DWT cycle counter, see os_Profile.h.
+
+#include "osmain.h"
+#include "os_Profile.h"
+
+//
+// --- PUBLIC VARIABLES ---
+//
+unsigned int	gunProfileStart[_PROFILE_MARKERS];
+PROFILE_STAT	gstrcProfileStat[_PROFILE_MARKERS];
+PROFILE_TRACE	gstrcProfileTrace[_PROFILE_TRACE_SIZE];
+unsigned int	gunProfileTraceCount = 0;
+TASK_STAT		gstrcTaskStat[__MAXTASK];
+unsigned int	gunTickOverrun = 0;
+int				gnOverrunTask = 0;
+unsigned int	gunOverrunCycles = 0;
+
+//
+// --- PRIVATE VARIABLES ---
+//
+unsigned int	gunProfileResetTick = 0;	// Value of gunClockTick when the statistics are cleared.
+unsigned int	gunTaskStatResetTick = 0;	// Value of gunClockTick when the task statistics are cleared.
+unsigned int	gunTickStartCycle;			// Cycle counter at the start of the current system tick.
+unsigned int	gunTickMaxCycles;			// Longest task dispatch in the current system tick.
+int				gnTickMaxTask;				// Position of the longest task in the current system tick, -1 if none.
+
+///
+/// Function name	: ProfileInit
+///
+/// Author			: Fabian Kung
+///
+/// Last modified	: 16 Oct 2026
+///
+/// Code Version	: 1.00
+///
+/// Processor		: ARM Cortex-M7 family
+///
+/// Description		: Enable the DWT cycle counter and clear the statistics, trace ring and 
+///                   task statistics.
+///
+/// Arguments		: None.
+///
+/// Return			: None.
+///
+/// Global variable	: gstrcProfileStat[], gunProfileTraceCount, gstrcTaskStat[]
+///
+void ProfileInit(void)
+{
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;		// Enable the DWT cycle counter.
+	DWT->LAR = 0xC5ACCE55;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	gunProfileTraceCount = 0;
+	ProfileReset();
+	TaskStatReset();
+}
+
+///
+/// Function name	: ProfileReset
+///
+/// Author			: Fabian Kung
+///
+/// Last modified	: 16 Oct 2026
+///
+/// Code Version	: 1.00
+///
+/// Processor		: ARM Cortex-M7 family
+///
+/// Description		: Clear the min/average/max statistics of all markers.  The trace ring
+///                   is kept.
+///
+/// Arguments		: None.
+///
+/// Return			: None.
+///
+/// Global variable	: gstrcProfileStat[], gunClockTick
+///
+void ProfileReset(void)
+{
+	int nIndex;
+	
+	for (nIndex = 0; nIndex < _PROFILE_MARKERS; nIndex++)
+	{
+		gstrcProfileStat[nIndex].unCount = 0;
+		gstrcProfileStat[nIndex].unMin = 0xFFFFFFFF;
+		gstrcProfileStat[nIndex].unMax = 0;
+		gstrcProfileStat[nIndex].ulnSum = 0;
+	}
+	gunProfileResetTick = gunClockTick;
+}
+
+///
+/// Function name	: ProfileEnd
+///
+/// Author			: Fabian Kung
+///
+/// Last modified	: 16 Oct 2026
+///
+/// Code Version	: 1.00
+///
+/// Processor		: ARM Cortex-M7 family
+///
+/// Description		: Record the processor cycles since PROFILE_BEGIN() of a marker into the
+///                   trace ring and update the statistics of the marker.  Called by 
+///                   PROFILE_END().
+///
+/// Arguments		: nID - Marker ID, 0 to _PROFILE_MARKERS-1.
+///                   unCycleEnd - DWT cycle counter at the end of the section.
+///
+/// Return			: None.
+///
+/// Global variable	: gunProfileStart[], gstrcProfileStat[], gstrcProfileTrace[]
+///
+void ProfileEnd(int nID, unsigned int unCycleEnd)
+{
+	unsigned int unCycles = unCycleEnd - gunProfileStart[nID];	// Unsigned arithmetic handles counter wrap around.
+	PROFILE_STAT *ptrStat = &gstrcProfileStat[nID];
+	PROFILE_TRACE *ptrTrace = &gstrcProfileTrace[gunProfileTraceCount & (_PROFILE_TRACE_SIZE - 1)];
+	
+	ptrTrace->unID = nID;
+	ptrTrace->unCycles = unCycles;
+	gunProfileTraceCount++;
+	ptrStat->unCount++;
+	ptrStat->ulnSum = ptrStat->ulnSum + unCycles;
+	if (unCycles < ptrStat->unMin)
+	{
+		ptrStat->unMin = unCycles;
+	}
+	if (unCycles > ptrStat->unMax)
+	{
+		ptrStat->unMax = unCycles;
+	}
+}
+
+/// Store a 32-bits value as 5 bytes of 7-bits, lowest bits first.
+static int nProfilePut32(uint8_t *ptrBuffer, unsigned int unValue)
+{
+	int nIndex;
+	
+	for (nIndex = 0; nIndex < 5; nIndex++)
+	{
+		ptrBuffer[nIndex] = unValue & 0x7F;
+		unValue = unValue >> 7;
+	}
+	return 5;
+}
+
+///
+/// Function name	: nProfilePacket
+///
+/// Author			: Fabian Kung
+///
+/// Last modified	: 16 Oct 2026
+///
+/// Code Version	: 1.00
+///
+/// Processor		: ARM Cortex-M7 family
+///
+/// Description		: Build one packet of the profile dump, using the same framing as the 
+///                   image lines of Proce_MessageLoop_StreamImage():
+///                   Byte0: 0xFF (start-of-line).
+///                   Byte1: 252, profile data.
+///                   Byte2: Payload length, excluding Byte0-2.
+///                   Byte3-ByteN: Payload, 7-bits values.  32-bits values are sent as 5 bytes,
+///                   7 bits each, lowest bits first.
+///                   Packet 0 is the header: [0][No. of markers][Trace size][Core MHz, 5 bytes]
+///                   [System ticks since ProfileReset(), 5 bytes][Trace entries written, 5 bytes]
+///                   Packet 1 to _PROFILE_MARKERS: [1][Marker ID][Count][Min][Average][Max]
+///                   Followed by the trace ring, oldest first, 16 entries per packet: 
+///                   [2][No. of entries][Marker ID][Cycles]...
+///
+/// Arguments		: ptrBuffer - Transmit buffer, at least 101 bytes.
+///                   nPacket - Packet no., starting from 0.
+///
+/// Return			: No. of bytes in the packet, 0 if nPacket is beyond the last packet.
+///
+/// Global variable	: gstrcProfileStat[], gstrcProfileTrace[], gunProfileTraceCount
+///
+int nProfilePacket(uint8_t *ptrBuffer, int nPacket)
+{
+	int nLength = 3;
+	int nIndex;
+	int nEntries;
+	unsigned int unFirst;
+	unsigned int unAverage;
+	PROFILE_STAT *ptrStat;
+	PROFILE_TRACE *ptrTrace;
+	
+	ptrBuffer[0] = 0xFF;					// Start of line code.
+	ptrBuffer[1] = 252;						// Line number of 252 indicate profile data.
+	nEntries = gunProfileTraceCount;		// No. of valid entries in the trace ring.
+	if (gunProfileTraceCount > _PROFILE_TRACE_SIZE)
+	{
+		nEntries = _PROFILE_TRACE_SIZE;
+	}
+	if (nPacket == 0)
+	{
+		ptrBuffer[nLength++] = 0;
+		ptrBuffer[nLength++] = _PROFILE_MARKERS;
+		ptrBuffer[nLength++] = _PROFILE_TRACE_SIZE;
+		nLength = nLength + nProfilePut32(&ptrBuffer[nLength], __FOSC_MHz);
+		nLength = nLength + nProfilePut32(&ptrBuffer[nLength], gunClockTick - gunProfileResetTick);
+		nLength = nLength + nProfilePut32(&ptrBuffer[nLength], gunProfileTraceCount);
+	}
+	else if (nPacket <= _PROFILE_MARKERS)
+	{
+		ptrStat = &gstrcProfileStat[nPacket - 1];
+		unAverage = 0;
+		if (ptrStat->unCount > 0)
+		{
+			unAverage = ptrStat->ulnSum / ptrStat->unCount;
+		}
+		ptrBuffer[nLength++] = 1;
+		ptrBuffer[nLength++] = nPacket - 1;
+		nLength = nLength + nProfilePut32(&ptrBuffer[nLength], ptrStat->unCount);
+		nLength = nLength + nProfilePut32(&ptrBuffer[nLength], (ptrStat->unCount > 0) ? ptrStat->unMin : 0);
+		nLength = nLength + nProfilePut32(&ptrBuffer[nLength], unAverage);
+		nLength = nLength + nProfilePut32(&ptrBuffer[nLength], ptrStat->unMax);
+	}
+	else
+	{
+		nIndex = (nPacket - _PROFILE_MARKERS - 1) * 16;		// First trace entry of this packet, 0 = oldest.
+		if (nIndex >= nEntries)
+		{
+			return 0;
+		}
+		unFirst = gunProfileTraceCount - nEntries + nIndex;
+		nEntries = nEntries - nIndex;
+		if (nEntries > 16)
+		{
+			nEntries = 16;
+		}
+		ptrBuffer[nLength++] = 2;
+		ptrBuffer[nLength++] = nEntries;
+		for (nIndex = 0; nIndex < nEntries; nIndex++)
+		{
+			ptrTrace = &gstrcProfileTrace[(unFirst + nIndex) & (_PROFILE_TRACE_SIZE - 1)];
+			ptrBuffer[nLength++] = ptrTrace->unID;
+			nLength = nLength + nProfilePut32(&ptrBuffer[nLength], ptrTrace->unCycles);
+		}
+	}
+	ptrBuffer[2] = nLength - 3;				// Payload length.
+	return nLength;
+}
+
+///
+/// Function name	: TaskStatReset
+///
+/// Author			: Fabian Kung
+///
+/// Last modified	: 16 Oct 2026
+///
+/// Code Version	: 1.00
+///
+/// Processor		: ARM Cortex-M7 family
+///
+/// Description		: Clear the cycle count statistics of all tasks and the tick overrun record.
+///
+/// Arguments		: None.
+///
+/// Return			: None.
+///
+/// Global variable	: gstrcTaskStat[], gunTickOverrun, gnOverrunTask, gunOverrunCycles
+///
+void TaskStatReset(void)
+{
+	int nTask;
+	int nBin;
+	
+	for (nTask = 0; nTask < __MAXTASK; nTask++)
+	{
+		gstrcTaskStat[nTask].unDispatch = 0;
+		gstrcTaskStat[nTask].unMin = 0xFFFFFFFF;
+		gstrcTaskStat[nTask].unMax = 0;
+		gstrcTaskStat[nTask].ulnSum = 0;
+		gstrcTaskStat[nTask].unOverrun = 0;
+		for (nBin = 0; nBin < _TASK_HISTO_BINS; nBin++)
+		{
+			gstrcTaskStat[nTask].unHisto[nBin] = 0;
+		}
+	}
+	gunTickOverrun = 0;
+	gnOverrunTask = 0;
+	gunOverrunCycles = 0;
+	gunTaskStatResetTick = gunClockTick;
+}
+
+///
+/// Function name	: TaskStatTick
+///
+/// Author			: Fabian Kung
+///
+/// Last modified	: 16 Oct 2026
+///
+/// Code Version	: 1.00
+///
+/// Processor		: ARM Cortex-M7 family
+///
+/// Description		: Mark the start of a system tick, called by the scheduler loop when the 
+///                   SysTick expires.
+///
+/// Arguments		: None.
+///
+/// Return			: None.
+///
+/// Global variable	: gunTickStartCycle, gunTickMaxCycles, gnTickMaxTask
+///
+void TaskStatTick(void)
+{
+	gunTickStartCycle = DWT->CYCCNT;
+	gunTickMaxCycles = 0;
+	gnTickMaxTask = -1;
+}
+
+///
+/// Function name	: TaskStatRecord
+///
+/// Author			: Fabian Kung
+///
+/// Last modified	: 16 Oct 2026
+///
+/// Code Version	: 1.00
+///
+/// Processor		: ARM Cortex-M7 family
+///
+/// Description		: Update the statistics and duration histogram of a task after it is 
+///                   dispatched by the scheduler loop.
+///
+/// Arguments		: nTask - Position of the task in gstrcTaskContext[].
+///                   unCycles - Processor cycles of the dispatch.
+///
+/// Return			: None.
+///
+/// Global variable	: gstrcTaskStat[], gunTickMaxCycles, gnTickMaxTask
+///
+void TaskStatRecord(int nTask, unsigned int unCycles)
+{
+	TASK_STAT *ptrStat = &gstrcTaskStat[nTask];
+	unsigned int unLimit = _TICK_CYCLES >> 5;
+	int nBin = 0;
+	
+	ptrStat->unDispatch++;
+	ptrStat->ulnSum = ptrStat->ulnSum + unCycles;
+	if (unCycles < ptrStat->unMin)
+	{
+		ptrStat->unMin = unCycles;
+	}
+	if (unCycles > ptrStat->unMax)
+	{
+		ptrStat->unMax = unCycles;
+	}
+	while ((nBin < _TASK_HISTO_BINS - 1) && (unCycles >= unLimit))	// Bin 0 is 1/32 of a system tick, each
+	{																// bin doubles the limit.
+		nBin++;
+		unLimit = unLimit << 1;
+	}
+	ptrStat->unHisto[nBin]++;
+	if (unCycles > gunTickMaxCycles)
+	{
+		gunTickMaxCycles = unCycles;
+		gnTickMaxTask = nTask;
+	}
+}
+
+///
+/// Function name	: TaskStatTickEnd
+///
+/// Author			: Fabian Kung
+///
+/// Last modified	: 16 Oct 2026
+///
+/// Code Version	: 1.00
+///
+/// Processor		: ARM Cortex-M7 family
+///
+/// Description		: Check for overrun after all tasks are dispatched in a system tick.  The 
+///                   tick overran if the tasks took longer than 1 system tick, the longest 
+///                   task of the tick is recorded as the offending task.
+///
+/// Arguments		: None.
+///
+/// Return			: None.
+///
+/// Global variable	: gunTickOverrun, gnOverrunTask, gunOverrunCycles, gstrcTaskStat[]
+///
+void TaskStatTickEnd(void)
+{
+	unsigned int unCycles = DWT->CYCCNT - gunTickStartCycle;
+	
+	if (unCycles > _TICK_CYCLES)
+	{
+		gunTickOverrun++;
+		gunOverrunCycles = unCycles;
+		if (gnTickMaxTask >= 0)
+		{
+			gstrcTaskStat[gnTickMaxTask].unOverrun++;
+			gnOverrunTask = gstrcTaskContext[gnTickMaxTask].nID;
+		}
+	}
+}
+
+///
+/// Function name	: nTaskStatPacket
+///
+/// Author			: Fabian Kung
+///
+/// Last modified	: 16 Oct 2026
+///
+/// Code Version	: 1.00
+///
+/// Processor		: ARM Cortex-M7 family
+///
+/// Description		: Build one packet of the task statistics dump, same framing as 
+///                   nProfilePacket() with Byte1 = 251.
+///                   Packet 0 is the header: [0][No. of tasks][ID of the last offending task]
+///                   [Core MHz][System ticks since TaskStatReset()][No. of overran ticks]
+///                   [Processor cycles of the last overran tick]
+///                   Packet 1 to gnTaskCount: [1][Task position][Task ID][Dispatches][Min]
+///                   [Average][Max][Overran ticks][Histogram bin 0 to _TASK_HISTO_BINS-1]
+///                   All values after the task ID are 32-bits, sent as 5 bytes.
+///
+/// Arguments		: ptrBuffer - Transmit buffer, at least 71 bytes.
+///                   nPacket - Packet no., starting from 0.
+///
+/// Return			: No. of bytes in the packet, 0 if nPacket is beyond the last packet.
+///
+/// Global variable	: gstrcTaskStat[], gstrcTaskContext[], gnTaskCount
+///
+int nTaskStatPacket(uint8_t *ptrBuffer, int nPacket)
+{
+	int nLength = 3;
+	int nBin;
+	unsigned int unAverage;
+	TASK_STAT *ptrStat;
+	
+	ptrBuffer[0] = 0xFF;					// Start of line code.
+	ptrBuffer[1] = 251;						// Line number of 251 indicate task statistics.
+	if (nPacket == 0)
+	{
+		ptrBuffer[nLength++] = 0;
+		ptrBuffer[nLength++] = gnTaskCount;
+		ptrBuffer[nLength++] = gnOverrunTask;
+		nLength = nLength + nProfilePut32(&ptrBuffer[nLength], __FOSC_MHz);
+		nLength = nLength + nProfilePut32(&ptrBuffer[nLength], gunClockTick - gunTaskStatResetTick);
+		nLength = nLength + nProfilePut32(&ptrBuffer[nLength], gunTickOverrun);
+		nLength = nLength + nProfilePut32(&ptrBuffer[nLength], gunOverrunCycles);
+	}
+	else if (nPacket <= gnTaskCount)
+	{
+		ptrStat = &gstrcTaskStat[nPacket - 1];
+		unAverage = 0;
+		if (ptrStat->unDispatch > 0)
+		{
+			unAverage = ptrStat->ulnSum / ptrStat->unDispatch;
+		}
+		ptrBuffer[nLength++] = 1;
+		ptrBuffer[nLength++] = nPacket - 1;
+		ptrBuffer[nLength++] = gstrcTaskContext[nPacket - 1].nID;
+		nLength = nLength + nProfilePut32(&ptrBuffer[nLength], ptrStat->unDispatch);
+		nLength = nLength + nProfilePut32(&ptrBuffer[nLength], (ptrStat->unDispatch > 0) ? ptrStat->unMin : 0);
+		nLength = nLength + nProfilePut32(&ptrBuffer[nLength], unAverage);
+		nLength = nLength + nProfilePut32(&ptrBuffer[nLength], ptrStat->unMax);
+		nLength = nLength + nProfilePut32(&ptrBuffer[nLength], ptrStat->unOverrun);
+		for (nBin = 0; nBin < _TASK_HISTO_BINS; nBin++)
+		{
+			nLength = nLength + nProfilePut32(&ptrBuffer[nLength], ptrStat->unHisto[nBin]);
+		}
+	}
+	else
+	{
+		return 0;
+	}
+	ptrBuffer[2] = nLength - 3;				// Payload length.
+	return nLength;
+}
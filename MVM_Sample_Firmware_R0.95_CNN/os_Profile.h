@@ -0,0 +1,105 @@
+//////////////////////////////////////////////////////////////////////////////////////////////
+//
+// File				: os_Profile.h
+// Author(s)		: Fabian Kung
+// Last modified	: 16 Oct 2026
+// Tool-suites		: Atmel Studio 7.0 or later
+//                    GCC C-Compiler
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _OS_PROFILE_H
+#define _OS_PROFILE_H
+
+// Cycle count profiling with the DWT cycle counter.  A section of codes is enclosed with 
+// PROFILE_BEGIN(ID) and PROFILE_END(ID), the no. of processor cycles between the two is 
+// recorded in a trace ring, and the min/average/max of each marker ID is kept.  The statistics
+// and trace ring are sent to the remote host with the 'T' command of Proce_MessageLoop_StreamImage(),
+// see MVM_Miscellaneous/Python/MVM_Profile_Decode.py to print the profile report.
+// When __OS_PROFILE is not defined the markers are removed by the preprocessor.
+// The scheduler loop in main.c also keeps the processor cycles of each task dispatch when 
+// __OS_TASK_STAT is defined, together with the system ticks which overran, e.g. all tasks took 
+// longer than 1 system tick.  These are sent with the 'U' command.
+#include "osmain.h"
+
+//#define	__OS_PROFILE						// Uncomment to enable the profiling markers.
+#define		__OS_TASK_STAT						// Per-task cycle count and tick overrun, about 30 processor cycles 
+												// per task dispatch.
+
+//
+// --- PUBLIC CONSTANTS ---
+//
+// Marker IDs, update the names in MVM_Profile_Decode.py if these are changed.
+#define		_PROF_CAM_LINE			0		// Camera driver, pre-processing of one line.
+#define		_PROF_RLE_LINE			1		// Stream image, RLE encoding of one line.
+#define		_PROF_CNN_CONV			2		// CNN Layer 0, Conv2D and max pooling of two rows.
+#define		_PROF_CNN_DENSE1		3		// CNN Layer DNN1, MAC operations in one system tick.
+#define		_PROF_CNN_DENSE2		4		// CNN Layer DNN2.
+#define		_PROF_IPA4_STATE		5		// Proce_Image4() state 0 to 6, e.g. ID 5 to 11.
+#define		_PROF_IPA4_STATES		7
+#define		_PROFILE_MARKERS		12		// No. of marker IDs.
+#define		_PROFILE_TRACE_SIZE		64		// No. of entries in the trace ring, power of 2.
+#define		_TICK_CYCLES			__SYSTEMTICK_CYCLES		// Processor cycles in 1 system tick.
+#define		_TASK_HISTO_BINS		8		// Task duration histogram, bin 0 to 6 count the dispatches shorter than 
+											// _TICK_CYCLES x 2^(n-5), e.g. 1/32 to 2 system ticks, bin 7 counts the rest.
+
+typedef struct StructPROFILE_STAT
+{
+	unsigned int	unCount;				// No. of times the section is executed.
+	unsigned int	unMin;					// Min. processor cycles.
+	unsigned int	unMax;					// Max. processor cycles.
+	uint64_t		ulnSum;					// Total processor cycles, for the average.
+} PROFILE_STAT;
+
+typedef struct StructPROFILE_TRACE
+{
+	unsigned int	unID;					// Marker ID.
+	unsigned int	unCycles;				// Processor cycles between PROFILE_BEGIN() and PROFILE_END().
+} PROFILE_TRACE;
+
+typedef struct StructTASK_STAT
+{
+	unsigned int	unDispatch;				// No. of times the task is executed.
+	unsigned int	unMin;					// Min. processor cycles of one dispatch.
+	unsigned int	unMax;					// Max. processor cycles of one dispatch.
+	uint64_t		ulnSum;					// Total processor cycles, for the average.
+	unsigned int	unOverrun;				// No. of overran system ticks in which this task is the longest.
+	unsigned int	unHisto[_TASK_HISTO_BINS];	// Histogram of the dispatch duration.
+} TASK_STAT;
+
+//
+// --- PUBLIC VARIABLES ---
+//
+extern	unsigned int	gunProfileStart[_PROFILE_MARKERS];	// Cycle counter at PROFILE_BEGIN().
+extern	PROFILE_STAT	gstrcProfileStat[_PROFILE_MARKERS];
+extern	PROFILE_TRACE	gstrcProfileTrace[_PROFILE_TRACE_SIZE];
+extern	unsigned int	gunProfileTraceCount;		// No. of entries written to the trace ring.
+extern	TASK_STAT		gstrcTaskStat[__MAXTASK];	// Indexed by the position of the task in gstrcTaskContext[].
+extern	unsigned int	gunTickOverrun;				// No. of system ticks which overran.
+extern	int				gnOverrunTask;				// ID of the longest task in the last overran tick, 0 if none.
+extern	unsigned int	gunOverrunCycles;			// Processor cycles of the last overran tick.
+
+//
+// --- PUBLIC MACROS ---
+//
+#ifdef		__OS_PROFILE
+#define		PROFILE_BEGIN(ID)		gunProfileStart[(ID)] = DWT->CYCCNT
+#define		PROFILE_END(ID)			ProfileEnd((ID), DWT->CYCCNT)
+#else
+#define		PROFILE_BEGIN(ID)
+#define		PROFILE_END(ID)
+#endif
+
+//
+// --- PUBLIC FUNCTION PROTOTYPE ---
+//
+void ProfileInit(void);
+void ProfileReset(void);
+void ProfileEnd(int, unsigned int);
+int nProfilePacket(uint8_t *, int);
+void TaskStatReset(void);
+void TaskStatTick(void);
+void TaskStatRecord(int, unsigned int);
+void TaskStatTickEnd(void);
+int nTaskStatPacket(uint8_t *, int);
+
+#endif
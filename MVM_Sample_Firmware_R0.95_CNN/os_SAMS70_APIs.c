@@ -214,6 +214,12 @@ void SAMS70_Init()
 	// Enable the Cortex-M7 Cache Controller for instruction and data caches.
 	SCB_EnableICache();		// Invalidate then re-enable the instruction cache.
 	SCB_EnableDCache();		// Invalidate then re-enable the data cache.
+	
+	// Enable the DWT cycle counter, used by the Scheduler for the processor cycle budget of the tasks,
+	// see OSBudgetExhausted() in "osmain.h".
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->LAR = 0xC5ACCE55;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 }
 
 // Function name	: OSEnterCritical
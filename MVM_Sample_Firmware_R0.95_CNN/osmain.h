@@ -51,6 +51,7 @@
 												// instruction cycles executed by the ARM core.
 												
 #define	__SYSTEMTICK_US         166.67          // System_Tick = _SYSTICKCOUNT x Tclk_US x 8
+#define __SYSTEMTICK_CYCLES     ((unsigned int)(__SYSTEMTICK_US*__FCORE_MHz))	// Processor cycles in 1 system tick.
 									
 #define __NUM_SYSTEMTICK_MSEC         6         // Requires 6 system ticks to hit 1 msec period.
 
@@ -63,7 +64,12 @@
 #define	__OS_VER				2           // RTOS/Scheduler version, need to be integer (ANSI C preprocessor
 											// expression requires integer). 
 
-#define	__MAXTASK				12			// Maximum no. of concurrent tasks supported.
+#define	__MAXTASK				32			// Maximum no. of concurrent tasks supported.  A task which is not
+											// ready to run costs nothing in each clock tick, see OSUpdateTaskTimer().
+#define __OS_WHEEL_SLOTS		64			// No. of slots in the timer wheel, power of 2.
+#define __OS_MAP_WORDS			((__MAXTASK+31)/32)	// 32-bits words in the ready and wait bit maps.
+#define __OS_TICK_RESERVE_CYCLES	5000	// Processor cycles at the end of each system tick which are not given
+											// to the tasks by OSBudgetExhausted(), for the Scheduler and jitter.
 
 #define __SCI_TXBUF_LENGTH      170  		// SCI transmit  buffer length in bytes.
 #define __SCI_RXBUF_LENGTH      8			// SCI receive  buffer length in bytes.
@@ -71,6 +77,17 @@
 #define __SCI_TXBUF2_LENGTH      8			// SCI transmit  buffer2 length in bytes.
 #define __SCI_RXBUF2_LENGTH      8			// SCI receive  buffer2 length in bytes.
 
+// --- RTOS EVENTS ---
+// Event flags for OSWaitEvent() and OSSignalEvent(), 1 bit per event.
+#define __EVENT_CAMERA_READY	0x0001		// Camera module is initialized, see gnCameraReady.
+#define __EVENT_FRAME_COMPLETE	0x0002		// A new frame is published to the frame pool.
+#define __EVENT_UART_TXDONE		0x0004		// UART2 transmission ends, gSCIstatus.bTXRDY is cleared.
+#define __EVENT_UART_RXRDY		0x0008		// UART2 receives data, gSCIstatus.bRXRDY is set.
+#define __EVENT_USART0_TXDONE	0x0010		// USART0 transmission ends, gSCIstatus2.bTXRDY is cleared.
+#define __EVENT_USART0_RXRDY	0x0020		// USART0 receives data, gSCIstatus2.bRXRDY is set.
+#define __EVENT_CNN_START		0x0040		// Input of the dense layers is ready, see CoTask_CNNDense().
+#define __EVENT_CNN_DONE		0x0080		// Output of the dense layers is ready, see CoTask_CNNDense().
+
 // --- RTOS DATATYPES DECLARATIONS ---
 // Type cast for a structure defining the attributes of a task,
 // e.g. the task's ID, current state, counter, variables etc.
@@ -82,11 +99,21 @@ typedef struct StructTASK
                     // ID = 0 is used to indicate empty task.  
 	int nState;	// The current state of the task.  Useful for implementing 
                     // an algorithmic state machine.
-	int nTimer;	// This variable will be decremented on every clock tick. 
-                    // The Scheduler uses this variable to determine whether to execute a 
-                    // task or not.  If nTimer = 0, the corresponding task will be
+	int nTimer;	// No. of clock ticks before the task is executed again, set with 
+                    // OSSetTaskContext().  If nTimer = 0, the corresponding task will be
                     // executed, else the task will be skipped.
                     // Useful for implementing a non-critical delay within a task.
+                    // nTimer = -1 when the task waits for an event without timeout.
+                    // 16 Oct 2026: The Scheduler no longer decrements nTimer on every clock
+                    // tick, the task is put in the timer wheel instead and nTimer keeps the
+                    // delay until it expires, see OSUpdateTaskTimer().  Always use the
+                    // OSxxx() routines to change nTimer.
+	unsigned int unEventWait;	// Events the task is waiting for, see OSWaitEvent().  0 if 
+                    // the task is not waiting.
+	unsigned int unEvent;		// Events received since OSWaitEvent() is called, 0 if the
+                    // wait ends with timeout.
+	int nBudget;		// Max. processor cycles per dispatch, see OSBudgetExhausted().  0 to 
+                    // use the cycles left until the end of the clock tick.
 } TASK_ATTRIBUTE;
 
 // Type cast for a pointer to a task, TASK_POINTER with argument of TASK_ATTRIBUTE
@@ -126,7 +153,11 @@ void OSInit(void);
 int OSCreateTask(TASK_ATTRIBUTE *, TASK_POINTER );
 void OSSetTaskContext(TASK_ATTRIBUTE *, int, int);
 int OSTaskDelete(int);
+void OSWaitEvent(TASK_ATTRIBUTE *, unsigned int, int);
+void OSSignalEvent(unsigned int);
+void OSSetTaskBudget(TASK_ATTRIBUTE *, int);
 void OSUpdateTaskTimer(void);
+int nOSNextReadyTask(int);
 void OSEnterCritical(void);
 void OSExitCritical(void);
 void OSProce1(TASK_ATTRIBUTE *ptrTask); 	// Blink indicator LED1 process.
@@ -140,9 +171,15 @@ void SAMS70_Init(void);
 extern int gnRunTask;
 extern int gnTaskCount;
 extern unsigned int gunClockTick;
-extern TASK_ATTRIBUTE gstrcTaskContext[__MAXTASK-1];
-extern TASK_POINTER gfptrTask[__MAXTASK-1];
+extern TASK_ATTRIBUTE gstrcTaskContext[__MAXTASK];
+extern TASK_POINTER gfptrTask[__MAXTASK];
 extern SCI_STATUS gSCIstatus;
+extern unsigned int gunOSBudgetEnd;
+
+// Return non-zero when the running task has used up its processor cycles for the current clock
+// tick, see OSSetTaskBudget().  This is cheap enough to be called in the inner loop of a long 
+// computation (e.g. once every 16 iterations), which then continues in the next clock tick.
+#define OSBudgetExhausted()		(((int)(DWT->CYCCNT - gunOSBudgetEnd)) >= 0)
 
 // Note: The followings is defined in file "main.c"
 extern int gnRunImage;
@@ -40,7 +40,7 @@ MARKER_RECTANGLE	gobjRec1;			// Marker objects.
 MARKER_RECTANGLE	gobjRec2;
 MARKER_RECTANGLE	gobjRec3;
 
-unsigned int	gunIPResult[_IMAGE_HRESOLUTION/4][_IMAGE_VRESOLUTION];  // 2D integer array to store image processing algorithm result,
+unsigned int	gunIPResult[_ANALYSIS_HRESOLUTION/4][_ANALYSIS_VRESOLUTION];  // 2D integer array to store image processing algorithm result,
 																		// limited to unsigned integer 8 bits for each pixel.
 
 
@@ -84,6 +84,15 @@ void	SetIPResultBuffer(int nx, int ny, unsigned int unResult)
 	}
 }
 
+/// This function returns the byte at (nx, ny) in gunIPResult[][] array, see SetIPResultBuffer().
+
+unsigned int unGetIPResultBuffer(int nx, int ny)
+{
+	unsigned int unWord = gunIPResult[nx / 4][ny];		// Each unsigned integer word contains results for 4 pixels.
+	
+	return (unWord >> ((nx % 4) << 3)) & 0x000000FF;	// Bit 0-7 for pixel 1, bit 8-15 for pixel 2 etc.
+}
+
 //
 // --- PRIVATE VARIABLES ---
 //
@@ -243,7 +252,7 @@ int	nSPI0WriteData16(unsigned int );
 ///
 /// RTOS		: Ver 1 or above, round-robin scheduling.
 ///
-/// Global variable	: gunImgAtt[_IMAGE_HRESOLUTION][_IMAGE_VRESOLUTION]
+/// Global variable	: gunImgAtt[_ANALYSIS_HRESOLUTION][_ANALYSIS_VRESOLUTION], gun16ImgRGB[_IMAGE_HRESOLUTION][_IMAGE_VRESOLUTION]
 ///
 
 #ifdef 				  __OS_VER		// Check RTOS version compatibility.
@@ -258,7 +267,7 @@ int	nSPI0WriteData16(unsigned int );
 /// Description		: 
 /// This process drives 320x240 color TFT LCD display controlled by ILI9340/ILI9341 LCD controller.
 /// It needs to work in conjunction with a camera driver, and it access the pixel data
-/// contains in the image attribute buffer (IAB) gunImgAtt[_IMAGE_HRESOLUTION][_IMAGE_VRESOLUTION] 
+/// contains in the image attribute buffer (IAB) gunImgAtt[][] or the RGB565 frame buffer gun16ImgRGB[][] 
 /// of the camera driver. The interface mode is assumed to be
 /// 4-wire SPI (CS, SCK, MOSI and Data/Command) Mode 1. In particular this driver is based on 
 /// Limor "ladyada" Fried Arduino C++ library written for Adafruit Industries 2.2", 2.4", 2.8" 
@@ -277,7 +286,6 @@ void Proce_LCD_ILI9341_Driver(TASK_ATTRIBUTE *ptrTask)
 {
 	int				nXTemp;
 	int				nYTemp;
-	int				nTemp;
 	unsigned int	unResult;
 	unsigned int	unTemp;
 	unsigned int	unL5;
@@ -424,66 +432,42 @@ void Proce_LCD_ILI9341_Driver(TASK_ATTRIBUTE *ptrTask)
 				REG_SPI0_CSR0 |= SPI_CSR_BITS(8) ;				// Set data length to 16 bits.
 				for (nIndex = 0; nIndex < 160; nIndex++)		// 160 pixels
 				{	
-					#ifdef		__QQVGA__
-					// Display luminance (grayscale) pixel data on QVGA color TFT LCD 
-																				// Load 16-bits pixel data to SPI Transmit Data Register (TDR).
-																				// For QQVGA resolution the RGB or luminance of one image pixel
-																				// is expanded to 4 pixels, thus the division operation in the
-																				// x and y indices of the gnImgAtt.
+					// The image processing result and the pixel attributes are in QQVGA resolution, thus each of these
+					// is expanded to 4 pixels on the QVGA color TFT LCD, hence the division operation in the x and y indices.
 					nXTemp = (nXindex + nIndex)>>1;
-					nYTemp = nYindex>>1;					
-																																								
-					nTemp = nXTemp / 4;				// Shrink the column index by 4, because each unsigned integer contains 4 bytes.
-					switch (nXTemp % 4)				// The unsigned integer format is 32-bits in ARM Cortex-M.  However each pixel
-					// computation result is 8-bits, thus each unsigned integer word can store results
-					// for 4 pixels.
-					// Bit 0-7:		pixel 1
-					// Bit 8-15:	pixel 2
-					// Bit 16-23:	pixel 3
-					// Bit 24-31:	pixel 4
-					{
-						case 0:	// nIndex % 4 = 0	(nIndex = 0,4,8 etc)
-							unResult = gunIPResult[nTemp][nYTemp] & 0x000000FF;	// Get the lowest 8-bits from 32-bits word.
-						break;
-							
-						case 1: // nIndex % 4 = 1	(nIndex = 1,5,9 etc)
-							unResult = (gunIPResult[nTemp][nYTemp] & 0x0000FF00)>>8;	// Get the 2nd 8-bits from 32-bits word.
-						break;
-							
-						case 2: // nIndex % 4 = 2	(nIndex = 2,6,10 etc)
-							unResult = (gunIPResult[nTemp][nYTemp] & 0x00FF0000)>>16;	// Get the 3rd 8-bits from 32-bits word.
-						break;
-							
-						default: // nIndex % 4 = 3	(nIndex = 3,7,11 etc)
-							unResult = gunIPResult[nTemp][nYTemp]>>24;			// Get the highest 8-bits from 32-bits word.
-						break;
-					}																				
-																				
+					nYTemp = nYindex>>1;
+					unResult = unGetIPResultBuffer(nXTemp, nYTemp);
+
 					if (unResult == 255)											// If the pixel in question fits the IPA criteria of a lump of pixels
 					{																// matching the color selected.
 						REG_SPI0_TDR = 0xFFE0;										// Set pixel to yellow in LCD display.					
 					}	
 					else
 					{
-						unTemp = (gunImgAtt[nXTemp][nYTemp] & _LUMINANCE_MASK);		// Get 7-bits luminance.		
-						unL6 = unTemp>>1;											// Convert the 7-bits luminance value to RGB565 format.
-						unL5 = unL6>>1;												// Let L = 7-bits luminance value.
-						REG_SPI0_TDR = (unL5*2049) + (unL6*32);						// L5 = 5-bits luminance value = L>>2.
-						// L6 = 6-bits luminance value = L>>1.
-						//unL5 = unL6>>2;											// There are two methods to get a greyscale RGB565 pixel value
-						//REG_SPI0_TDR = unL5*2113;									// from the luminance.  The 1st approach is slightly faster but
-																					// less resolution.
-																					// RGB565 = L5 + L5*(2^11) + L5*(2^6)
-																					//        = L5*(1 + 2048 + 64) = L5*2113
-																					// Or
-																					// RGB565 = L5 + L5*(2^11) + L6*(2^5)
-																					//        = L5*(2049) + L6*32						
-					}																							
-					#else	
-					// Display color (RGB565) pixel data on QVGA color TFT LCD 
-					REG_SPI0_TDR = gunImgAtt[nXindex + nIndex][nYindex];			// Load 16-bits pixel data in RGB565 format
-																					// to SPI Transmit Data Register (TDR).
-					#endif
+						if (gnCameraResolution == _CAMERA_RES_QQVGA)
+						{
+							// Display luminance (grayscale) pixel data on QVGA color TFT LCD 
+							unTemp = (gunImgAtt[nXTemp][nYTemp] & _LUMINANCE_MASK);		// Get 7-bits luminance.		
+							unL6 = unTemp>>1;											// Convert the 7-bits luminance value to RGB565 format.
+							unL5 = unL6>>1;												// Let L = 7-bits luminance value.
+							REG_SPI0_TDR = (unL5*2049) + (unL6*32);						// L5 = 5-bits luminance value = L>>2.
+							// L6 = 6-bits luminance value = L>>1.
+							//unL5 = unL6>>2;											// There are two methods to get a greyscale RGB565 pixel value
+							//REG_SPI0_TDR = unL5*2113;									// from the luminance.  The 1st approach is slightly faster but
+																						// less resolution.
+																						// RGB565 = L5 + L5*(2^11) + L5*(2^6)
+																						//        = L5*(1 + 2048 + 64) = L5*2113
+																						// Or
+																						// RGB565 = L5 + L5*(2^11) + L6*(2^5)
+																						//        = L5*(2049) + L6*32						
+						}
+						else
+						{
+							// Display color (RGB565) pixel data on QVGA color TFT LCD 
+							REG_SPI0_TDR = gun16ImgRGB[nXindex + nIndex][nYindex];		// Load 16-bits pixel data in RGB565 format
+																							// to SPI Transmit Data Register (TDR).
+						}
+					}
 					while ((REG_SPI0_SR & SPI_SR_TXEMPTY) == 0)	{} // Wait until TXEMPTY flag is set.
 					
 					// NOTE: 13 Oct 2020, test code.  Somehow this does not work!
@@ -495,7 +479,7 @@ void Proce_LCD_ILI9341_Driver(TASK_ATTRIBUTE *ptrTask)
 				if ((nXindex) == _TFT_LCD_HRESOLUTION)			// Update row and column indices
 				{												// and check for end of row.
 					nXindex = 0;
-					if ((nYindex++) == _TFT_LCD_VRESOLUTION)
+					if ((++nYindex) == _TFT_LCD_VRESOLUTION)
 					{
 						nYindex = 0;
 					}
@@ -13,9 +13,8 @@
 //
 // --- PUBLIC VARIABLES ---
 //
-#define		__QQVGA__				// Comment this out. We want QVGA resolution.
-									// IMPORTANT: To also comment this definition out in the
-									// corresponding C file.
+#define		__QQVGA__				// Start-up resolution.  Comment this out to start in QVGA resolution, color display
+									// with image processing on the 2x2 averaged pixel attributes.
 			
 //
 // --- PUBLIC FUNCTION PROTOTYPE ---
@@ -11,7 +11,7 @@
 
 #include "osmain.h"
 #include "Driver_I2C1_V100.h"
-#include "Driver_LCD_ILI9341_V100.h"
+#include "Driver_TCM8230_LCD.h"
 
 // NOTE: Public function prototypes are declared in the corresponding *.h file.
 
@@ -21,33 +21,18 @@
 // --- PUBLIC VARIABLES ---
 //
 
-// Set image resolution, QQVGA or QVGA.
-//#define		__QQVGA__				// Comment this out if we want QVGA resolution.
-										// IMPORTANT: To also update this definition in the
-										// header (.h) file.
-
-#ifdef		__QQVGA__
-
-#define _IMAGE_HRESOLUTION   160		// For 160x120 pixels QQVGA resolution.
-#define _IMAGE_VRESOLUTION   120
-#define _NOPIXELSINFRAME	 19200
-
-#else
-
-#define _IMAGE_HRESOLUTION   320		// For 320x240 pixels QVGA resolution.
-#define _IMAGE_VRESOLUTION   240
-#define _NOPIXELSINFRAME	 76800
-
-#endif
-
-//#define _IMAGE_HRESOLUTION   128		// For 128x96 pixels subQCIF resolution.
-//#define _IMAGE_VRESOLUTION   96
-//#define _NOPIXELSINFRAME	 12288
+// Image resolution, QQVGA or QVGA, is selected by the definition of __QQVGA__ in the header file
+// "Driver_LCD_ILI9341_V100.h".  The resolution constants and pixel attribute format are declared
+// in "Driver_TCM8230_LCD.h".
 				
 int		gnFrameCounter = 0;
 int		gnImageWidth = _IMAGE_HRESOLUTION;
 int		gnImageHeight = _IMAGE_VRESOLUTION;
-int		gnCameraLED = 0;
+int		gnAnalysisWidth = _ANALYSIS_HRESOLUTION;
+int		gnAnalysisHeight = _ANALYSIS_VRESOLUTION;
+int		gnCameraMode = _CAMERA_MODE_DEFAULT;	// Current camera mode, see _CAMERA_MODE_xxx in the header.
+int		gnCameraResolution = _CAMERA_RES_QVGA;	// Current camera resolution, _CAMERA_RES_QQVGA or _CAMERA_RES_QVGA.
+unsigned int	gnCameraLED = 0;
 int		gnLuminanceMode = 0;		// Option to set how luminance value for each pixel
 									// is computed from the RGB component.
 									// 0 - Luminance (I) is computed from RGB using 
@@ -55,16 +40,11 @@ int		gnLuminanceMode = 0;		// Option to set how luminance value for each pixel
 									// 1 - I = 4R
 									// 2 - I = 2G
 									// Else - I = 4B
-#ifdef		__QQVGA__
-
-unsigned int gunImgAtt[_IMAGE_HRESOLUTION][_IMAGE_VRESOLUTION];   // 1st image frame image attribute buffer.
-unsigned int gunImgAtt2[_IMAGE_HRESOLUTION][_IMAGE_VRESOLUTION];   // 2nd image frame image attribute buffer.
 
-#else
+unsigned int gunImgAtt[_ANALYSIS_HRESOLUTION][_ANALYSIS_VRESOLUTION];   // 1st image frame image attribute buffer.
+unsigned int gunImgAtt2[_ANALYSIS_HRESOLUTION][_ANALYSIS_VRESOLUTION];   // 2nd image frame image attribute buffer.
 
-int16_t gunImgAtt[_IMAGE_HRESOLUTION][_IMAGE_VRESOLUTION];   // Image frame image attribute buffer.
-
-#endif
+uint16_t gun16ImgRGB[_IMAGE_HRESOLUTION][_IMAGE_VRESOLUTION];   // Image frame buffer, RGB565 pixel data at full resolution.
 
 int		gnValidFrameBuffer;			// If equals 1, it means gunImgAtt[] data can be used for image processing.
 									// If equals 2, then gunImgAtt2[] data can be used instead for image processing.
@@ -72,41 +52,37 @@ int		gnValidFrameBuffer;			// If equals 1, it means gunImgAtt[] data can be used
 									// between 1 and 2 as raw pixel data captured from the camera is store in 
 									// gunImgAtt[] and gunImgAtt2[] alternately.
 
-// bit6 - bit0 = Luminance information, 7-bits.
-// bit7 - Marker flag, set to 1 if we wish the external/remote display to highlight
-//        this pixel. (Currently not used).
-// bit16 - bit8 = Hue information, 9-bits, 0 to 360, No hue (gray scale) = 511.
-// bit22 - bit17 = Saturation, 6-bits, 0-63 (63 = pure spectral).
-// bit30 - bit23 = Luminance gradient, 8-bits.
-// bit31 - Special flag. Can be used to store boolean type results of image processing algorithms.
-
-#define     _LUMINANCE_MASK     0x0000007F  // luminance mask, bit6-0.
-#define     _CLUMINANCE_MASK    0xFFFFFF80  // One's complement of luminance mask.
-#define     _LUMINANCE_SHIFT    0
-#define     _HUE_MASK           0x0001FF00  // bit16-8
-#define     _HUE_SHIFT          8
-#define     _SAT_MASK           0x003E0000  // Saturation mask, bit22-17.
-#define     _CSAT_MASK          0xFFC1FFFF  // One's complement of saturation mask.
-#define     _SAT_SHIFT          17
-#define     _NO_HUE_BRIGHT      420         // Value for no hue when object is too bright or near grayscale.
-#define     _NO_HUE_DARK		400         // Value for no hue when object is too dark.
-// Valid hue ranges from 0 to 360.
-#define     _GRAD_MASK          0x7F800000  // bit30-23
-#define     _CGRAD_MASK         0x807FFFFF  // One's complement of gradient mask.
-#define     _GRAD_SHIFT         23
-#define     _MAX_GRADIENT       255
-
 
 int16_t gunIHisto[255];    // Histogram for intensity, 255 levels.
 unsigned int gunAverageLuminance = 0;
 
-#define			_CAMERA_READY			1	// 1 = Camera module ready.
-#define			_CAMERA_NOT_READY		0	// 0 = Camera module not ready.
 int				gnCameraReady = _CAMERA_NOT_READY;		
 
 // --- PRIVATE VARIABLES ---										
 int16_t gun16Pixel[_IMAGE_HRESOLUTION];		// Temporary buffer to store 1 line of pixel data (
 
+unsigned int gunRGBPairSum[_ANALYSIS_HRESOLUTION];	// Sum of the 6-bits R, G and B components of each horizontal pixel pair
+													// in the last even line, bit7-0 = R, bit15-8 = G, bit23-16 = B.
+
+// Camera modes, e.g. resolution and frame rate.  The mode is changed at run-time with CameraSetMode().
+typedef struct StructCAMERA_MODE
+{
+	int			nWidth;			// Frame width and height in pixels.
+	int			nHeight;
+	int			nResolution;	// _CAMERA_RES_QQVGA or _CAMERA_RES_QVGA.
+	uint32_t	unPCK2;			// PMC_PCK[2] setting, e.g. the camera clock.
+	uint8_t		bytReg02;		// Camera register 0x02, maximum frame rate and DCLK polarity.
+	uint8_t		bytReg03;		// Camera register 0x03, output format and frame resolution.
+} CAMERA_MODE;
+
+const CAMERA_MODE gstrcCameraMode[_CAMERA_NO_OF_MODES] = {
+	{160, 120, _CAMERA_RES_QQVGA, PMC_PCK_CSS_MCK | PMC_PCK_PRES(8), 0x00, 0x0E},		// PCK2 = 16.667 MHz, 20.83 fps, QQVGA(f).
+	{320, 240, _CAMERA_RES_QVGA, PMC_PCK_CSS_MCK | PMC_PCK_PRES(15), 0x00, 0x06},		// PCK2 = 9.375 MHz, 11.72 fps, QVGA(f).
+	{320, 240, _CAMERA_RES_QVGA, PMC_PCK_CSS_MAIN_CLK | PMC_PCK_PRES(1), 0x00, 0x06}	// PCK2 = 6 MHz, 7.5 fps, QVGA(f).
+};
+
+int		gnCameraModeRequest = _CAMERA_MODE_DEFAULT;	// Camera mode requested by CameraSetMode().
+
 // --- PRIVATE FUNCTION PROTOTYPES ---
 inline int Min(int a, int b) {return (a < b)? a: b;}
 inline int Max(int a, int b) {return (a > b)? a: b;}
@@ -144,6 +120,148 @@ __STATIC_FORCEINLINE uint32_t __MREV16 (uint32_t op1)
 	return(result);
 }
 
+/// Compute the pixel attributes (luminance, hue and saturation) from the 6-bits R, G and B components
+/// nR6, nG6 and nB6 of a pixel.  The luminance is computed according to gnLuminanceMode.  Returns the
+/// attributes in the format of gunImgAtt[][], with the gradient and bit31 cleared.
+
+unsigned int unPixelAttribute(int nR6, int nG6, int nB6)
+{
+	int nLuminance;
+	int nHue;
+	unsigned int unSat;
+	unsigned int unMaxRGB, unMinRGB;
+	int nDeltaRGB;
+	
+	// --- 6 Jan 2015 ---
+	// Here we approximate the luminance I (or Y) as:
+	// I = 0.250R + 0.625G + 0.125B = (2R + 5G + B)/8
+	// where R, G and B ranges from 0 to 255.
+	// or I = (2*R + 5*G + B)>>3 for integer variables R, G, B.
+	// This avoids multiplication with real number, hence speeding up the
+	// computation, though with the increase in blue and decrease
+	// in green components intensities, we would get a slightly darker
+	// gray scale image.
+	
+	//	nLuminance = (2*(nR5<<3) + 5*(nG6<<2) + (nB5<<3))>>3;
+	
+	// Alternatively since actual values for R, G and B are 5, 6 and 5 bits respectively,
+	// we can normalize R and B to 6 bits by shifting, then convert to gray scale as:
+	//	nLuminance = (2*(nR5<<1) + 5*(nG6) + (nB5<<1))>>2;
+	
+	// Or more efficient alternative, with no multiplication:
+	//	nLuminance = ((nR5<<2) + (nG6<<2) + (nB5<<1) + nG6)>>2;
+	// This will result in gray scale value from 0 to 127, occupying 7 bits.
+	
+	if (gnLuminanceMode == 0)
+	{	
+		//nLuminance = ((nR5<<2) + (nG6<<2) + (nB5<<1) + nG6)>>2; // 7-bits luminance from RGB components.
+		nLuminance = ((nR6<<1) + (nG6<<2) + nB6 + nG6)>>2; // 7-bits luminance from RGB components.
+	}
+	else if (gnLuminanceMode == 1) 
+	{
+		//nLuminance = nR5<<2;	// 7-bits luminance from only 5-bits Red component.
+		nLuminance = nR6<<1;	// 7-bits luminance from only 6-bits Red component.
+	}
+	else if (gnLuminanceMode == 2)
+	{
+		nLuminance = nG6<<1;	// 7-bits luminance from only 6-bits Green component.					
+	}
+	else
+	{
+		//nLuminance = nB5<<2;	// 7-bits luminance from only 5-bits Blue component.
+		nLuminance = nB6<<1;	// 7-bits luminance from only 6-bits Blue component.
+	}				
+
+	// --- Compute the saturation level ---
+	unMaxRGB = Max(nR6, Max(nG6, nB6));     // Find the maximum of R, G or B component
+	unMinRGB = Min(nR6, Min(nG6, nB6));     // Find the minimum of R, G or B components.
+	nDeltaRGB = unMaxRGB - unMinRGB;
+	unSat = nDeltaRGB;                         
+	// Note: Here we define the saturation as the difference between the maximum and minimum RGB values.
+	// A more proper term is called Chroma (as per Wikipedia article).
+	// In normal usage this value needs to be normalized with respect to maximum RGB value so that
+	// saturation is between 0.0 to 1.0.  Here to speed up computation we avoid using floating point
+	// variables. Thus the saturation is 6 bits since the color components are 6 bits, from 0 to 63.
+
+	// --- Compute the hue ---
+	// When saturation is too low, the color is near gray scale, and hue value is not accurate.
+	// Similarly when the light is too bright, the difference between color components may not be large
+	// enough to work out the hue, and hue is also not accurate.  
+	// From color theory (e.g. see Digital Image Processing by Gonzales and Woods, 2018), the minimum 
+	// RGB component intensity corresponds to the white level intensity.  Thus the difference
+	// between maximum RGB component and white level is an indication of the saturation level.
+	// This difference needs to be sufficiently large for reliable hue computation.
+	// For 6 bits RGB components, the maximum value of recognition, we arbitrary sets this to at least 
+	// 10% of the maximum RGB component. For 6 bits RGB color (as in RGB565 format) components, max = 63
+	// and min = 0.  Thus maximum difference is 63.  10% of this is 6.30. We then experiment with
+	// thresholds of 2 to 7 and select the best in terms of sensitivity and accuracy for the camera.
+	// Once we identified the condition where hue calculation is no valid, we need to distinguish 
+	// between too bright and too dark/grayscale conditions.  For these two scenarios, we analyze the maximum
+	// RGB value.  From experiment, we set the threshold at 30% or roughly 20.  Thus if 
+	// saturation level is too low, we check the maximum RGB level.  If this is <= 20, then it is
+	// 'No hue' due to low light condition.  Else it is 'No hue' due to too bright condition.
+	
+	if (nDeltaRGB < 2)              // Check if it is possible to make out the hue. 
+	{	
+									
+		//if (unMaxRGB < 12)			// Distinguish between too bright or too dark/grayscale conditions.	Using
+		//{							// maximum RGB criteria.
+		//	nHue = _NO_HUE_DARK; 
+		//} 
+		//else
+		//{
+		//	nHue = _NO_HUE_BRIGHT;	
+		//} 
+		
+		if(nLuminance < 60)			// Using luminance criteria.
+		{
+			nHue = _NO_HUE_DARK;
+		}
+		else
+		{
+			nHue = _NO_HUE_BRIGHT;
+		}
+	}
+	else   // Computation of hue, here I am using the hexagonal projection method for HSV color space, 
+			// as described in Wikipedia. https://en.wikipedia.org/wiki/HSL_and_HSV
+		   // This is easier than circular projection which require arc cosine function.
+	{
+		if (nR6 == unMaxRGB)          // nR6 is maximum. Note: since we are working with integers,
+		{                                          // be aware that when we perform integer division,
+			nHue = (60*(nG6 - nB6))/nDeltaRGB;   // the remainder will be discarded.
+		}
+		else if (nG6 == unMaxRGB)     // nG6 is maximum.
+		{
+			nHue = 120 + (60*(nB6 - nR6))/nDeltaRGB;
+		}
+		else                          // nB6 is maximum.
+		{
+			nHue = 240 + (60*(nR6 - nG6))/nDeltaRGB;
+		}
+     
+		if (nHue < 0)
+		{
+			nHue = nHue + 360;
+		}
+	}
+	
+	return nLuminance | (unSat << _SAT_SHIFT) | (nHue << _HUE_SHIFT);
+}
+
+/// Request a change of camera mode, _CAMERA_MODE_QQVGA_20FPS, _CAMERA_MODE_QVGA_11FPS or
+/// _CAMERA_MODE_QVGA_7FPS.  The camera driver re-programs the camera clock and registers at the end
+/// of the current frame.  Returns 1 if the mode is valid, else 0.
+
+int CameraSetMode(int nMode)
+{
+	if ((nMode < 0) || (nMode >= _CAMERA_NO_OF_MODES))
+	{
+		return 0;
+	}
+	gnCameraModeRequest = nMode;
+	return 1;
+}
+
 ///
 /// Function name		: Proce_TCM8230LCD_Driver
 ///
@@ -181,8 +299,8 @@ __STATIC_FORCEINLINE uint32_t __MREV16 (uint32_t op1)
 
 ///
 /// Description	:
-/// This driver supports 2 resolutions: QQVGA or QVGA.  User needs to comment or uncomment
-/// the definition for __QQVGA__ at the top of this file to select the resolution to use.
+/// This driver supports 2 resolutions: QQVGA or QVGA.  The resolution and frame rate can be changed at
+/// run-time with CameraSetMode(), the definition for __QQVGA__ in "Driver_LCD_ILI9341_V100.h" selects the start-up mode.
 ///
 /// 1. This process initializes, control and retrieves the raw digital data from
 /// the CMOS camera module TCM8230 made by Toshiba Corp. in 2004.  The TCM8230MD is a 
@@ -208,6 +326,11 @@ __STATIC_FORCEINLINE uint32_t __MREV16 (uint32_t op1)
 /// 5. Pre-processing of the pixels color output to extract the Luminance, Contrast, Hue and 
 /// Saturation is performed here, and the result for each pixel is stored in gunImgAtt[x][y].
 /// Where the x and y index denotes the pixel's location in the frame.
+/// 6. In QVGA resolution the RGB565 pixel data is stored in gun16ImgRGB[][] for display, and each 2x2
+/// pixels block is averaged before pre-processing.  Thus gunImgAtt[][] and gunImgAtt2[][] always hold a
+/// QQVGA frame (gnAnalysisWidth x gnAnalysisHeight) for the image processing algorithms.
+/// 7. Changing the camera mode switches PCK2 and re-programs camera registers 0x02 and 0x03 through
+/// states 6 and 7 between two frames (state 12), gnImageWidth and gnImageHeight are updated accordingly.
 
 // User to edit these:
 #define     _CAMERA_I2C2_ADD        60      // Camera I2C slave address.
@@ -227,18 +350,17 @@ void Proce_TCM8230LCD_Driver(TASK_ATTRIBUTE *ptrTask)
 	int nTemp; 
 	int nTemp2;
 	unsigned int unTemp;
+	unsigned int unTemp2;
+	unsigned int unRGBSum;
 	static int nLineCounter = 0;
 	static int nCount = 0;	
 	int ncolindex;
+	int nRow;
 
 	// Variables associated with image pre-processing.
 	//int nR5, nB5;
 	int nR6, nG6, nB6;
 	int nLuminance;
-	int nHue;
-	unsigned int unSat;
-	unsigned int unMaxRGB, unMinRGB;
-	int nDeltaRGB;
 	int	nLuminance1, nLuminance2, nLuminance3, nLuminance4, nLuminance5, nLuminance6;
 	int nLuminance7, nLuminance8;
 	int	nLumGradx, nLumGrady, nLumGrad;
@@ -268,6 +390,9 @@ void Proce_TCM8230LCD_Driver(TASK_ATTRIBUTE *ptrTask)
 					// future version of the hardware to take this into consideration.
 				
 				PIN_CAMRESET_CLEAR;							// Assert camera RESET.	
+				gnImageWidth = gstrcCameraMode[gnCameraMode].nWidth;			// Frame size of the start-up camera mode.
+				gnImageHeight = gstrcCameraMode[gnCameraMode].nHeight;
+				gnCameraResolution = gstrcCameraMode[gnCameraMode].nResolution;
 				//PIOB->PIO_ODSR |= PIO_ODSR_P2;				// Turn off camera power switch.  The power switch is
 															// TPS2041C, whose enable pin is active low.
 				/*											
@@ -358,23 +483,17 @@ void Proce_TCM8230LCD_Driver(TASK_ATTRIBUTE *ptrTask)
 				// Effective output = 12 MHz.
 				
 
-				#ifdef		__QQVGA__
 
-				PMC->PMC_PCK[2] = PMC_PCK_CSS_MCK | PMC_PCK_PRES(8);			// Set PCK2 pre-scaler = Value + 1, and select clock source as MCK (e.g. via PLLA/2).
-																				// Output PCK2 = 16.667 MHz, frame rate = 20.83 fps.				
 				//PMC->PMC_PCK[2] = PMC_PCK_CSS_MCK | PMC_PCK_PRES(9);			// Set PCK2 pre-scaler = Value + 1, and select clock source as MCK (e.g. via PLLA/2).
 																				// Output PCK2 = 15 MHz, frame rate = 18.75 fps.																				
 				//PMC->PMC_PCK[2] = PMC_PCK_CSS_MAIN_CLK | PMC_PCK_PRES(0);		// Set PCK2 pre-scaler = Value + 1, and select clock source as MAIN_CLK (e.g. the crystal oscillator).
 																				// MAIN_CLK = 12 MHz, Prescaler = 1.  Thus output of PCK2 = 12 MHz.  Frame rate = 15 fps.
-				#else															// QVGA resolution
 				//PMC->PMC_PCK[2] = PMC_PCK_CSS_MAIN_CLK | PMC_PCK_PRES(1);		// PCK2 = 6 MHz, frame rate = 7.5 fps. For QVGA resolution.	
 				//PMC->PMC_PCK[2] = PMC_PCK_CSS_MCK | PMC_PCK_PRES(17);			// Set PCK2 pre-scaler = Value + 1, and select clock source as MCK (e.g. via PLLA/2).
 																				// Output PCK2 = 8.333 MHz, frame rate = 10.41 fps.	(From experiment this is the most stable).	
 				//PMC->PMC_PCK[2] = PMC_PCK_CSS_MCK | PMC_PCK_PRES(16);			// Set PCK2 pre-scaler = Value + 1, and select clock source as MCK (e.g. via PLLA/2).
 																				// Output PCK2 = 8.823 MHz, frame rate = 11.02 fps.																																								
-				PMC->PMC_PCK[2] = PMC_PCK_CSS_MCK | PMC_PCK_PRES(15);			// Set PCK2 pre-scaler = Value + 1, and select clock source as MCK (e.g. via PLLA/2).
-																				// Output PCK2 = 9.375 MHz, frame rate = 11.72 fps.																																															
-				#endif
+				PMC->PMC_PCK[2] = gstrcCameraMode[gnCameraMode].unPCK2;			// Set PCK2 pre-scaler and clock source for the camera mode.
 				
 				PIOB->PIO_PDR = (PIOB->PIO_PDR) | PIO_PDR_P3;					// Set PB3 to be controlled by Peripheral.
 				PMC->PMC_SCER = PMC_SCER_PCK2;									// Enable PCK2.
@@ -458,7 +577,7 @@ void Proce_TCM8230LCD_Driver(TASK_ATTRIBUTE *ptrTask)
 				{
 					gbytI2CByteCount = 1;				// Indicate no. of bytes to transmit.
 					gbytI2CRegAdd = 0x02;				// Start address of register.
-					gbytI2CTXbuf[0] = 0x00;				// Data.  Max frame rate is 30 fps.
+					gbytI2CTXbuf[0] = gstrcCameraMode[gnCameraMode].bytReg02;	// Data.  0x00 = Max frame rate is 30 fps.
 					//gbytI2CTXbuf[0] = 0x80;				// Data.  Max frame rate is 15 fps.
 					gbytI2CSlaveAdd =  _CAMERA_I2C2_ADD;	// Camera I2C slave address.
 					gI2CStat.bSend = 1;
@@ -481,11 +600,7 @@ void Proce_TCM8230LCD_Driver(TASK_ATTRIBUTE *ptrTask)
 				     gbytI2CByteCount = 1;				// Indicate no. of bytes to transmit.
 				     gbytI2CRegAdd = 0x03;				// Start address of register.
 					 
-					 #ifdef		__QQVGA__				// Set camera output resolution.		 
-				     gbytI2CTXbuf[0] = 0x0E;			// Data, QQVGA(f).
-					 #else
-					 gbytI2CTXbuf[0] = 0x06;			// Data, QVGA(f).
-					 #endif
+					 gbytI2CTXbuf[0] = gstrcCameraMode[gnCameraMode].bytReg03;	// Data, set camera output resolution, QQVGA(f) = 0x0E, QVGA(f) = 0x06.
 					 
 					 //gbytI2CTXbuf[0] = 0x0A;			// Data, QVGA(z).
 					 //gbytI2CTXbuf[0] = 0x12;			// Data, QQVGA(z).
@@ -580,267 +695,188 @@ void Proce_TCM8230LCD_Driver(TASK_ATTRIBUTE *ptrTask)
 					SCB_InvalidateDCache();							// Mark the data cache as invalid. Subsequent read from DCache forces data to be copied from SRAM to
 																	// the cache.  This is to be used after XDMAC updates the SRAM without the knowledge of the CPU's cache
 																	// controller.
-					#ifdef		__QQVGA__
+					if (gnCameraResolution == _CAMERA_RES_QQVGA)
+					{
 					
-					// --- Pre-processing one line of image data here ---
-					// Extract intensity.					
-					for (ncolindex = 0; ncolindex < gnImageWidth; ncolindex++)
-					{				
-						// --- Compute the 8-bits grey scale or intensity value of each pixel and
-						// update grey scale histogram ---
-						//nTemp2 = gun16Pixel[ncolindex];		// First get the 16-bits pixel word from line buffer.
+						// --- Pre-processing one line of image data here ---
+						nRow = nLineCounter - 1;						// Current row in the frame.
+						for (ncolindex = 0; ncolindex < gnImageWidth; ncolindex++)
+						{				
+							// --- Compute the 8-bits grey scale or intensity value of each pixel and
+							// update grey scale histogram ---
+							//nTemp2 = gun16Pixel[ncolindex];		// First get the 16-bits pixel word from line buffer.
 						
-						// Assume data read into parallel bus by ARM Cortex M7 is: [Byte0][Byte1]
-						// nTemp = (nTemp2 << 8) & 0xFF00;		// Swap the position of lower and upper 8 bits!
-						// nTemp2 = (nTemp2 >> 8) & 0xFF;		// This is due to the way the PDC store the pixel data.  
-															    // 14 Jan 2016: The upper 16 bits may not be 0! Thus need
-															    // to mask off. 
-						// nTemp = nTemp + nTemp2;				// Reform the 16-bits pixel data, in RGB565 format.
-
-						// The data read into parallel bus by ARM Cortex M7 is: [Byte0][Byte1], e.g. in big endian format.
-						// However, the correct order should be small endian, so we need to swap the bytes order to obtain
-						// [Byte1][Byte0].
-						// Get back the original RGB565 data.
-						unTemp = __REV16(gun16Pixel[ncolindex]);	// Swap the position of lower and upper 8 bits!
-																	// The original method achieve this using C routines as
-																	// shown above, but using inline assembly instruction 
-																	// is more efficient.
-
-						nR6 = (unTemp >> 10) & 0x3E;				// Form the 6 bits R component.
-						nG6 = (unTemp >> 5) & 0x3F;					// Get the 6 bits G component.															
-						nB6 = (unTemp & 0x01F)<<1;					// For the 6 bits B component. 
+							// Assume data read into parallel bus by ARM Cortex M7 is: [Byte0][Byte1]
+							// nTemp = (nTemp2 << 8) & 0xFF00;		// Swap the position of lower and upper 8 bits!
+							// nTemp2 = (nTemp2 >> 8) & 0xFF;		// This is due to the way the PDC store the pixel data.  
+																    // 14 Jan 2016: The upper 16 bits may not be 0! Thus need
+																    // to mask off. 
+							// nTemp = nTemp + nTemp2;				// Reform the 16-bits pixel data, in RGB565 format.
+
+							// The data read into parallel bus by ARM Cortex M7 is: [Byte0][Byte1], e.g. in big endian format.
+							// However, the correct order should be small endian, so we need to swap the bytes order to obtain
+							// [Byte1][Byte0].
+							// Get back the original RGB565 data.
+							unTemp = __REV16(gun16Pixel[ncolindex]);	// Swap the position of lower and upper 8 bits!
+																		// The original method achieve this using C routines as
+																		// shown above, but using inline assembly instruction 
+																		// is more efficient.
+
+							nR6 = (unTemp >> 10) & 0x3E;				// Form the 6 bits R component.
+							nG6 = (unTemp >> 5) & 0x3F;					// Get the 6 bits G component.															
+							nB6 = (unTemp & 0x01F)<<1;					// For the 6 bits B component. 
 																							
-						// --- 6 Jan 2015 ---
-						// Here we approximate the luminance I (or Y) as:
-						// I = 0.250R + 0.625G + 0.125B = (2R + 5G + B)/8
-						// where R, G and B ranges from 0 to 255.
-						// or I = (2*R + 5*G + B)>>3 for integer variables R, G, B.
-						// This avoids multiplication with real number, hence speeding up the
-						// computation, though with the increase in blue and decrease
-						// in green components intensities, we would get a slightly darker
-						// gray scale image.
+							unTemp = unPixelAttribute(nR6, nG6, nB6);	// Compute luminance, hue and saturation.
+							nLuminance = unTemp & _LUMINANCE_MASK;
 						
-						//	nLuminance = (2*(nR5<<3) + 5*(nG6<<2) + (nB5<<3))>>3;
-						
-						// Alternatively since actual values for R, G and B are 5, 6 and 5 bits respectively,
-						// we can normalize R and B to 6 bits by shifting, then convert to gray scale as:
-						//	nLuminance = (2*(nR5<<1) + 5*(nG6) + (nB5<<1))>>2;
-						
-						// Or more efficient alternative, with no multiplication:
-						//	nLuminance = ((nR5<<2) + (nG6<<2) + (nB5<<1) + nG6)>>2;
-						// This will result in gray scale value from 0 to 127, occupying 7 bits.
-						
-						if (gnLuminanceMode == 0)
-						{	
-							//nLuminance = ((nR5<<2) + (nG6<<2) + (nB5<<1) + nG6)>>2; // 7-bits luminance from RGB components.
-							nLuminance = ((nR6<<1) + (nG6<<2) + nB6 + nG6)>>2; // 7-bits luminance from RGB components.
-						}
-						else if (gnLuminanceMode == 1) 
-						{
-							//nLuminance = nR5<<2;	// 7-bits luminance from only 5-bits Red component.
-							nLuminance = nR6<<1;	// 7-bits luminance from only 6-bits Red component.
-						}
-						else if (gnLuminanceMode == 2)
-						{
-							nLuminance = nG6<<1;	// 7-bits luminance from only 6-bits Green component.					
-						}
-						else
-						{
-							//nLuminance = nB5<<2;	// 7-bits luminance from only 5-bits Blue component.
-							nLuminance = nB6<<1;	// 7-bits luminance from only 6-bits Blue component.
-						}				
-						
-						unLumCumulative = unLumCumulative + nLuminance;							// Update the sum of luminance for all pixels in the frame.
-						
-						gunIHisto[nLuminance]++;												// Update the intensity histogram.
-						
-
-						// --- Compute the saturation level ---
-						unMaxRGB = Max(nR6, Max(nG6, nB6));     // Find the maximum of R, G or B component
-						unMinRGB = Min(nR6, Min(nG6, nB6));     // Find the minimum of R, G or B components.
-						nDeltaRGB = unMaxRGB - unMinRGB;
-						unSat = nDeltaRGB;                         
-						// Note: Here we define the saturation as the difference between the maximum and minimum RGB values.
-						// A more proper term is called Chroma (as per Wikipedia article).
-						// In normal usage this value needs to be normalized with respect to maximum RGB value so that
-						// saturation is between 0.0 to 1.0.  Here to speed up computation we avoid using floating point
-						// variables. Thus the saturation is 6 bits since the color components are 6 bits, from 0 to 63.
-
-						// --- Compute the hue ---
-						// When saturation is too low, the color is near gray scale, and hue value is not accurate.
-						// Similarly when the light is too bright, the difference between color components may not be large
-						// enough to work out the hue, and hue is also not accurate.  
-						// From color theory (e.g. see Digital Image Processing by Gonzales and Woods, 2018), the minimum 
-						// RGB component intensity corresponds to the white level intensity.  Thus the difference
-						// between maximum RGB component and white level is an indication of the saturation level.
-						// This difference needs to be sufficiently large for reliable hue computation.
-						// For 6 bits RGB components, the maximum value of recognition, we arbitrary sets this to at least 
-						// 10% of the maximum RGB component. For 6 bits RGB color (as in RGB565 format) components, max = 63
-						// and min = 0.  Thus maximum difference is 63.  10% of this is 6.30. We then experiment with
-						// thresholds of 2 to 7 and select the best in terms of sensitivity and accuracy for the camera.
-						// Once we identified the condition where hue calculation is no valid, we need to distinguish 
-						// between too bright and too dark/grayscale conditions.  For these two scenarios, we analyze the maximum
-						// RGB value.  From experiment, we set the threshold at 30% or roughly 20.  Thus if 
-						// saturation level is too low, we check the maximum RGB level.  If this is <= 20, then it is
-						// 'No hue' due to low light condition.  Else it is 'No hue' due to too bright condition.
+							unLumCumulative = unLumCumulative + nLuminance;							// Update the sum of luminance for all pixels in the frame.
 						
-						if (nDeltaRGB < 2)              // Check if it is possible to make out the hue. 
-						{	
-														
-							//if (unMaxRGB < 12)			// Distinguish between too bright or too dark/grayscale conditions.	Using
-							//{							// maximum RGB criteria.
-							//	nHue = _NO_HUE_DARK; 
-							//} 
-							//else
-							//{
-							//	nHue = _NO_HUE_BRIGHT;	
-							//} 
-							
-							if(nLuminance < 60)			// Using luminance criteria.
-							{
-								nHue = _NO_HUE_DARK;
-							}
-							else
-							{
-								nHue = _NO_HUE_BRIGHT;
-							}
-						}
-						else   // Computation of hue, here I am using the hexagonal projection method for HSV color space, 
-								// as described in Wikipedia. https://en.wikipedia.org/wiki/HSL_and_HSV
-							   // This is easier than circular projection which require arc cosine function.
-						{
-							if (nR6 == unMaxRGB)          // nR6 is maximum. Note: since we are working with integers,
-							{                                          // be aware that when we perform integer division,
-								nHue = (60*(nG6 - nB6))/nDeltaRGB;   // the remainder will be discarded.
-							}
-							else if (nG6 == unMaxRGB)     // nG6 is maximum.
-							{
-								nHue = 120 + (60*(nB6 - nR6))/nDeltaRGB;
-							}
-							else if (nB6 == unMaxRGB)     // nB6 is maximum.
-							{
-								nHue = 240 + (60*(nR6 - nG6))/nDeltaRGB;
-							}
-		                 
-							if (nHue < 0)
-							{
-								nHue = nHue + 360;
-							}
-						}
+							gunIHisto[nLuminance]++;												// Update the intensity histogram.
 						
-						/* Temporay disable the Sobel Kernel operation.
-						// Computing the luminance gradient using Sobel's Kernel.
-						if ((ncolindex > 1) && (nLineCounter > 1))						// See notes on the derivation of this range.
-						{
-							// See notes. For 1st column of interest we need to read all 8 adjacent pixel luminance to compute the 
-							// gradients along vertical and horizontal axis.  For subsequent columns we only need to read in the 
-							// luminance values for 4 adjacent pixels.
-							//  |  L1 L7 L2  ---> Columns
-							//  |  L3 G  L4
-							// \|/ L5 L8 L6   Where L6 = Current pixel under process, G = pixel whose gradient we are computing.
-							//  Rows
-							if (ncolindex == 2)
+							/* Temporay disable the Sobel Kernel operation.
+							// Computing the luminance gradient using Sobel's Kernel.
+							if ((ncolindex > 1) && (nLineCounter > 1))						// See notes on the derivation of this range.
 							{
-								nLuminance1 = gunImgAtt[ncolindex-2][nLineCounter-2] & _LUMINANCE_MASK;
-								nLuminance5 = gunImgAtt[ncolindex-2][nLineCounter] & _LUMINANCE_MASK;
-								nLuminance7 = gunImgAtt[ncolindex-1][nLineCounter-2] & _LUMINANCE_MASK;
-								nLuminance8 = gunImgAtt[ncolindex-1][nLineCounter] & _LUMINANCE_MASK;								
-							}
+								// See notes. For 1st column of interest we need to read all 8 adjacent pixel luminance to compute the 
+								// gradients along vertical and horizontal axis.  For subsequent columns we only need to read in the 
+								// luminance values for 4 adjacent pixels.
+								//  |  L1 L7 L2  ---> Columns
+								//  |  L3 G  L4
+								// \|/ L5 L8 L6   Where L6 = Current pixel under process, G = pixel whose gradient we are computing.
+								//  Rows
+								if (ncolindex == 2)
+								{
+									nLuminance1 = gunImgAtt[ncolindex-2][nLineCounter-2] & _LUMINANCE_MASK;
+									nLuminance5 = gunImgAtt[ncolindex-2][nLineCounter] & _LUMINANCE_MASK;
+									nLuminance7 = gunImgAtt[ncolindex-1][nLineCounter-2] & _LUMINANCE_MASK;
+									nLuminance8 = gunImgAtt[ncolindex-1][nLineCounter] & _LUMINANCE_MASK;								
+								}
 															
-							nLuminance2 = gunImgAtt[ncolindex][nLineCounter-2] & _LUMINANCE_MASK;	
-							nLuminance3 = gunImgAtt[ncolindex-2][nLineCounter-1] & _LUMINANCE_MASK;
-							nLuminance4 = gunImgAtt[ncolindex][nLineCounter-1] & _LUMINANCE_MASK;							
-							//nLuminance6 = gunImgAtt[ncolindex][nLineCounter] & _LUMINANCE_MASK;	// This is the same as nLuminance.					
-							nLuminance6 = nLuminance;	
+								nLuminance2 = gunImgAtt[ncolindex][nLineCounter-2] & _LUMINANCE_MASK;	
+								nLuminance3 = gunImgAtt[ncolindex-2][nLineCounter-1] & _LUMINANCE_MASK;
+								nLuminance4 = gunImgAtt[ncolindex][nLineCounter-1] & _LUMINANCE_MASK;							
+								//nLuminance6 = gunImgAtt[ncolindex][nLineCounter] & _LUMINANCE_MASK;	// This is the same as nLuminance.					
+								nLuminance6 = nLuminance;	
 					
 							
-							// Calculate x gradient											
-							nLumGradx = nLuminance2  + nLuminance6 - nLuminance1 - nLuminance5;
-							nLumGradx = nLumGradx + ((nLuminance4 - nLuminance3) << 1);
-							// Calculate y gradient
-							nLumGrady = nLuminance5  + nLuminance6 - nLuminance1 - nLuminance2;
-							nLumGrady = nLumGradx + ((nLuminance8 - nLuminance7) << 1);
-
-							// Shift samples to obtain current adjacent luminance values.  This is faster than reading the values from 
-							// a 2D array and apply masking to extract the luminance.
-							nLuminance1 = nLuminance7;
-							nLuminance5 = nLuminance8;
-							nLuminance7 = nLuminance2;
-							nLuminance8 = nLuminance6;
+								// Calculate x gradient											
+								nLumGradx = nLuminance2  + nLuminance6 - nLuminance1 - nLuminance5;
+								nLumGradx = nLumGradx + ((nLuminance4 - nLuminance3) << 1);
+								// Calculate y gradient
+								nLumGrady = nLuminance5  + nLuminance6 - nLuminance1 - nLuminance2;
+								nLumGrady = nLumGradx + ((nLuminance8 - nLuminance7) << 1);
+
+								// Shift samples to obtain current adjacent luminance values.  This is faster than reading the values from 
+								// a 2D array and apply masking to extract the luminance.
+								nLuminance1 = nLuminance7;
+								nLuminance5 = nLuminance8;
+								nLuminance7 = nLuminance2;
+								nLuminance8 = nLuminance6;
 							
-							if (nLumGradx < 0)		// Only magnitude is required.
-							{
-								nLumGradx = -nLumGradx;
-							}
-							if (nLumGrady < 0)		// Only magnitude is required.
-							{
-								nLumGrady = -nLumGrady;
+								if (nLumGradx < 0)		// Only magnitude is required.
+								{
+									nLumGradx = -nLumGradx;
+								}
+								if (nLumGrady < 0)		// Only magnitude is required.
+								{
+									nLumGrady = -nLumGrady;
+								}
+																	// Calculate the magnitude of the luminance gradient.
+								nLumGrad = nLumGradx + nLumGrady;	// It should be nLumGrad = sqrt(nLumGradx^2 + nLumGrady^2)
+																	// Here we the approximation nLumGrad = |nLumGradx| + |nLumGrady|
+
+								if (nLumGrad > 127)		// Limit the maximum value to 127 (7 bits only).  Bit8 is not used for
+								{						// luminance indication.
+									nLumGrad = 127;
+								}
+								if (nLumGrad < 20)		// To remove gradient noise.  Can reduce to 10 if the camera quality is good.
+								{
+									nLumGrad = 0;
+								}
 							}
-																// Calculate the magnitude of the luminance gradient.
-							nLumGrad = nLumGradx + nLumGrady;	// It should be nLumGrad = sqrt(nLumGradx^2 + nLumGrady^2)
-																// Here we the approximation nLumGrad = |nLumGradx| + |nLumGrady|
-
-							if (nLumGrad > 127)		// Limit the maximum value to 127 (7 bits only).  Bit8 is not used for
-							{						// luminance indication.
-								nLumGrad = 127;
-							}
-							if (nLumGrad < 20)		// To remove gradient noise.  Can reduce to 10 if the camera quality is good.
+							else
 							{
 								nLumGrad = 0;
-							}
-						}
-						else
-						{
-							nLumGrad = 0;
-						} 
-						*/
+							} 
+							*/
 						
-						// Update the pixel attributes.
+							// Update the pixel attributes.
 														
-						// Consolidate all the pixel attribute into the attribute array.
-						if ((gnFrameCounter & 0x00000001) == 1)			// If frame number is odd.
-						{												// processes.  So we should update gunImgAtt2[].
-							gunImgAtt2[ncolindex][nLineCounter] = nLuminance | (unSat << _SAT_SHIFT) | (nHue << _HUE_SHIFT);
-							gunImgAtt2[ncolindex-1][nLineCounter-1] = gunImgAtt2[ncolindex-1][nLineCounter-1] | (nLumGrad << _GRAD_SHIFT);					
-						}
-						else                                            // Frame number is even.
-						{	
-																		// Data in gunImgAtt2[] is being accessed by other processes.																		
-							gunImgAtt[ncolindex][nLineCounter] = nLuminance | (unSat << _SAT_SHIFT) | (nHue << _HUE_SHIFT);
-							gunImgAtt[ncolindex-1][nLineCounter-1] = gunImgAtt[ncolindex-1][nLineCounter-1] | (nLumGrad << _GRAD_SHIFT);
-						}
-
-					} // for (ncolindex = 0; ncolindex < gnImageWidth; ncolindex++)							
-					
-					#else
+							// Consolidate all the pixel attribute into the attribute array.
+							if ((gnFrameCounter & 0x00000001) == 1)			// If frame number is odd.
+							{												// processes.  So we should update gunImgAtt2[].
+								gunImgAtt2[ncolindex][nRow] = unTemp;
+							}
+							else                                            // Frame number is even.
+							{	
+																			// Data in gunImgAtt2[] is being accessed by other processes.																		
+								gunImgAtt[ncolindex][nRow] = unTemp;
+							}
+
+						} // for (ncolindex = 0; ncolindex < gnImageWidth; ncolindex++)							
 					
-					// --- Transfer the received line of pixel to image frame buffer ---					
-					for (ncolindex = 0; ncolindex < gnImageWidth; ncolindex++)
-					{				
+					}
+					else
+					{
 					
-						nTemp2 = gun16Pixel[ncolindex];
+						// --- Transfer the received line of pixel to image frame buffer ---
+						// At the same time each 2x2 pixels block is averaged into one pixel of the QQVGA analysis
+						// frame buffer, so that the image processing algorithms can run while capturing at QVGA.  The
+						// 6-bits R, G and B components of each horizontal pixel pair are summed on even rows, and
+						// the 2x2 block average is converted to pixel attributes on the following odd row.
+						nRow = nLineCounter - 1;						// Current row in the frame.
+						for (ncolindex = 0; ncolindex < gnImageWidth; ncolindex = ncolindex + 2)
+						{				
+							// Assume data read into parallel bus by ARM Cortex M7 is MSByte last: [Byte0][Byte1]
+							//nTemp = (nTemp2 << 8) & 0xFF00;		// Swap the position of lower and upper 8 bits!
+							//nTemp2 = (nTemp2 >> 8) & 0xFF;		// This is due to the way the PDC store the pixel data.
+																// 14 Jan 2016: The upper 16 bits may not be 0! Thus need
+																// to mask off.
+							//gunImgAtt[ncolindex][nLineCounter] = nTemp + nTemp2;	
 						
-						// Assume data read into parallel bus by ARM Cortex M7 is MSByte last: [Byte0][Byte1]
-						//nTemp = (nTemp2 << 8) & 0xFF00;		// Swap the position of lower and upper 8 bits!
-						//nTemp2 = (nTemp2 >> 8) & 0xFF;		// This is due to the way the PDC store the pixel data.
-															// 14 Jan 2016: The upper 16 bits may not be 0! Thus need
-															// to mask off.
-						//gunImgAtt[ncolindex][nLineCounter] = nTemp + nTemp2;	
+							// The data read into parallel bus by ARM Cortex M7 is: [Byte0][Byte1], e.g. in big endian format.
+							// However, the correct order should be small endian, so we need to swap the bytes order to obtain
+							// [Byte1][Byte0].
+							unTemp = __REV16(gun16Pixel[ncolindex]);		// Swap the position of lower and upper 8 bits!
+							unTemp2 = __REV16(gun16Pixel[ncolindex+1]);	
+							gun16ImgRGB[ncolindex][nRow] = unTemp;
+							gun16ImgRGB[ncolindex+1][nRow] = unTemp2;
 						
-						// The data read into parallel bus by ARM Cortex M7 is: [Byte0][Byte1], e.g. in big endian format.
-						// However, the correct order should be small endian, so we need to swap the bytes order to obtain
-						// [Byte1][Byte0].
-						gunImgAtt[ncolindex][nLineCounter] = __REV16(gun16Pixel[ncolindex]);	// Swap the position of lower and upper 8 bits!
-						// The original method achieve this using C routines as
-						// shown above, but using inline assembly instruction
-						// is more efficient.
-																		
-						// Note: 1 Oct 2020, I find that using the above and the inline assembly version produce similar timing result.
-						// This shows that the compiler is already highly optimized!
-						//gunImgAtt[ncolindex][nLineCounter] = __MREV16(gn16Pixel[ncolindex]);		
-									
-					} // for (ncolindex = 0; ncolindex < gnImageWidth; ncolindex++)	
-					#endif
+							// Note: 1 Oct 2020, I find that using the above and the inline assembly version produce similar timing result.
+							// This shows that the compiler is already highly optimized!
+						
+							unRGBSum = ((unTemp >> 10) & 0x3E) + ((unTemp2 >> 10) & 0x3E);						// Sum of 6-bits R components.
+							unRGBSum = unRGBSum + ((((unTemp >> 5) & 0x3F) + ((unTemp2 >> 5) & 0x3F)) << 8);	// Sum of 6-bits G components.
+							unRGBSum = unRGBSum + (((unTemp & 0x1F) + (unTemp2 & 0x1F)) << 17);				// Sum of 6-bits B components.
+						
+							if ((nRow & 0x00000001) == 0)					// Even row, keep the pixel pair sum for the next row.
+							{
+								gunRGBPairSum[ncolindex>>1] = unRGBSum;
+							}
+							else											// Odd row, average the 2x2 pixels block with rounding.
+							{												// Each component sum is at most 4x63 + 2, so there is no 
+																			// carry into the next component.
+								unRGBSum = unRGBSum + gunRGBPairSum[ncolindex>>1] + 0x00020202;
+								nR6 = (unRGBSum >> 2) & 0x3F;
+								nG6 = (unRGBSum >> 10) & 0x3F;
+								nB6 = (unRGBSum >> 18) & 0x3F;
+							
+								unTemp = unPixelAttribute(nR6, nG6, nB6);	// Compute luminance, hue and saturation.
+								nLuminance = unTemp & _LUMINANCE_MASK;
+								unLumCumulative = unLumCumulative + nLuminance;						// Update the sum of luminance for all pixels in the frame.
+								gunIHisto[nLuminance]++;											// Update the intensity histogram.
+							
+								if ((gnFrameCounter & 0x00000001) == 1)		// If frame number is odd, update gunImgAtt2[].
+								{
+									gunImgAtt2[ncolindex>>1][nRow>>1] = unTemp;
+								}
+								else										// Frame number is even, update gunImgAtt[].
+								{
+									gunImgAtt[ncolindex>>1][nRow>>1] = unTemp;
+								}
+							}
+						} // for (ncolindex = 0; ncolindex < gnImageWidth; ncolindex = ncolindex + 2)	
+					}
 										
 					//PIN_FLAG2_CLEAR;													
 				}
@@ -878,7 +914,27 @@ void Proce_TCM8230LCD_Driver(TASK_ATTRIBUTE *ptrTask)
 																// algorithm should get the pixel attributes from Frame Buffer 1.					
 				}
 				gnFrameCounter++;								// Update frame counter.
-				OSSetTaskContext(ptrTask, 8, 1);				// Next state = 8, timer = 1.
+				if (gnCameraModeRequest != gnCameraMode)		// Check for request to change camera mode.
+				{
+					OSSetTaskContext(ptrTask, 12, 1);			// Next state = 12, timer = 1.
+				}
+				else
+				{
+					OSSetTaskContext(ptrTask, 8, 1);			// Next state = 8, timer = 1.
+				}
+			break;
+
+			case 12: // State 12 - Change camera mode.  This is done between frames, the camera clock PCK2 is changed first, then
+					 // the camera registers are re-programmed in states 6 and 7 before resuming capture in state 8.
+				gnCameraMode = gnCameraModeRequest;
+				PMC->PMC_SCDR = PMC_SCDR_PCK2;									// Disable PCK2 before changing the pre-scaler.
+				PMC->PMC_PCK[2] = gstrcCameraMode[gnCameraMode].unPCK2;			// Set PCK2 pre-scaler and clock source for the camera mode.
+				PMC->PMC_SCER = PMC_SCER_PCK2;									// Enable PCK2.
+				gnImageWidth = gstrcCameraMode[gnCameraMode].nWidth;
+				gnImageHeight = gstrcCameraMode[gnCameraMode].nHeight;
+				gnCameraResolution = gstrcCameraMode[gnCameraMode].nResolution;
+				XDMAC->XDMAC_CHID[0].XDMAC_CUBC = XDMAC_CUBC_UBLEN(gnImageWidth);	// Set the no. of pixels in a line.
+				OSSetTaskContext(ptrTask, 6, 5*__NUM_SYSTEMTICK_MSEC);			// Next state = 6, timer = 5 msec.
 			break;
 			
 			default:
@@ -19,24 +19,33 @@
 //
 // --- PUBLIC CONSTANTS ---
 //
-//#define		__QQVGA__				// Comment this out. We want QVGA resolution.
-										// IMPORTANT: To also comment this definition out in the 
-										// corresponding C file.
+// The camera resolution and frame rate can be changed at run-time with CameraSetMode(), the start-up
+// mode is selected by the definition of __QQVGA__ in "Driver_LCD_ILI9341_V100.h".
+// In QVGA resolution the RGB565 pixel data is kept in gun16ImgRGB[][] and each 2x2 pixels block is
+// averaged into the pixel attribute buffers.  Thus the pixel attribute buffers gunImgAtt[][] and
+// gunImgAtt2[][] are always QQVGA, and image processing algorithms run in both resolutions.
 
-#ifdef		__QQVGA__
-
-#define _IMAGE_HRESOLUTION   160		// For 160x120 pixels QQVGA resolution.
-#define _IMAGE_VRESOLUTION   120
-#define _NOPIXELSINFRAME	 19200
+#define _IMAGE_HRESOLUTION   320		// Maximum resolution, 320x240 pixels QVGA.  The frame buffers
+#define _IMAGE_VRESOLUTION   240		// are dimensioned for this, gnImageWidth and gnImageHeight give
+#define _NOPIXELSINFRAME	 76800		// the resolution of the current camera mode.
 
-#else
+#define _CAMERA_RES_QQVGA			0	// 160x120 pixels.
+#define _CAMERA_RES_QVGA			1	// 320x240 pixels.
 
-#define _IMAGE_HRESOLUTION   320		// For 320x240 pixels QVGA resolution.
-#define _IMAGE_VRESOLUTION   240
-#define _NOPIXELSINFRAME	 76800
+#define _CAMERA_MODE_QQVGA_20FPS	0	// QQVGA at 20.83 fps, for fast image processing.
+#define _CAMERA_MODE_QVGA_11FPS		1	// QVGA at 11.72 fps.
+#define _CAMERA_MODE_QVGA_7FPS		2	// QVGA at 7.5 fps, for inspection.
+#define _CAMERA_NO_OF_MODES			3
 
+#ifdef		__QQVGA__
+#define _CAMERA_MODE_DEFAULT		_CAMERA_MODE_QQVGA_20FPS
+#else
+#define _CAMERA_MODE_DEFAULT		_CAMERA_MODE_QVGA_11FPS
 #endif
 
+#define _ANALYSIS_HRESOLUTION	160		// Resolution of the pixel attribute buffers.
+#define _ANALYSIS_VRESOLUTION	120
+
 //
 // --- PUBLIC VARIABLES ---
 //
@@ -44,6 +53,10 @@
 extern	int		gnFrameCounter;
 extern	int		gnImageWidth;
 extern	int		gnImageHeight;
+extern	int		gnAnalysisWidth;		// Width and height of the pixel attribute buffers.
+extern	int		gnAnalysisHeight;
+extern	int		gnCameraMode;			// Current camera mode, _CAMERA_MODE_xxx.
+extern	int		gnCameraResolution;		// Current camera resolution, _CAMERA_RES_QQVGA or _CAMERA_RES_QVGA.
 extern	unsigned	int		gnCameraLED;
 extern	int		gnLuminanceMode;	// Option to set how luminance value for each pixel
 									// is computed from the RGB component.
@@ -52,16 +65,10 @@ extern	int		gnLuminanceMode;	// Option to set how luminance value for each pixel
 									// 1 - I = 4R
 									// 2 - I = 2G
 									// Else - I = 4B
-#ifdef		__QQVGA__
-
-extern	unsigned int gunImgAtt[_IMAGE_HRESOLUTION][_IMAGE_VRESOLUTION];
-extern	unsigned int gunImgAtt2[_IMAGE_HRESOLUTION][_IMAGE_VRESOLUTION];
-
-#else
-
-extern	int16_t gunImgAtt[_IMAGE_HRESOLUTION][_IMAGE_VRESOLUTION];
+extern	unsigned int gunImgAtt[_ANALYSIS_HRESOLUTION][_ANALYSIS_VRESOLUTION];
+extern	unsigned int gunImgAtt2[_ANALYSIS_HRESOLUTION][_ANALYSIS_VRESOLUTION];
 
-#endif
+extern	uint16_t gun16ImgRGB[_IMAGE_HRESOLUTION][_IMAGE_VRESOLUTION];	// RGB565 pixel data at full resolution, QVGA only.
 
 extern	int		gnValidFrameBuffer;		// If equals 1, it means gunImgAtt[] data can be used for image processing.
 // If equals 2, then gunImgAtt2[] data can be used instead for image processing.
@@ -77,7 +84,7 @@ extern	int		gnValidFrameBuffer;		// If equals 1, it means gunImgAtt[] data can b
 // bit30 - bit23 = Luminance gradient, 8 - bits.
 // bit31 - Special flag.
 #define     _LUMINANCE_MASK     0x0000007F  // luminance mask, bit6-0.
-#define     _CLUMINANCE_MASK    0xFFFFFF00  // One's complement of luminance mask.
+#define     _CLUMINANCE_MASK    0xFFFFFF80  // One's complement of luminance mask.
 #define     _LUMINANCE_SHIFT    0
 #define     _HUE_MASK           0x0001FF00  // bit16-8
 #define     _HUE_SHIFT          8
@@ -102,5 +109,6 @@ extern int				gnCameraReady;
 //
 void Proce_TCM8230LCD_Driver(TASK_ATTRIBUTE *);
 void Proce_Camera_LED_Driver(TASK_ATTRIBUTE *);
+int CameraSetMode(int);
 
 #endif
@@ -108,8 +108,8 @@ void ImageProcessingAlgorithm3(TASK_ATTRIBUTE *ptrTask)
 	static int nCounter, nHueCounterCol;
 	static int nMaxCol, nMaxRow;
 	static int nMaxValueCol, nMaxValueRow;
-	static	int		nHOIHistoCol[_IMAGE_HRESOLUTION];		// Hue-of-interest (HOI) histogram for each column.
-	static  int		nHOIHistoRow[_IMAGE_VRESOLUTION];		// Hue-of-interest (HOI) histogram for each row.
+	static	int		nHOIHistoCol[_ANALYSIS_HRESOLUTION];		// Hue-of-interest (HOI) histogram for each column.
+	static  int		nHOIHistoRow[_ANALYSIS_VRESOLUTION];		// Hue-of-interest (HOI) histogram for each row.
 	
 	if (ptrTask->nTimer == 0)
 	{
@@ -127,11 +127,11 @@ void ImageProcessingAlgorithm3(TASK_ATTRIBUTE *ptrTask)
 				nCurrentFrame = gnFrameCounter;								// Update current frame counter.			
 				//PIN_FLAG4_SET;											// Set indicator flag, this is optional, for debugging purpose.
 				nXindex = 1;												// Ignore 1st Column (i.e. Column 0).
-				for (nIndex = 0; nIndex < _IMAGE_HRESOLUTION-1; nIndex++)	// Clear the HOI column histogram.
+				for (nIndex = 0; nIndex < _ANALYSIS_HRESOLUTION-1; nIndex++)	// Clear the HOI column histogram.
 				{
 					nHOIHistoCol[nIndex] = 0;
 				}
-				for (nIndex = 0; nIndex < _IMAGE_VRESOLUTION-1; nIndex++)	// Clear the HOI row histogram.
+				for (nIndex = 0; nIndex < _ANALYSIS_VRESOLUTION-1; nIndex++)	// Clear the HOI row histogram.
 				{
 					nHOIHistoRow[nIndex] = 0;
 				}
@@ -170,7 +170,7 @@ void ImageProcessingAlgorithm3(TASK_ATTRIBUTE *ptrTask)
 			
 			// --- Column 1 ---
 			//PIN_FLAG4_SET;
-			for (nYindex = 1; nYindex < gnImageHeight-1; nYindex++)			// Scan through each column, ignore the 1st and
+			for (nYindex = 1; nYindex < gnAnalysisHeight-1; nYindex++)			// Scan through each column, ignore the 1st and
 			// last columns, and 1st and last rows.
 			{
 				if (gnValidFrameBuffer == 1)					// Check frame buffer data valid flag.  If equals 1 means gunImgAtt2[] data
@@ -203,7 +203,7 @@ void ImageProcessingAlgorithm3(TASK_ATTRIBUTE *ptrTask)
 				}
 			}
 			nXindex++;														// Next column.
-			if (nXindex == gnImageWidth-2)									// Is this the last column?
+			if (nXindex == gnAnalysisWidth-2)									// Is this the last column?
 			{
 				nXindex = 2;												// Start from Column 2.
 				OSSetTaskContext(ptrTask, 3, 1);							// Next state = 3, timer = 1.
@@ -213,7 +213,7 @@ void ImageProcessingAlgorithm3(TASK_ATTRIBUTE *ptrTask)
 			}
 			
 			// --- Column 2 ---
-			for (nYindex = 1; nYindex < gnImageHeight-1; nYindex++)			// Scan through each column, ignore the 1st and
+			for (nYindex = 1; nYindex < gnAnalysisHeight-1; nYindex++)			// Scan through each column, ignore the 1st and
 			// last columns, and 1st and last rows.
 			{
 				if (gnValidFrameBuffer == 1)					// Check frame buffer data valid flag.  If equals 1 means gunImgAtt2[] data
@@ -246,7 +246,7 @@ void ImageProcessingAlgorithm3(TASK_ATTRIBUTE *ptrTask)
 				}
 			}
 			nXindex++;														// Next column.
-			if (nXindex == gnImageWidth-2)									// Is this the last column?
+			if (nXindex == gnAnalysisWidth-2)									// Is this the last column?
 			{
 				nXindex = 2;												// Start from Column 2.
 				OSSetTaskContext(ptrTask, 3, 1);							// Next state = 3, timer = 1.
@@ -256,7 +256,7 @@ void ImageProcessingAlgorithm3(TASK_ATTRIBUTE *ptrTask)
 			}
 			
 			// --- Column 3 ---
-			for (nYindex = 1; nYindex < gnImageHeight-1; nYindex++)			// Scan through each column, ignore the 1st and
+			for (nYindex = 1; nYindex < gnAnalysisHeight-1; nYindex++)			// Scan through each column, ignore the 1st and
 			// last columns, and 1st and last rows.
 			{
 				if (gnValidFrameBuffer == 1)					// Check frame buffer data valid flag.  If equals 1 means gunImgAtt2[] data
@@ -289,7 +289,7 @@ void ImageProcessingAlgorithm3(TASK_ATTRIBUTE *ptrTask)
 				}
 			}
 			nXindex++;														// Next column.
-			if (nXindex == gnImageWidth-2)									// Is this the last column?
+			if (nXindex == gnAnalysisWidth-2)									// Is this the last column?
 			{
 				nXindex = 2;												// Start from Column 2.
 				OSSetTaskContext(ptrTask, 3, 1);							// Next state = 3, timer = 1.
@@ -299,7 +299,7 @@ void ImageProcessingAlgorithm3(TASK_ATTRIBUTE *ptrTask)
 			}
 			
 			// --- Column 4 ---
-			for (nYindex = 1; nYindex < gnImageHeight-1; nYindex++)			// Scan through each column, ignore the 1st and
+			for (nYindex = 1; nYindex < gnAnalysisHeight-1; nYindex++)			// Scan through each column, ignore the 1st and
 			// last columns, and 1st and last rows.
 			{
 				if (gnValidFrameBuffer == 1)					// Check frame buffer data valid flag.  If equals 1 means gunImgAtt2[] data
@@ -332,7 +332,7 @@ void ImageProcessingAlgorithm3(TASK_ATTRIBUTE *ptrTask)
 				}
 			}
 			nXindex++;														// Next column.
-			if (nXindex == gnImageWidth-2)									// Is this the last column?
+			if (nXindex == gnAnalysisWidth-2)									// Is this the last column?
 			{
 				nXindex = 2;												// Start from Column 2.
 				OSSetTaskContext(ptrTask, 3, 1);							// Next state = 3, timer = 1.
@@ -364,7 +364,7 @@ void ImageProcessingAlgorithm3(TASK_ATTRIBUTE *ptrTask)
 
 			// --- Column 1 ---
 			nHueCounterCol = 0;												// Reset counter to keep track of no. of valid pixels along the column.
-			for (nYindex = 2; nYindex < gnImageHeight-2; nYindex++)			// Scan through each column, ignore the 1st two
+			for (nYindex = 2; nYindex < gnAnalysisHeight-2; nYindex++)			// Scan through each column, ignore the 1st two
 																			// and last two columns.
 			{
 				unResult = 0;												// Reset result value.
@@ -442,7 +442,7 @@ void ImageProcessingAlgorithm3(TASK_ATTRIBUTE *ptrTask)
 			}
 			nHOIHistoCol[nXindex] = nHueCounterCol; 						// Update column histogram to maximum count value.
 			nXindex++;														// Next column.
-			if (nXindex == gnImageWidth-3)									// Is this the last column?
+			if (nXindex == gnAnalysisWidth-3)									// Is this the last column?
 			{
 				OSSetTaskContext(ptrTask, 4, 1);							// Next state = 4, timer = 1.
 				//nState = 4;													// Next state = 4, timer = 1 tick.
@@ -452,7 +452,7 @@ void ImageProcessingAlgorithm3(TASK_ATTRIBUTE *ptrTask)
 			
 			// --- Column 2 ---
 			nHueCounterCol = 0;												// Reset counter to keep track of no. of valid pixels along the column.
-			for (nYindex = 2; nYindex < gnImageHeight-2; nYindex++)			// Scan through each column, ignore the 1st two
+			for (nYindex = 2; nYindex < gnAnalysisHeight-2; nYindex++)			// Scan through each column, ignore the 1st two
 																			// and last two columns.
 			{
 				unResult = 0;												// Reset result value.
@@ -531,7 +531,7 @@ void ImageProcessingAlgorithm3(TASK_ATTRIBUTE *ptrTask)
 			}
 			nHOIHistoCol[nXindex] = nHueCounterCol; 						// Update column histogram to maximum count value.
 			nXindex++;														// Next column.
-			if (nXindex == gnImageWidth-3)									// Is this the last column?
+			if (nXindex == gnAnalysisWidth-3)									// Is this the last column?
 			{
 				OSSetTaskContext(ptrTask, 4, 1);							// Next state = 4, timer = 1.
 				//nState = 4;													// Next state = 4, timer = 1 tick.
@@ -555,7 +555,7 @@ void ImageProcessingAlgorithm3(TASK_ATTRIBUTE *ptrTask)
 			// select a threshold of 5% of the column pixels, e.g. 6 pixels.
 			// This rule-of-thumb allow sufficient guard against noise.
 			
-			for (nIndex = 1; nIndex < gnImageWidth-2; nIndex++)					// Scan through each column histogram, and compare with the maximum.
+			for (nIndex = 1; nIndex < gnAnalysisWidth-2; nIndex++)					// Scan through each column histogram, and compare with the maximum.
 			// histogram value.  Ignore Column 0 and last column.
 			{
 				if (nHOIHistoCol[nIndex] > nMaxValueCol)						// If current histogram value is larger than nMaxValue,
@@ -566,7 +566,7 @@ void ImageProcessingAlgorithm3(TASK_ATTRIBUTE *ptrTask)
 			}
 			nMaxValueRow = _IP3_VALID_PIXEL_THRESHOLD;
 			nMaxRow = -1;
-			for (nIndex = 1; nIndex < gnImageHeight-2; nIndex++)				// Scan through each row histogram, and compare with the maximum.
+			for (nIndex = 1; nIndex < gnAnalysisHeight-2; nIndex++)				// Scan through each row histogram, and compare with the maximum.
 			// histogram value.  Ignore Column 0 and last column.
 			{
 				if (nHOIHistoRow[nIndex] > nMaxValueRow)						// If current histogram value is larger than nMaxValue,
@@ -0,0 +1,129 @@
+//////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	USER DRIVER ROUTINES DECLARATION (PROCESSOR DEPENDENT) 
+//   
+//////////////////////////////////////////////////////////////////////////////////////////////
+//
+// File				: User_Task.c
+// Author(s)		: Fabian Kung
+// Last modified	: 16 Oct 2026
+// Tool-suites		: Atmel Studio 7.0 or later
+//                    GCC C-Compiler
+//                    ARM CMSIS 5.0.1
+
+#include "osmain.h"
+#include "Driver_UART2_V100.h"
+#include "Driver_USART0_V100.h"
+#include "Driver_TCM8230_LCD.h"
+
+// NOTE: Public function prototypes are declared in the corresponding *.h file.
+
+
+///
+/// Process name		: Proce_MessageLoop_Command
+///
+/// Author			: Fabian Kung
+///
+/// Last modified	: 16 Oct 2026
+///
+/// Code Version		: 1.00
+///
+/// Processor		: ARM Cortex-M7 family
+///
+/// Processor/System Resource
+/// PINS				: None
+///
+/// MODULE			: UART2 (External), USART0 (External)
+///
+/// DRIVER			: Proce_UART2_Driver, Proce_USART0_Driver
+///
+/// RTOS				: Ver 1 or above, round-robin scheduling.
+///
+/// Global variable	: gbytRXbuffer[], gbytRXbuffer2[]
+///
+
+#ifdef 				  __OS_VER			// Check RTOS version compatibility.
+#if 			      __OS_VER < 1
+#error "Proce_MessageLoop_Command: Incompatible OS version"
+#endif
+#else
+#error "Proce_MessageLoop_Command: An RTOS is required with this function"
+#endif
+
+///
+/// Description	: Decode single character commands from the remote host on UART2 or USART0
+///				  and change the camera operating mode at run-time.  The commands are:
+///				  'Q' - QQVGA (160x120), grayscale display, 20.83 fps.
+///				  'V' - QVGA (320x240), color display, 11.72 fps.
+///				  'S' - QVGA (320x240), color display, 7.5 fps.
+///				  All other characters are ignored.  The camera driver re-programs the sensor
+///				  between frames, see Proce_TCM8230LCD_Driver().
+
+void Proce_MessageLoop_Command(TASK_ATTRIBUTE *ptrTask)
+{
+	static unsigned char bytData;
+	
+	if (ptrTask->nTimer == 0)
+	{
+		switch (ptrTask->nState)
+		{
+			case 0: // State 0 - Initialization.
+			bytData = 0;
+			OSSetTaskContext(ptrTask, 1, 1000*__NUM_SYSTEMTICK_MSEC);     // Next state = 1, timer = 1000 msec.
+			break;
+
+			case 1: // State 1 - Message clearing for UART2 and USART0.
+			bytData = 0;
+			if (gSCIstatus.bRXRDY == 1)				// Check if UART2 receive any data.
+			{
+				if (gSCIstatus.bRXOVF == 0)			// Make sure no overflow error.
+				{
+					bytData = gbytRXbuffer[0];		// Get 1 byte and ignore all others.
+				}
+				else
+				{
+					gSCIstatus.bRXOVF = 0; 			// Reset overflow error flag.
+				}
+				gSCIstatus.bRXRDY = 0;				// Reset valid data flag.
+				gbytRXbufptr = 0; 					// Reset pointer.
+			}
+			else if (gbytRXbufptr2 > 0)				// Check if USART0 receive any 1 byte of data.
+			{
+				if (gSCIstatus2.bRXOVF == 0)		// Make sure no overflow error.
+				{
+					bytData = gbytRXbuffer2[0];		// Get 1 byte and ignore all others.
+				}
+				else
+				{
+					gSCIstatus2.bRXOVF = 0; 		// Reset overflow error flag.
+				}
+				gSCIstatus2.bRXRDY = 0;				// Reset valid data flag.
+				gbytRXbufptr2 = 0; 					// Reset pointer.
+			}
+			
+			switch (bytData)
+			{
+				case 'Q':							// QQVGA, 20.83 fps.
+					CameraSetMode(_CAMERA_MODE_QQVGA_20FPS);
+				break;
+				
+				case 'V':							// QVGA, 11.72 fps.
+					CameraSetMode(_CAMERA_MODE_QVGA_11FPS);
+				break;
+				
+				case 'S':							// QVGA, 7.5 fps.
+					CameraSetMode(_CAMERA_MODE_QVGA_7FPS);
+				break;
+				
+				default:
+				break;
+			}
+			OSSetTaskContext(ptrTask, 1, 10*__NUM_SYSTEMTICK_MSEC);      // Next state = 1, timer = 10 msec.
+			break;
+
+			default:
+			OSSetTaskContext(ptrTask, 0, 1);		// Back to state = 0, timer = 1.
+			break;
+		}
+	}
+}
\ No newline at end of file
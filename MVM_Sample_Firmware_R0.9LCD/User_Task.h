@@ -14,4 +14,5 @@
 //
 //void Proce_MessageLoop_StreamImage(TASK_ATTRIBUTE *);
 //void Proce_RunImageProcess(TASK_ATTRIBUTE *);
+void Proce_MessageLoop_Command(TASK_ATTRIBUTE *);
 void ImageProcessingAlgorithm3(TASK_ATTRIBUTE *);
\ No newline at end of file
@@ -1,7 +1,7 @@
 
 
 #include "osmain.h"
-//#include "Driver_UART2_V100.h"
+#include "Driver_UART2_V100.h"
 #include "Driver_USART0_V100.h"
 #include "Driver_I2C1_V100.h"
 #include "Driver_LCD_ILI9341_V100.h"
@@ -30,16 +30,15 @@ int main(void)
 	OSCreateTask(&gstrcTaskContext[gnTaskCount], OSProce1);						// Start main blinking LED process.
 	
 	// Initialize library processes.
-	//OSCreateTask(&gstrcTaskContext[gnTaskCount], Proce_UART2_Driver);			// Start UART driver.
+	OSCreateTask(&gstrcTaskContext[gnTaskCount], Proce_UART2_Driver);			// Start UART driver.
 	OSCreateTask(&gstrcTaskContext[gnTaskCount], Proce_I2C1_Driver);			// Start I2C driver.		
 	OSCreateTask(&gstrcTaskContext[gnTaskCount], Proce_Camera_LED_Driver);
 	OSCreateTask(&gstrcTaskContext[gnTaskCount], Proce_USART0_Driver);			// Start USART0 driver.
 	OSCreateTask(&gstrcTaskContext[gnTaskCount], Proce_LCD_ILI9341_Driver);		// Start the 320x240 TFT LCD driver.
 	OSCreateTask(&gstrcTaskContext[gnTaskCount], Proce_TCM8230LCD_Driver);		// Start TCM8230 camera driver for QVGA resolution with RGB565 pixel buffer.
 	
-	#ifdef		__QQVGA__
 	OSCreateTask(&gstrcTaskContext[gnTaskCount], ImageProcessingAlgorithm3);		// Start sample image processing algorithm.
-	#endif
+	OSCreateTask(&gstrcTaskContext[gnTaskCount], Proce_MessageLoop_Command);	// Start run-time camera mode command decoder.
 	
 	/* Replace with your application code */
 	while (1)